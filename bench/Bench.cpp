@@ -0,0 +1,145 @@
+#include "Bench.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#ifndef PRICER_BUILD_TYPE
+#define PRICER_BUILD_TYPE ""
+#endif
+
+namespace {
+std::string json_string(const std::string& text) {
+    std::string quoted = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            quoted += '\\';
+        }
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+std::string json_number(double value) {
+    if (!std::isfinite(value)) {
+        return "null";
+    }
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.6g", value);
+    return buffer;
+}
+}
+
+BenchOptions parse_bench_options(int argc, const char* argv[]) {
+    BenchOptions options;
+    for (int k = 1; k < argc; k++) {
+        if (std::strcmp(argv[k], "--quick") == 0) {
+            options.quick = true;
+            options.minRepetitions = 2;
+            options.minSeconds = 0;
+        } else if (std::strcmp(argv[k], "--out") == 0 && k + 1 < argc) {
+            options.output = argv[++k];
+        } else if (std::strcmp(argv[k], "--repetitions") == 0 && k + 1 < argc) {
+            options.minRepetitions = std::max(1, std::atoi(argv[++k]));
+        } else if (std::strcmp(argv[k], "--seconds") == 0 && k + 1 < argc) {
+            options.minSeconds = std::atof(argv[++k]);
+        } else {
+            std::cerr << "usage: " << argv[0] << " [--quick] [--out file.json] [--repetitions n] [--seconds s]" << std::endl;
+            std::exit(2);
+        }
+    }
+    return options;
+}
+
+namespace {
+// "VmRSS:" or "VmHWM:" line of /proc/self/status, in KiB
+long status_kib(const std::string& field) {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, field.size(), field) == 0) {
+            return std::atol(line.c_str() + field.size());
+        }
+    }
+    return -1;
+}
+}
+
+long current_rss_kib() {
+    return status_kib("VmRSS:");
+}
+
+long peak_rss_kib() {
+    return status_kib("VmHWM:");
+}
+
+bool reset_peak_rss() {
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    clearRefs << "5";
+    clearRefs.flush();
+    return static_cast<bool>(clearRefs);
+}
+
+BenchStats summarize(const std::vector<double>& samplesNs) {
+    BenchStats stats{samplesNs.size(), 0, 0, samplesNs[0], samplesNs[0]};
+    for (double sample : samplesNs) {
+        stats.meanNs += sample;
+        stats.minNs = std::min(stats.minNs, sample);
+        stats.maxNs = std::max(stats.maxNs, sample);
+    }
+    stats.meanNs /= samplesNs.size();
+    for (double sample : samplesNs) {
+        stats.stddevNs += (sample - stats.meanNs) * (sample - stats.meanNs);
+    }
+    stats.stddevNs = samplesNs.size() > 1 ? std::sqrt(stats.stddevNs / (samplesNs.size() - 1)) : 0;
+    return stats;
+}
+
+BenchReport::BenchReport(std::string suite, const BenchOptions& options) : suite(std::move(suite)), options(options) {}
+
+void BenchReport::add(const std::string& name, const std::vector<std::pair<std::string, double>>& params, const BenchStats& stats,
+                      double work, const std::string& workUnit) {
+    std::ostringstream record;
+    record << "{\"name\": " << json_string(name) << ", \"params\": {";
+    for (std::size_t k = 0; k < params.size(); k++) {
+        record << (k ? ", " : "") << json_string(params[k].first) << ": " << json_number(params[k].second);
+    }
+    record << "}, \"repetitions\": " << stats.repetitions << ", \"mean_ns\": " << json_number(stats.meanNs)
+           << ", \"stddev_ns\": " << json_number(stats.stddevNs) << ", \"min_ns\": " << json_number(stats.minNs)
+           << ", \"max_ns\": " << json_number(stats.maxNs) << ", \"cv\": " << json_number(stats.stddevNs / stats.meanNs)
+           << ", \"work\": " << json_number(work) << ", \"work_unit\": " << json_string(workUnit)
+           << ", \"ns_per_unit\": " << json_number(stats.meanNs / work) << ", \"units_per_second\": " << json_number(work * 1e9 / stats.meanNs)
+           << ", \"rss_growth_kib\": " << json_number(stats.rssGrowthKib) << "}";
+    records.push_back(record.str());
+    // progress on stderr, the document goes to the output
+    std::cerr << suite << "/" << name << ": " << stats.meanNs / work << " ns/" << workUnit << " (cv " << stats.stddevNs / stats.meanNs << ")" << std::endl;
+}
+
+bool BenchReport::write() const {
+    std::ostringstream document;
+    document << "{\"suite\": " << json_string(suite) << ", \"build\": {\"compiler\": " << json_string(__VERSION__)
+             << ", \"build_type\": " << json_string(PRICER_BUILD_TYPE)
+#if defined(__AVX2__) && defined(__FMA__)
+             << ", \"avx2\": true"
+#else
+             << ", \"avx2\": false"
+#endif
+             << ", \"hardware_threads\": " << std::thread::hardware_concurrency() << ", \"quick\": " << (options.quick ? "true" : "false")
+             << "},\n \"results\": [";
+    for (std::size_t k = 0; k < records.size(); k++) {
+        document << (k ? ",\n  " : "\n  ") << records[k];
+    }
+    document << "\n]}\n";
+    if (options.output.empty()) {
+        std::cout << document.str();
+        return true;
+    }
+    std::ofstream file(options.output);
+    file << document.str();
+    return static_cast<bool>(file);
+}
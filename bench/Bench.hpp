@@ -0,0 +1,83 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+// self-contained microbenchmark harness: repeated wall clock timings of a callable, summary statistics and one JSON
+// document per run (build info + one record per case) so that results can be compared across builds
+
+struct BenchStats {
+    std::size_t repetitions;
+    double meanNs;
+    double stddevNs;
+    double minNs;
+    double maxNs;
+    double rssGrowthKib = 0; // peak resident set size during the case over the one at its start, NaN if not measurable
+};
+
+struct BenchOptions {
+    bool quick = false; // smaller grids and fewer repetitions (smoke runs)
+    std::string output; // JSON file, stdout when empty
+    std::size_t minRepetitions = 5;
+    double minSeconds = 0.3; // keeps repeating until both minimums are reached
+};
+
+// --quick, --out <file>, --repetitions <n>, --seconds <s>
+BenchOptions parse_bench_options(int argc, const char* argv[]);
+
+// resident set size of the process now and its peak since the last reset_peak_rss() (since start without one), in KiB,
+// -1 if /proc/self/status can't be read
+long current_rss_kib();
+long peak_rss_kib();
+// brings the peak back to the current size (Linux >= 4.0), false if it couldn't
+bool reset_peak_rss();
+
+BenchStats summarize(const std::vector<double>& samplesNs);
+
+// one warm-up call then timed samples until options.minRepetitions and options.minSeconds are both reached; calls shorter
+// than minSampleNs are grouped so that every sample lasts about that long (timer resolution), the stats are per call.
+// The memory of the case is the growth of the peak RSS over the RSS at its start, the peak being reset there
+template <typename F>
+BenchStats measure(const BenchOptions& options, F&& run) {
+    using Clock = std::chrono::steady_clock;
+    constexpr double minSampleNs = 20000;
+    long startRss = current_rss_kib();
+    bool peakReset = reset_peak_rss();
+    Clock::time_point warmUp = Clock::now();
+    run();
+    double firstNs = std::chrono::duration<double, std::nano>(Clock::now() - warmUp).count();
+    std::size_t calls = firstNs < minSampleNs ? static_cast<std::size_t>(minSampleNs / std::max(firstNs, 1.)) + 1 : 1;
+    std::vector<double> samples;
+    Clock::time_point start = Clock::now();
+    while (samples.size() < options.minRepetitions || std::chrono::duration<double>(Clock::now() - start).count() < options.minSeconds) {
+        Clock::time_point before = Clock::now();
+        for (std::size_t k = 0; k < calls; k++) {
+            run();
+        }
+        samples.push_back(std::chrono::duration<double, std::nano>(Clock::now() - before).count() / calls);
+    }
+    BenchStats stats = summarize(samples);
+    long peakRss = peak_rss_kib();
+    stats.rssGrowthKib = peakReset && startRss >= 0 && peakRss >= 0 ? static_cast<double>(peakRss - startRss) : std::nan("");
+    return stats;
+}
+
+class BenchReport {
+private:
+    std::string suite;
+    BenchOptions options;
+    std::vector<std::string> records; // serialized JSON objects
+
+public:
+    BenchReport(std::string suite, const BenchOptions& options);
+    // params: the sweep coordinates of the case (grid size, theta, threads...), work: units processed per call
+    // (mesh nodes, quotes, paths) for the per unit time and the throughput
+    void add(const std::string& name, const std::vector<std::pair<std::string, double>>& params, const BenchStats& stats,
+             double work, const std::string& workUnit);
+    // writes the document, returns false if the output file couldn't be written
+    bool write() const;
+};
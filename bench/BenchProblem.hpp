@@ -0,0 +1,32 @@
+#pragma once
+#include "Pricers.hpp"
+#include <cmath>
+
+// call on a constant vol / constant rate underlying over an N x N_T mesh, set up like the examples
+struct BenchProblem {
+    static constexpr double S0 = 100;
+    static constexpr double K = 105;
+    static constexpr double T = 1;
+    static constexpr double sigma_0 = 0.2;
+    static constexpr double r_0 = 0.05;
+
+    int N;
+    int N_T;
+    Asset underlying;
+    VanillaCallPayoff payoff;
+    Contract contract;
+    SpaceTimeMesh stm;
+    BoundaryConditions volBC;
+    BoundaryConditions rateBC;
+    BoundaryConditions additionalBC;
+
+    BenchProblem(int N, int N_T, const ItoDynamics& volDynamics = ItoDynamics{ConstantDynamics(0, 0)})
+        : N(N), N_T(N_T), underlying(S0, volDynamics, ItoDynamics{ConstantDynamics(0, 0)}), payoff{K}, contract(underlying, payoff, T),
+          stm(std::log(S0), 5 * sigma_0 * std::sqrt(T), T, N, N_T), volBC(N, N_T, [](double t, double x) { return sigma_0; }),
+          rateBC(N, N_T, [](double t, double x) { return r_0; }), additionalBC(N, N_T, [](double t, double x) { return 0.; }) {
+        volBC.ToggleDir(true, false);
+        rateBC.ToggleDir(true, false);
+        additionalBC.ToggleDir(false, false);
+    }
+    BenchProblem(const BenchProblem&) = delete; // the contract refers to the members
+};
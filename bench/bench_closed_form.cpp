@@ -0,0 +1,39 @@
+#include "Bench.hpp"
+#include "Pricers.hpp"
+#include <vector>
+
+// Black-Scholes: one pricer call (a batch of one) and the batch kernel over batch sizes
+int main(int argc, const char* argv[]) {
+    BenchOptions options = parse_bench_options(argc, argv);
+    BenchReport report("closed_form", options);
+    volatile double sink = 0;
+    report.add("black_scholes_call_pricer", {}, measure(options, [&] {
+        for (int k = 0; k < 1000; k++) {
+            BlackScholesCallPricer pricer(100, 80 + 0.04 * k, 1.0, 0.05, 0.2);
+            pricer.price();
+            sink = sink + pricer.getPrice();
+        }
+    }), 1000, "quote");
+
+    std::vector<std::size_t> sizes = options.quick ? std::vector<std::size_t>{1, 1024} : std::vector<std::size_t>{1, 7, 64, 1024, 65536, 1 << 20};
+    for (std::size_t size : sizes) {
+        std::vector<double> S(size), K(size), T(size), r(size), sigma(size), greeks(6 * size);
+        for (std::size_t i = 0; i < size; i++) {
+            S[i] = 100;
+            K[i] = 50 + 100. * i / size;
+            T[i] = 0.1 + 2. * i / size;
+            r[i] = 0.03;
+            sigma[i] = 0.1 + 0.3 * i / size;
+        }
+        for (OptionType type : {OptionType::Call, OptionType::Put}) {
+            std::size_t repeat = std::max<std::size_t>(1, 4096 / size);
+            report.add("black_scholes_batch", {{"size", static_cast<double>(size)}, {"call", type == OptionType::Call ? 1. : 0.}}, measure(options, [&] {
+                for (std::size_t k = 0; k < repeat; k++) {
+                    black_scholes_batch(type, {S.data(), K.data(), T.data(), r.data(), sigma.data(), size},
+                                        {&greeks[0], &greeks[size], &greeks[2 * size], &greeks[3 * size], &greeks[4 * size], &greeks[5 * size]});
+                }
+            }), static_cast<double>(repeat * size), "quote");
+        }
+    }
+    return report.write() ? 0 : 1;
+}
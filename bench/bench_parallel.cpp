@@ -0,0 +1,78 @@
+#include "Bench.hpp"
+#include "BenchProblem.hpp"
+#include "BatchPricer.hpp"
+#include "MonteCarlo.hpp"
+#include "PricingPool.hpp"
+#include "StochasticVolPricer.hpp"
+#include <memory>
+#include <thread>
+
+// scaling with the thread count: independent pricings on the pricing pool, Monte Carlo blocks and the lines of the
+// stochastic vol ADI steps on a thread pool,
+// plus the single threaded batch pricer (double and mixed storage) on the same strike ladder for reference
+int main(int argc, const char* argv[]) {
+    BenchOptions options = parse_bench_options(argc, argv);
+    BenchReport report("parallel", options);
+    std::size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::size_t> threads = {1, 2, 4};
+    if (hardware > 4) {
+        threads.push_back(hardware);
+    }
+    int N = options.quick ? 201 : 801;
+    int N_T = options.quick ? 100 : 400;
+    std::size_t contracts = options.quick ? 8 : 32;
+    double nodes = static_cast<double>(N) * N_T * contracts;
+
+    // strike ladder on one underlying and one mesh
+    BenchProblem problem(N, N_T);
+    std::vector<VanillaCallPayoff> payoffs;
+    std::vector<Contract> ladder;
+    for (std::size_t k = 0; k < contracts; k++) {
+        payoffs.push_back({80 + 40. * k / contracts});
+    }
+    for (const VanillaCallPayoff& payoff : payoffs) {
+        ladder.emplace_back(problem.underlying, payoff, problem.T);
+    }
+    std::vector<PricingJob> jobs;
+    for (const Contract& contract : ladder) {
+        jobs.push_back({contract, problem.stm, problem.volBC, problem.rateBC, problem.additionalBC, problem.sigma_0});
+    }
+    for (std::size_t count : threads) {
+        PricingPool pool(count);
+        report.add("pricing_pool", {{"threads", static_cast<double>(count)}, {"contracts", static_cast<double>(contracts)}, {"N", N}, {"N_T", N_T}},
+                   measure(options, [&] { pool.priceAll(jobs); }), nodes, "node");
+    }
+    BatchPricer batch(problem.underlying, problem.stm, problem.volBC, problem.rateBC);
+    report.add("batch_pricer", {{"threads", 1}, {"contracts", static_cast<double>(contracts)}, {"N", N}, {"N_T", N_T}, {"storage_bits", 64}},
+               measure(options, [&] { batch.price(ladder, problem.additionalBC, 0.5); }), nodes, "node");
+    MixedBatchPricer mixed(problem.underlying, problem.stm, problem.volBC, problem.rateBC);
+    report.add("batch_pricer", {{"threads", 1}, {"contracts", static_cast<double>(contracts)}, {"N", N}, {"N_T", N_T}, {"storage_bits", 32}},
+               measure(options, [&] { mixed.price(ladder, problem.additionalBC, 0.5); }), nodes, "node");
+
+    // stochastic vol on an (x, sigma) grid, the x-lines then sigma-lines of every step split over the pool
+    int M = options.quick ? 21 : 81;
+    SpaceVolTimeMesh volMesh(std::log(problem.S0), problem.stm.get_R(), problem.T, N, N_T, 0.05, 0.65, M);
+    Asset volOfVolAsset(problem.S0, ItoDynamics{ConstantDynamics(0, 0.3)}, ItoDynamics{ConstantDynamics(0, 0)});
+    Contract volOfVolContract(volOfVolAsset, problem.payoff, problem.T);
+    StochasticVolPricer stochastic(volOfVolContract, volMesh, problem.rateBC, -0.5);
+    for (std::size_t count : threads) {
+        ThreadPool pool(count);
+        report.add("stochastic_vol", {{"threads", static_cast<double>(count)}, {"N", N}, {"M", M}, {"N_T", N_T}},
+                   measure(options, [&] { stochastic.price(0.5, &pool); }), static_cast<double>(N) * M * N_T, "node");
+    }
+
+    MonteCarloSettings settings;
+    settings.paths = options.quick ? 20000 : 200000;
+    settings.steps = 50;
+    for (RandomSource source : {RandomSource::Pseudo, RandomSource::Sobol}) {
+        settings.source = source;
+        MonteCarloPricer pricer(problem.contract, problem.sigma_0, problem.r_0, settings);
+        for (std::size_t count : threads) {
+            ThreadPool pool(count);
+            report.add("monte_carlo", {{"threads", static_cast<double>(count)}, {"sobol", source == RandomSource::Sobol ? 1. : 0.},
+                                       {"steps", static_cast<double>(settings.steps)}},
+                       measure(options, [&] { pricer.price(pool); }), static_cast<double>(settings.paths * settings.steps), "path_step");
+        }
+    }
+    return report.write() ? 0 : 1;
+}
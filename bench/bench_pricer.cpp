@@ -0,0 +1,91 @@
+#include "Bench.hpp"
+#include "BenchProblem.hpp"
+#include "FixedGridPricer.hpp"
+#include "PricingCache.hpp"
+#include <memory>
+
+// DiscretePricer: construction, pricing sweep (both modes, every precision) and greeks over grid sizes and theta,
+// european against american exercise, a repeated job answered by the pricing cache, and the quoting grid with its sizes
+// fixed at compile time
+int main(int argc, const char* argv[]) {
+    BenchOptions options = parse_bench_options(argc, argv);
+    BenchReport report("pricer", options);
+    std::vector<std::pair<int, int>> grids = options.quick ? std::vector<std::pair<int, int>>{{101, 50}, {201, 100}}
+                                                           : std::vector<std::pair<int, int>>{{101, 50}, {401, 200}, {1001, 1000}, {2001, 2000}};
+    for (std::pair<int, int> grid : grids) {
+        BenchProblem problem(grid.first, grid.second);
+        double nodes = static_cast<double>(grid.first) * grid.second;
+        for (PricingMode mode : {PricingMode::FullGrid, PricingMode::RollingSlices}) {
+            double rolling = mode == PricingMode::RollingSlices;
+            std::vector<std::pair<std::string, double>> params = {{"N", grid.first}, {"N_T", grid.second}, {"rolling", rolling}};
+            report.add("construct", params, measure(options, [&] {
+                DiscretePricer pricer(problem.N, problem.N_T, problem.contract, problem.sigma_0, problem.volBC, problem.rateBC, problem.additionalBC, problem.stm, mode);
+            }), nodes, "node");
+
+            for (double theta : {0.5, 1.0}) {
+                for (SolverPrecision precision : {SolverPrecision::Single, SolverPrecision::Double, SolverPrecision::Extended}) {
+                    std::vector<std::pair<std::string, double>> sweep = params;
+                    sweep.push_back({"theta", theta});
+                    sweep.push_back({"precision_bits", precision == SolverPrecision::Single ? 32. : precision == SolverPrecision::Double ? 64. : 80.});
+                    report.add("price", sweep, measure(options, [&] {
+                        DiscretePricer pricer(problem.N, problem.N_T, problem.contract, problem.sigma_0, problem.volBC, problem.rateBC, problem.additionalBC, problem.stm, mode);
+                        pricer.price(theta, precision);
+                    }), nodes, "node");
+                }
+            }
+
+            // same pricing on a warm workspace (meshes, slices and engine reused, no allocation)
+            PricingWorkspace workspace;
+            std::vector<std::pair<std::string, double>> borrowing = params;
+            borrowing.push_back({"workspace", 1});
+            report.add("price", borrowing, measure(options, [&] {
+                DiscretePricer pricer(problem.N, problem.N_T, problem.contract, problem.sigma_0, problem.volBC, problem.rateBC, problem.additionalBC, problem.stm, mode,
+                                      &workspace);
+                pricer.price(0.5);
+            }), nodes, "node");
+
+            // greeks read from a priced grid, vega reprices a bumped grid
+            DiscretePricer pricer(problem.N, problem.N_T, problem.contract, problem.sigma_0, problem.volBC, problem.rateBC, problem.additionalBC, problem.stm, mode);
+            pricer.price(0.5);
+            volatile double sink = 0;
+            report.add("delta_gamma_theta", params, measure(options, [&] { sink = sink + pricer.delta() + pricer.gamma() + pricer.theta(); }), 1, "call");
+            report.add("vega", params, measure(options, [&] { sink = sink + pricer.vega(); }), nodes, "node");
+            report.add("price_gradient", params, measure(options, [&] { sink = sink + pricer.priceGradient().price; }), nodes, "node");
+        }
+
+        // rolling sweep of an at the money put, european then american (projected solve on every slice)
+        VanillaPutPayoff put{problem.payoff.K};
+        for (ExerciseStyle style : {ExerciseStyle::European, ExerciseStyle::American}) {
+            Contract contract(problem.underlying, put, problem.T, {style, {}});
+            report.add("price_put", {{"N", grid.first}, {"N_T", grid.second}, {"american", style == ExerciseStyle::American ? 1. : 0.}}, measure(options, [&] {
+                DiscretePricer pricer(problem.N, problem.N_T, contract, problem.sigma_0, problem.volBC, problem.rateBC, problem.additionalBC, problem.stm,
+                                      PricingMode::RollingSlices);
+                pricer.price(0.5);
+            }), nodes, "node");
+        }
+
+        // key of the job (payoff and boundaries tabulated, then hashed) and lookup
+        PricingCache cache;
+        PricingJob job{problem.contract, problem.stm, problem.volBC, problem.rateBC, problem.additionalBC, problem.sigma_0};
+        cache.price(job);
+        report.add("cache_hit", {{"N", grid.first}, {"N_T", grid.second}}, measure(options, [&] { cache.price(job); }), 1, "call");
+    }
+
+    // 101 x 31 quoting grid: FixedGridPricer against DiscretePricer (rolling) on the same nodes
+    BenchProblem quote(101, 31);
+    FixedSpaceTimeMesh<101, 31> fixedMesh(std::log(quote.S0), 5 * quote.sigma_0 * std::sqrt(quote.T), quote.T);
+    auto zeroEdge = [](double t, double x) { return 0.; };
+    volatile double sink = 0;
+    report.add("quote", {{"N", 101}, {"N_T", 31}, {"fixed", 1}}, measure(options, [&] {
+        FixedGridPricer<101, 31> pricer(fixedMesh);
+        pricer.price(quote.payoff, quote.sigma_0, quote.r_0, 0.5, zeroEdge);
+        sink = sink + pricer.getPrice();
+    }), 101. * 31, "node");
+    report.add("quote", {{"N", 101}, {"N_T", 31}, {"fixed", 0}}, measure(options, [&] {
+        DiscretePricer pricer(quote.N, quote.N_T, quote.contract, quote.sigma_0, quote.volBC, quote.rateBC, quote.additionalBC, quote.stm,
+                              PricingMode::RollingSlices);
+        pricer.price(0.5);
+        sink = sink + pricer.getPrice();
+    }), 101. * 31, "node");
+    return report.write() ? 0 : 1;
+}
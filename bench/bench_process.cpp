@@ -0,0 +1,67 @@
+#include "Bench.hpp"
+#include "BenchProblem.hpp"
+#include <functional>
+
+namespace {
+// boundary conditions putting the process in the given layout (General: one slice in the middle of the mesh)
+BoundaryConditions layout_conditions(int N, int N_T, ProcessLayout layout) {
+    BoundaryConditions bc(N, N_T, [](double t, double x) { return 0.2; });
+    switch (layout) {
+    case ProcessLayout::GivenAtStart: bc.ToggleDir(true, false); break;
+    case ProcessLayout::GivenAtEnd: bc.ToggleDir(true, true); break;
+    case ProcessLayout::GivenAtLowerX: bc.ToggleDir(false, false); break;
+    case ProcessLayout::GivenAtUpperX: bc.ToggleDir(false, true); break;
+    case ProcessLayout::General: bc.checkRun(N_T / 2, 0, N); break;
+    }
+    return bc;
+}
+}
+
+// ItoProcess::solve for every layout with typed and type erased dynamics, boundary application on meshes and slices
+int main(int argc, const char* argv[]) {
+    BenchOptions options = parse_bench_options(argc, argv);
+    BenchReport report("process", options);
+    std::vector<std::pair<int, int>> grids = options.quick ? std::vector<std::pair<int, int>>{{101, 50}, {201, 100}}
+                                                           : std::vector<std::pair<int, int>>{{101, 50}, {401, 200}, {1001, 1000}, {2001, 2000}};
+    ItoDynamics typed{ConstantDynamics(0.01, 0.1)};
+    std::function<double(double, double, double)> drift = [](double t, double x, double p) { return 0.01; };
+    std::function<double(double, double, double)> pseudoVol = [](double t, double x, double p) { return 0.1; };
+    ItoDynamics erased(drift, pseudoVol);
+    for (std::pair<int, int> grid : grids) {
+        int N = grid.first;
+        int N_T = grid.second;
+        double nodes = static_cast<double>(N) * N_T;
+        SpaceTimeMesh stm(std::log(100.), 1.0, 1.0, N, N_T);
+        for (ProcessLayout layout : {ProcessLayout::GivenAtStart, ProcessLayout::GivenAtEnd, ProcessLayout::GivenAtLowerX,
+                                     ProcessLayout::GivenAtUpperX, ProcessLayout::General}) {
+            BoundaryConditions bc = layout_conditions(N, N_T, layout);
+            for (const ItoDynamics* dynamics : {&typed, &erased}) {
+                std::vector<std::pair<std::string, double>> params = {{"N", N}, {"N_T", N_T}, {"layout", static_cast<double>(layout)},
+                                                                      {"typed", dynamics == &typed ? 1. : 0.}};
+                ItoProcess process(stm);
+                report.add("solve", params, measure(options, [&] { process.solve(bc, *dynamics); }), nodes, "node");
+                report.add("rolling_slices", params, measure(options, [&] {
+                    RollingItoProcess rolling(stm, bc, *dynamics);
+                    for (std::size_t n = N_T; n-- > 0;) {
+                        rolling.getSlice(n);
+                    }
+                }), nodes, "node");
+            }
+        }
+
+        // boundary values written on the frontier only: an x edge (one node per slice) and a full slice
+        std::vector<std::pair<std::string, double>> params = {{"N", N}, {"N_T", N_T}};
+        BoundaryConditions edge = layout_conditions(N, N_T, ProcessLayout::GivenAtLowerX);
+        BoundaryConditions start = layout_conditions(N, N_T, ProcessLayout::GivenAtStart);
+        FunctionMesh mesh(stm);
+        report.add("apply_boundary_conditions_x_edge", params, measure(options, [&] { mesh.applyBoundaryConditions(edge); }), N_T, "node");
+        report.add("apply_boundary_conditions_slice", params, measure(options, [&] { mesh.applyBoundaryConditions(start); }), N, "node");
+        std::vector<double> slice(N);
+        report.add("apply_slice_x_edge", params, measure(options, [&] {
+            for (std::size_t n = 0; n < static_cast<std::size_t>(N_T); n++) {
+                edge.applySlice(stm, n, slice.data());
+            }
+        }), N_T, "node");
+    }
+    return report.write() ? 0 : 1;
+}
@@ -6,17 +6,9 @@ int europeanPut(int argc, const char * argv[]) {
     // Example file (replace main) for pricing european put 
     // For simplicty's sake, and for a fair comparaison, we assume constant rate/vol
     
-    // vol ito dynamics and boundary conditions
-    std::function<double(double, double, double)> volDrift = [](double t, double x, double p) { return 0; }; // cste vol
-    std::function<double(double, double, double)> volStochastic = [](double t, double x, double p) { return 0; }; //cste vol
-    
-    // rate ito dynamics
-    std::function<double(double, double, double)> rateDrift = [](double t, double x, double p) { return 0; }; // cste rate
-    std::function<double(double, double, double)> rateStochastic = [](double t, double x, double p) { return 0; }; //cste rate
-    
-    // init of constant ItoDynamics
-    ItoDynamics volDynamics(volDrift, volStochastic);
-    ItoDynamics  rateDynamics(rateDrift, rateStochastic);
+    // init of constant ItoDynamics (no drift, no x dependency)
+    ItoDynamics volDynamics{ConstantDynamics(0, 0)}; // cste vol
+    ItoDynamics rateDynamics{ConstantDynamics(0, 0)}; // cste rate
     
     
     // init of underlying (we take AAPL as an example)
@@ -27,7 +19,7 @@ int europeanPut(int argc, const char * argv[]) {
     // init of a contract (European Call for example)
     int K = 250;
     double T = 31; // month contract
-    std::function<double(double)> payoff = [&K](double S) { return std::abs(static_cast<int>(K>=S)* (K-S)); }; // european call payoff
+    VanillaPutPayoff payoff{static_cast<double>(K)}; // european put payoff
     Contract contract(underlying, payoff, T);
     
     // pricing and creating mesh
@@ -38,8 +30,8 @@ int europeanPut(int argc, const char * argv[]) {
     double r_0 = 0.05; // cste risk-free rate
     
     // defining vol and rate boundary conditions (in this case we suppose sigma(0,.) as well as r(0,.) are given and are constant)
-    std::function<double(double, double)> csteVol = [&sigma_0](double t, double x) { return sigma_0; };
-    std::function<double(double, double)> csteRate = [&r_0](double t, double x) { return r_0; };
+    auto csteVol = [sigma_0](double t, double x) { return sigma_0; };
+    auto csteRate = [r_0](double t, double x) { return r_0; };
     
     BoundaryConditions volBoundaries(N, N_T, csteVol);
     BoundaryConditions rateBoundaries(N, N_T, csteRate);
@@ -47,7 +39,7 @@ int europeanPut(int argc, const char * argv[]) {
     rateBoundaries.ToggleDir(true, false);
 
     // defining additional contract boundaries (not payoff)
-    std::function<double(double, double)> zeroPayoff= [](double t, double x) { return 1.5; };
+    auto zeroPayoff= [](double t, double x) { return 1.5; };
     BoundaryConditions contractAdditionalBoundaries(N,N_T, zeroPayoff);
     contractAdditionalBoundaries.ToggleDir(false, false);
     
@@ -65,6 +57,16 @@ int europeanPut(int argc, const char * argv[]) {
     std::cout << "Crank-Nicholson Scheme's theta: "<< pricer.theta()<<std::endl;
     std::cout << "Crank-Nicholson Scheme's vega: "<< pricer.vega()<<std::endl;
     std::cout<<std::endl;
+
+    // compare w/ BlackScholes
+    BlackScholesPutPricer bsPricer(S0, K, T, r_0, sigma_0);
+    bsPricer.price();
+    std::cout<< "Black Scholes closed form's price: " << bsPricer.getPrice()<<std::endl;
+    std::cout<< "Black Scholes closed form's delta: " << bsPricer.delta()<<std::endl;
+    std::cout<< "Black Scholes closed form's gamma: " << bsPricer.gamma()<<std::endl;
+    std::cout<< "Black Scholes closed form's theta: " << bsPricer.theta()<<std::endl;
+    std::cout<< "Black Scholes closed form's vega: " << bsPricer.vega()<<std::endl;
+    std::cout<< "Black Scholes closed form's rho: " << bsPricer.rho()<<std::endl;
     
     return 0;
     
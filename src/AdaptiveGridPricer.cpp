@@ -0,0 +1,67 @@
+#include "AdaptiveGridPricer.hpp"
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+// fine + (fine - coarse) / (2^order - 1)
+PricingResult extrapolate(const PricingResult& coarse, const PricingResult& fine) {
+    return {fine.price + (fine.price - coarse.price) / 3, fine.delta + (fine.delta - coarse.delta) / 3,
+            fine.gamma + (fine.gamma - coarse.gamma) / 3, fine.theta + (fine.theta - coarse.theta)};
+}
+}
+
+AdaptiveGridPricer::AdaptiveGridPricer(const Contract& contract, double sigma_0, const BoundarySpec& volBC, const BoundarySpec& rateBC,
+                                       const BoundarySpec& additionalBC, const AdaptiveGridSettings& settings)
+    : contract(contract), sigma_0(sigma_0), volSpec(volBC), rateSpec(rateBC), additionalSpec(additionalBC), settings(settings) {
+    if (settings.N < 5 || settings.N % 2 == 0 || settings.N_T < 3) {
+        throw std::invalid_argument("adaptive grid: the coarsest grid needs an odd N >= 5 and N_T >= 3.");
+    }
+    if (!(settings.tolerance > 0) || settings.maxN < 4 * settings.N - 3) {
+        throw std::invalid_argument("adaptive grid: positive tolerance and room for two refinements needed.");
+    }
+}
+
+PricingResult AdaptiveGridPricer::solve(int N, int N_T, PricingWorkspace& workspace) const {
+    double T = contract.getMaturity();
+    SpaceTimeMesh stm(std::log(contract.getUnderlying().getS0()), settings.width * sigma_0 * std::sqrt(T), T, N, N_T, settings.stretching);
+    BoundaryConditions volBC(N, N_T, volSpec.function);
+    BoundaryConditions rateBC(N, N_T, rateSpec.function);
+    BoundaryConditions additionalBC(N, N_T, additionalSpec.function);
+    volBC.ToggleDir(volSpec.dir, volSpec.pos);
+    rateBC.ToggleDir(rateSpec.dir, rateSpec.pos);
+    additionalBC.ToggleDir(additionalSpec.dir, additionalSpec.pos);
+    DiscretePricer pricer(N, N_T, contract, sigma_0, volBC, rateBC, additionalBC, stm, PricingMode::RollingSlices, &workspace);
+    pricer.price(settings.theta, SolverPrecision::Double);
+    return pricer.getResult();
+}
+
+AdaptiveGridResult AdaptiveGridPricer::price() const {
+    PricingWorkspace workspace;
+    AdaptiveGridResult result{};
+    result.N = settings.N;
+    result.N_T = settings.N_T;
+    PricingResult coarse = solve(result.N, result.N_T, workspace);
+    std::optional<PricingResult> previous; // extrapolation of the previous pair
+    result.grids = 1;
+    result.nodes = static_cast<std::size_t>(result.N) * result.N_T;
+    while (2 * result.N - 1 <= settings.maxN) {
+        result.N = 2 * result.N - 1;
+        result.N_T = 2 * result.N_T - 1;
+        result.finest = solve(result.N, result.N_T, workspace);
+        result.grids++;
+        result.nodes += static_cast<std::size_t>(result.N) * result.N_T;
+        result.extrapolated = extrapolate(coarse, result.finest);
+        if (previous) {
+            result.errorEstimate = std::abs(result.extrapolated.price - previous->price);
+            result.converged = result.errorEstimate <= settings.tolerance;
+            if (result.converged) {
+                break;
+            }
+        } else {
+            result.errorEstimate = std::abs(result.finest.price - coarse.price) / 3;
+        }
+        coarse = result.finest;
+        previous = result.extrapolated;
+    }
+    return result;
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include "Pricers.hpp"
+#include <functional>
+
+// boundary values as a function of (t, x) on the part of the mesh selected by ToggleDir(dir, pos), i.e. independent of the grid
+struct BoundarySpec {
+    std::function<double(double, double)> function;
+    bool dir;
+    bool pos;
+};
+
+struct AdaptiveGridSettings {
+    double tolerance = 1e-3; // on the extrapolated price
+    int N = 65; // coarsest grid, N odd so that x0 stays a node; every refinement halves dx and dt
+    int N_T = 33;
+    int maxN = 4097; // no finer grid than this in x, the result then says it didn't converge
+    double width = 5; // R = width * sigma_0 * sqrt(T), the truncation of the domain is not part of the error estimate
+    MeshStretching stretching; // same map on every grid (centering it on the strike keeps the convergence smooth)
+    double theta = 0.5;
+};
+
+struct AdaptiveGridResult {
+    PricingResult extrapolated; // Richardson: order 2 for price, delta and gamma, order 1 for theta (one sided in t)
+    PricingResult finest; // plain result on the last grid
+    double errorEstimate; // of the extrapolated price
+    bool converged; // errorEstimate <= tolerance
+    int N; // last grid solved
+    int N_T;
+    std::size_t grids; // number of grids solved
+    std::size_t nodes; // work: sum of N * N_T over the grids solved
+};
+
+// prices a contract to a price tolerance instead of on a given grid: solves grids refined by 2 in x and t from the
+// coarsest one, Richardson-extrapolates each pair and stops at the first grid whose estimate meets the tolerance.
+// the estimate is the change of the extrapolated price between the last two pairs, so at least three grids are solved
+// (a single pair can't tell coarse grids that are not yet in the asymptotic range, e.g. a strike between two nodes)
+class AdaptiveGridPricer {
+private:
+    const Contract& contract;
+    double sigma_0;
+    // copied, the boundary conditions of every grid refer to them
+    BoundarySpec volSpec;
+    BoundarySpec rateSpec;
+    BoundarySpec additionalSpec;
+    AdaptiveGridSettings settings;
+
+    PricingResult solve(int N, int N_T, PricingWorkspace& workspace) const;
+
+public:
+    AdaptiveGridPricer(const Contract& contract, double sigma_0, const BoundarySpec& volBC, const BoundarySpec& rateBC,
+                       const BoundarySpec& additionalBC, const AdaptiveGridSettings& settings = AdaptiveGridSettings());
+    AdaptiveGridResult price() const;
+};
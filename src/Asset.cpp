@@ -1,4 +1,5 @@
 #include "Asset.hpp"
+#include <stdexcept>
 
 Asset::Asset(double S0, const ItoDynamics& volDynamics, const ItoDynamics& rateDynamics)
     : S0(S0), volDynamics(volDynamics), rateDynamics(rateDynamics) {}
@@ -15,13 +16,43 @@ const ItoDynamics& Asset::getRateDynamics() const {
     return rateDynamics;
 }
 
-Contract::Contract(const Asset& underlying, const std::function<double(double)>& payoff, double maturity)
-    : underlying(underlying), payoff(std::move(payoff)), T(maturity) {}
+Contract::Contract(const Asset& underlying, const std::function<double(double)>& payoff, double maturity, const Exercise& exercise)
+    : Contract(referenced(underlying), payoff, maturity, exercise) {}
 
-const Asset& Contract::getUnderlying() const {
+Contract::Contract(std::shared_ptr<const Asset> underlying, const std::function<double(double)>& payoff, double maturity,
+                   const Exercise& exercise)
+    : underlying(checkedUnderlying(std::move(underlying))), payoff(payoff), T(maturity), exercise(checkedExercise(exercise, maturity)) {}
+
+std::shared_ptr<const Asset> Contract::referenced(const Asset& underlying) {
+    // aliasing an empty shared_ptr: points at the asset without owning it
+    return std::shared_ptr<const Asset>(std::shared_ptr<const Asset>(), &underlying);
+}
+
+std::shared_ptr<const Asset> Contract::checkedUnderlying(std::shared_ptr<const Asset> underlying) {
+    if (!underlying) {
+        throw std::invalid_argument("contract without an underlying.");
+    }
     return underlying;
 }
 
+Exercise Contract::checkedExercise(const Exercise& exercise, double maturity) {
+    if (exercise.style == ExerciseStyle::Bermudan) {
+        if (exercise.dates.empty()) {
+            throw std::invalid_argument("bermudan exercise needs at least one date.");
+        }
+        for (double date : exercise.dates) {
+            if (!(date >= 0 && date <= maturity)) {
+                throw std::invalid_argument("bermudan exercise date outside [0, maturity].");
+            }
+        }
+    }
+    return exercise;
+}
+
+const Asset& Contract::getUnderlying() const {
+    return *underlying;
+}
+
 const std::function<double(double)>& Contract::getPayoff() const {
     return payoff;
 }
@@ -29,3 +60,36 @@ const std::function<double(double)>& Contract::getPayoff() const {
 double Contract::getMaturity() const {
     return T;
 }
+
+const Exercise& Contract::getExercise() const {
+    return exercise;
+}
+
+void Contract::applyPayoff(const SpaceTimeMesh& stm, double* lastSlice) const {
+    PRICER_PHASE(PricingPhase::Payoff);
+    PRICER_COUNT_NODES(stm.get_N(), stm.get_N() * sizeof(double));
+    std::size_t last = stm.get_N_T() - 1;
+    if (kernel) {
+        kernel->applySlice(stm, last, lastSlice);
+        return;
+    }
+    for (std::size_t i = 0; i < stm.get_N(); i++) {
+        lastSlice[i] = payoff(std::exp(stm.getCoords(i, last).first));
+    }
+}
+
+void Contract::applyPayoff(const double* S, double* payoffs, std::size_t count) const {
+    PRICER_PHASE(PricingPhase::Payoff);
+    PRICER_COUNT_NODES(count, count * sizeof(double));
+    if (kernel) {
+        kernel->applyPaths(S, payoffs, count);
+        return;
+    }
+    for (std::size_t k = 0; k < count; k++) {
+        payoffs[k] = payoff(S[k]);
+    }
+}
+
+const PayoffKernel* Contract::getKernel() const {
+    return kernel.get();
+}
@@ -1,6 +1,10 @@
 #pragma once
 #include "ItoProcess.hpp"
 #include <functional>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
 
 
 class Asset {
@@ -18,17 +22,88 @@ public:
 
 };
 
+struct VanillaCallPayoff {
+    double K;
+    double operator()(double S) const { return std::max(S - K, 0.); }
+};
+
+struct VanillaPutPayoff {
+    double K;
+    double operator()(double S) const { return std::max(K - S, 0.); }
+};
+
+// payoff of a whole time slice with the payoff type known at compile time
+class PayoffKernel {
+public:
+    virtual ~PayoffKernel() = default;
+    virtual void applySlice(const SpaceTimeMesh& stm, std::size_t n, double* slice) const = 0;
+    virtual void applyPaths(const double* S, double* payoffs, std::size_t count) const = 0;
+};
+
+template <typename F>
+class TypedPayoffKernel : public PayoffKernel {
+private:
+    F payoff;
+
+public:
+    explicit TypedPayoffKernel(const F& payoff) : payoff(payoff) {}
+    void applySlice(const SpaceTimeMesh& stm, std::size_t n, double* slice) const override {
+        for (std::size_t i = 0; i < stm.get_N(); i++) {
+            slice[i] = payoff(std::exp(stm.getCoords(i, n).first));
+        }
+    }
+    void applyPaths(const double* S, double* payoffs, std::size_t count) const override {
+        for (std::size_t k = 0; k < count; k++) {
+            payoffs[k] = payoff(S[k]);
+        }
+    }
+};
+
+// when the holder may receive the payoff: at maturity only, at any time before it, or at maturity and on given dates
+enum class ExerciseStyle { European, American, Bermudan };
+
+struct Exercise {
+    ExerciseStyle style = ExerciseStyle::European;
+    std::vector<double> dates; // Bermudan only, times in [0, T]
+};
+
 class Contract {
 private:
-    const Asset& underlying; // possibility of many contracts for same underlying
+    // possibility of many contracts for same underlying: shared when given as a shared_ptr, only referenced (the
+    // asset has to outlive the contract) when given as a reference
+    std::shared_ptr<const Asset> underlying;
     std::function<double(double)> payoff;
     double T;
-    
+    std::shared_ptr<const PayoffKernel> kernel; // only when built from a concrete payoff type
+    Exercise exercise;
+
+    // std::invalid_argument for a Bermudan exercise without dates or with dates outside [0, T]
+    static Exercise checkedExercise(const Exercise& exercise, double maturity);
+    static std::shared_ptr<const Asset> referenced(const Asset& underlying); // non owning
+    // std::invalid_argument for a null underlying
+    static std::shared_ptr<const Asset> checkedUnderlying(std::shared_ptr<const Asset> underlying);
+
 public:
-    Contract(const Asset& underlying, const std::function<double(double)>& payoff, double maturity);
+    Contract(const Asset& underlying, const std::function<double(double)>& payoff, double maturity, const Exercise& exercise = Exercise());
+    Contract(std::shared_ptr<const Asset> underlying, const std::function<double(double)>& payoff, double maturity,
+             const Exercise& exercise = Exercise());
+    // VanillaCallPayoff, VanillaPutPayoff or any callable of S: evaluated without std::function on the grid
+    template <typename F, std::enable_if_t<std::is_invocable_r_v<double, const F&, double> && !is_std_function<F>::value, int> = 0>
+    Contract(const Asset& underlying, const F& payoff, double maturity, const Exercise& exercise = Exercise())
+        : Contract(referenced(underlying), payoff, maturity, exercise) {}
+    template <typename F, std::enable_if_t<std::is_invocable_r_v<double, const F&, double> && !is_std_function<F>::value, int> = 0>
+    Contract(std::shared_ptr<const Asset> underlying, const F& payoff, double maturity, const Exercise& exercise = Exercise())
+        : underlying(checkedUnderlying(std::move(underlying))), payoff(payoff), T(maturity),
+          kernel(std::make_shared<const TypedPayoffKernel<F>>(payoff)), exercise(checkedExercise(exercise, maturity)) {}
     const Asset& getUnderlying() const;
     const std::function<double(double)>& getPayoff() const;
     double getMaturity() const;
+    const Exercise& getExercise() const;
+    // payoff(S = e^x) at every node of the maturity slice
+    void applyPayoff(const SpaceTimeMesh& stm, double* lastSlice) const;
+    // payoff of count terminal spots (simulated paths)
+    void applyPayoff(const double* S, double* payoffs, std::size_t count) const;
+    const PayoffKernel* getKernel() const; // nullptr when built from a std::function
 
 
 };
@@ -0,0 +1,167 @@
+#include "BatchPricer.hpp"
+#include <stdexcept>
+
+namespace {
+// slice n of a stored mesh as doubles: in place for double storage, widened into buffer otherwise
+template <typename Storage>
+const double* widened(const BasicFunctionMesh<Storage>& mesh, std::size_t n, std::vector<double>& buffer) {
+    const Storage* slice = mesh.getTimeSlice(n).data();
+    if constexpr (std::is_same_v<Storage, double>) {
+        return slice;
+    } else {
+        buffer.assign(slice, slice + mesh.getNumRows());
+        return buffer.data();
+    }
+}
+}
+
+template <typename Storage>
+BasicBatchPricer<Storage>::BasicBatchPricer(const Asset& underlying, const SpaceTimeMesh& stm, const BoundaryConditions& volBC, const BoundaryConditions& rateBC)
+    : underlying(underlying), stm(stm), volApprox(stm), rateApprox(stm),
+      stencils(stm.isUniformX() ? std::vector<NonUniformStencil>() : nonuniform_stencils(stm.getXNodes(), stm.get_N())) {
+    volApprox.solve(volBC, underlying.getVolDynamics());
+    rateApprox.solve(rateBC, underlying.getRateDynamics());
+    if constexpr (std::is_same_v<Storage, double>) {
+        opLower.emplace(stm);
+        opDiag.emplace(stm);
+        opUpper.emplace(stm);
+        std::vector<double> volBuffer, rateBuffer;
+        for (std::size_t n = 0; n < stm.get_N_T(); n++) {
+            assemble(n, opLower->getTimeSlice(n).data(), opDiag->getTimeSlice(n).data(), opUpper->getTimeSlice(n).data(), volBuffer, rateBuffer);
+        }
+    }
+}
+
+template <typename Storage>
+void BasicBatchPricer<Storage>::assemble(std::size_t n, double* lower, double* diag, double* upper, std::vector<double>& volBuffer,
+                                         std::vector<double>& rateBuffer) const {
+    const double* vol = widened(volApprox.getProcessMesh(), n, volBuffer);
+    const double* rate = widened(rateApprox.getProcessMesh(), n, rateBuffer);
+    if (stm.isUniformX()) {
+        assemble_operator(vol, rate, stm.get_dx(), lower, diag, upper, stm.get_N());
+    } else {
+        assemble_operator(vol, rate, stencils.data(), lower, diag, upper, stm.get_N());
+    }
+}
+
+template <typename Storage>
+std::vector<PricingResult> BasicBatchPricer<Storage>::price(const std::vector<Contract>& contracts, const BoundaryConditions& additionalBC, double theta) const {
+    return price(contracts, std::vector<const BoundaryConditions*>(contracts.size(), &additionalBC), theta);
+}
+
+template <typename Storage>
+std::vector<PricingResult> BasicBatchPricer<Storage>::price(const std::vector<Contract>& contracts, const std::vector<const BoundaryConditions*>& additionalBCs, double theta) const {
+    assert(theta <= 1 && theta >= 0);
+    if (additionalBCs.size() != contracts.size()) {
+        throw std::invalid_argument("one additional boundary condition per contract expected.");
+    }
+    if (contracts.empty()) {
+        return {};
+    }
+    for (std::size_t k = 0; k < contracts.size(); k++) {
+        if (&contracts[k].getUnderlying() != &underlying) {
+            throw std::invalid_argument("contract isn't written on the batch underlying.");
+        }
+        if (std::abs(contracts[k].getMaturity() - stm.get_T()) > 1e-12) {
+            throw std::invalid_argument("contract maturity doesn't match the mesh.");
+        }
+        if (!additionalBCs[k]->sameFrontier(*additionalBCs[0])) {
+            throw std::invalid_argument("batched boundary conditions must share their frontier.");
+        }
+    }
+
+    PRICER_PHASE(PricingPhase::BackwardSweep);
+    std::size_t N = stm.get_N();
+    std::size_t last = stm.get_N_T() - 1;
+    PRICER_COUNT_NODES(last * N * contracts.size(), last * N * contracts.size() * sizeof(double));
+    // two slices per contract: next (n+1) then current (n)
+    std::vector<double> slices(2 * N * contracts.size(), 0);
+    for (std::size_t k = 0; k < contracts.size(); k++) {
+        double* next = slices.data() + 2 * N * k;
+        additionalBCs[k]->applySlice(stm, last, next);
+        contracts[k].applyPayoff(stm, next);
+    }
+    // early exercise: payoff of the contract at every node (its obstacle) and the slices where it applies
+    std::vector<std::vector<double>> obstacles(contracts.size());
+    std::vector<std::vector<bool>> exerciseSlices(contracts.size());
+    for (std::size_t k = 0; k < contracts.size(); k++) {
+        if (contracts[k].getExercise().style != ExerciseStyle::European) {
+            const double* payoff = slices.data() + 2 * N * k;
+            obstacles[k].assign(payoff, payoff + N);
+            exerciseSlices[k] = exercise_slices(contracts[k].getExercise(), stm);
+        }
+    }
+
+    ThetaScheme scheme(stm, theta);
+    // without stored operators, the ones assembled alternate between two sets of buffers (the scheme reads the
+    // previous one as its explicit part)
+    std::vector<double> assembled[2][3];
+    std::vector<double> volBuffer, rateBuffer;
+    auto useOperator = [&](std::size_t n) {
+        if (opLower) {
+            scheme.useOperator(opLower->getTimeSlice(n).data(), opDiag->getTimeSlice(n).data(), opUpper->getTimeSlice(n).data());
+            return;
+        }
+        std::vector<double>* buffers = assembled[n % 2];
+        for (std::size_t k = 0; k < 3; k++) {
+            buffers[k].resize(N);
+        }
+        assemble(n, buffers[0].data(), buffers[1].data(), buffers[2].data(), volBuffer, rateBuffer);
+        scheme.useOperator(buffers[0].data(), buffers[1].data(), buffers[2].data());
+    };
+    useOperator(last);
+    for (std::size_t n = last; n-- > 0;) {
+        useOperator(n);
+        scheme.prepareSystem(*additionalBCs[0], n);
+        for (std::size_t k = 0; k < contracts.size(); k++) {
+            // the two halves alternate roles every step
+            double* next = slices.data() + 2 * N * k + ((last - n - 1) % 2) * N;
+            double* current = slices.data() + 2 * N * k + ((last - n) % 2) * N;
+            additionalBCs[k]->applySlice(stm, n, current);
+            if (!exerciseSlices[k].empty() && exerciseSlices[k][n]) {
+                const std::vector<double>& obstacle = obstacles[k];
+                scheme.solveSliceProjected(next, current, obstacle.data(), obstacle[0] > obstacle[N - 1]);
+            } else {
+                scheme.solveSlice(next, current);
+            }
+        }
+    }
+
+    std::vector<PricingResult> results(contracts.size());
+    std::size_t mid = N / 2;
+    double dx = stm.get_dx();
+    for (std::size_t k = 0; k < contracts.size(); k++) {
+        const double* t0 = slices.data() + 2 * N * k + (last % 2) * N;
+        const double* t1 = slices.data() + 2 * N * k + ((last - 1) % 2) * N;
+        results[k].price = t0[mid];
+        if (stm.isUniformX()) {
+            results[k].delta = (t0[mid + 1] - t0[mid - 1]) / (2 * dx);
+            results[k].gamma = (t0[mid + 1] + t0[mid - 1] - 2 * t0[mid]) / (dx * dx);
+        } else {
+            NonUniformStencil stencil(stm.getXNodes(), mid, N);
+            results[k].delta = stencil.first[0] * t0[mid - 1] + stencil.first[1] * t0[mid] + stencil.first[2] * t0[mid + 1];
+            results[k].gamma = stencil.second[0] * t0[mid - 1] + stencil.second[1] * t0[mid] + stencil.second[2] * t0[mid + 1];
+        }
+        results[k].theta = (t0[mid] - t1[mid]) / stm.get_dt(0);
+    }
+    return results;
+}
+
+template <typename Storage>
+const BasicItoProcess<Storage>& BasicBatchPricer<Storage>::getVolApprox() const {
+    return volApprox;
+}
+
+template <typename Storage>
+const BasicItoProcess<Storage>& BasicBatchPricer<Storage>::getRateApprox() const {
+    return rateApprox;
+}
+
+template <typename Storage>
+std::size_t BasicBatchPricer<Storage>::memoryFootprint() const {
+    std::size_t cells = stm.get_N() * stm.get_N_T();
+    return 2 * cells * sizeof(Storage) + (opLower ? 3 * cells * sizeof(double) : 0);
+}
+
+template class BasicBatchPricer<float>;
+template class BasicBatchPricer<double>;
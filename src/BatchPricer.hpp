@@ -0,0 +1,42 @@
+#pragma once
+#include "Pricers.hpp"
+#include <optional>
+#include <vector>
+
+// prices many contracts written on one underlying over one mesh (typically a strike ladder):
+// the vol/rate processes are solved and the operator of every slice assembled once in the constructor,
+// then all payoffs go through a single backward sweep where each slice is factored once for the whole batch
+// (American/Bermudan contracts included, projected on their payoff like DiscretePricer).
+// Storage: type the vol/rate processes are kept in, the sweep always runs in double. With float storage (mixed
+// precision) no operator is kept: each slice's operator is assembled in double from the widened processes during the
+// sweep, still once for the whole batch (a float operator loses the discounting, its rows summing to r out of entries
+// of order sigma^2/dx^2). A fifth of the memory of double storage, prices within ~1e-6 of it.
+template <typename Storage>
+class BasicBatchPricer {
+private:
+    const Asset& underlying;
+    const SpaceTimeMesh& stm;
+    BasicItoProcess<Storage> volApprox;
+    BasicItoProcess<Storage> rateApprox;
+    std::vector<NonUniformStencil> stencils; // of a stretched mesh
+    // assembled operator of every slice (lower, diag, upper), double storage only
+    std::optional<FunctionMesh> opLower;
+    std::optional<FunctionMesh> opDiag;
+    std::optional<FunctionMesh> opUpper;
+
+    // operator of slice n from the processes (buffers: room for the widened process slices)
+    void assemble(std::size_t n, double* lower, double* diag, double* upper, std::vector<double>& volBuffer, std::vector<double>& rateBuffer) const;
+
+public:
+    BasicBatchPricer(const Asset& underlying, const SpaceTimeMesh& stm, const BoundaryConditions& volBC, const BoundaryConditions& rateBC);
+    // every contract uses additionalBC
+    std::vector<PricingResult> price(const std::vector<Contract>& contracts, const BoundaryConditions& additionalBC, double theta) const;
+    // one boundary per contract (e.g. strike dependent values), all of them on the same frontier
+    std::vector<PricingResult> price(const std::vector<Contract>& contracts, const std::vector<const BoundaryConditions*>& additionalBCs, double theta) const;
+    const BasicItoProcess<Storage>& getVolApprox() const;
+    const BasicItoProcess<Storage>& getRateApprox() const;
+    std::size_t memoryFootprint() const; // bytes of the stored processes and operators
+};
+
+using BatchPricer = BasicBatchPricer<double>;
+using MixedBatchPricer = BasicBatchPricer<float>;
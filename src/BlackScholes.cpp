@@ -0,0 +1,258 @@
+#include "BlackScholes.hpp"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#endif
+
+namespace {
+const double LOG2E = 1.4426950408889634;
+const double LN2_HI = 6.93147180369123816490e-01; // ln 2 split so that k*LN2_HI is exact
+const double LN2_LO = 1.90821492927058770002e-10;
+const double EXP_MIN = -708.39;
+const double EXP_MAX = 709.78;
+const double SQRT2 = 1.4142135623730951;
+const double INV_SQRT_2PI = 0.3989422804014327;
+const double SQRT_2PI = 2.5066282746310002;
+
+// 1/n! for the exp polynomial and 1/(2n+1) for the log series
+const double EXP_COEFFS[13] = {1.0, 1.0, 1.0 / 2, 1.0 / 6, 1.0 / 24, 1.0 / 120, 1.0 / 720, 1.0 / 5040, 1.0 / 40320, 1.0 / 362880,
+                               1.0 / 3628800, 1.0 / 39916800, 1.0 / 479001600};
+const double LOG_COEFFS[10] = {1.0, 1.0 / 3, 1.0 / 5, 1.0 / 7, 1.0 / 9, 1.0 / 11, 1.0 / 13, 1.0 / 15, 1.0 / 17, 1.0 / 19};
+// Hart (1968) as given by West, "Better approximations to cumulative normal functions"
+const double HART_NUM[7] = {3.52624965998911e-02, 0.700383064443688, 6.37396220353165, 33.912866078383,
+                            112.079291497871, 221.213596169931, 220.206867912376};
+const double HART_DEN[8] = {8.83883476483184e-02, 1.75566716318264, 16.064177579207, 86.7807322029461,
+                            296.564248779674, 637.333633378831, 793.826512519948, 440.413735824752};
+const double HART_SWITCH = 7.07106781186547;
+const double CDF_CUTOFF = 37;
+
+// lower tail Phi(-|x|) and exp(-x^2/2) (shared with the density)
+void normal_tail(double x, double& tail, double& gauss) {
+    double ax = std::abs(x);
+    gauss = fast_exp(-0.5 * ax * ax);
+    if (ax > CDF_CUTOFF) {
+        tail = 0;
+    } else if (ax < HART_SWITCH) {
+        double num = HART_NUM[0];
+        for (int k = 1; k < 7; k++) num = num * ax + HART_NUM[k];
+        double den = HART_DEN[0];
+        for (int k = 1; k < 8; k++) den = den * ax + HART_DEN[k];
+        tail = gauss * num / den;
+    } else {
+        double fraction = ax + 0.65;
+        fraction = ax + 4 / fraction;
+        fraction = ax + 3 / fraction;
+        fraction = ax + 2 / fraction;
+        fraction = ax + 1 / fraction;
+        tail = gauss / fraction / SQRT_2PI;
+    }
+}
+
+void quote(OptionType type, double S, double K, double T, double r, double sigma, double& price, double& delta, double& gamma,
+           double& theta, double& vega, double& rho) {
+    double sqrtT = std::sqrt(T);
+    double volSqrtT = sigma * sqrtT;
+    double d1 = (fast_log(S / K) + (r + 0.5 * sigma * sigma) * T) / volSqrtT;
+    double d2 = d1 - volSqrtT;
+    double tail1, gauss1, tail2, gauss2;
+    normal_tail(d1, tail1, gauss1);
+    normal_tail(d2, tail2, gauss2);
+    // N(d) and N(-d) both from the tail, no cancellation in the far wings
+    double N1 = d1 > 0 ? 1 - tail1 : tail1;
+    double N1m = d1 > 0 ? tail1 : 1 - tail1;
+    double N2 = d2 > 0 ? 1 - tail2 : tail2;
+    double N2m = d2 > 0 ? tail2 : 1 - tail2;
+    double discountedK = K * fast_exp(-r * T);
+    double pdf1 = gauss1 * INV_SQRT_2PI;
+    double timeDecay = -S * pdf1 * sigma / (2 * sqrtT);
+    if (type == OptionType::Call) {
+        price = S * N1 - discountedK * N2;
+        delta = N1;
+        theta = timeDecay - r * discountedK * N2;
+        rho = T * discountedK * N2;
+    } else {
+        price = discountedK * N2m - S * N1m;
+        delta = -N1m;
+        theta = timeDecay + r * discountedK * N2m;
+        rho = -T * discountedK * N2m;
+    }
+    gamma = pdf1 / (S * volSqrtT);
+    vega = S * pdf1 * sqrtT;
+}
+
+#if defined(__AVX2__) && defined(__FMA__)
+__m256d exp4(__m256d x) {
+    const __m256d magic = _mm256_set1_pd(6755399441055744.0); // 2^52 + 2^51: k + magic holds k in its low bits
+    __m256d underflow = _mm256_cmp_pd(x, _mm256_set1_pd(EXP_MIN), _CMP_LT_OQ);
+    x = _mm256_min_pd(_mm256_max_pd(x, _mm256_set1_pd(EXP_MIN)), _mm256_set1_pd(EXP_MAX));
+    __m256d k = _mm256_round_pd(_mm256_mul_pd(x, _mm256_set1_pd(LOG2E)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256d r = _mm256_sub_pd(_mm256_sub_pd(x, _mm256_mul_pd(k, _mm256_set1_pd(LN2_HI))), _mm256_mul_pd(k, _mm256_set1_pd(LN2_LO)));
+    __m256d p = _mm256_set1_pd(EXP_COEFFS[12]);
+    for (int n = 11; n >= 0; n--) {
+        p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(EXP_COEFFS[n]));
+    }
+    // 2^k as 2^k1 * 2^(k - k1): k reaches 1024 near EXP_MAX, past the largest exponent
+    __m256d k1 = _mm256_floor_pd(_mm256_mul_pd(k, _mm256_set1_pd(0.5)));
+    __m256d result = p;
+    for (__m256d part : {k1, _mm256_sub_pd(k, k1)}) {
+        __m256i ki = _mm256_sub_epi64(_mm256_castpd_si256(_mm256_add_pd(part, magic)), _mm256_castpd_si256(magic));
+        __m256i scale = _mm256_slli_epi64(_mm256_add_epi64(ki, _mm256_set1_epi64x(1023)), 52);
+        result = _mm256_mul_pd(result, _mm256_castsi256_pd(scale));
+    }
+    return _mm256_andnot_pd(underflow, result);
+}
+
+__m256d log4(__m256d x) {
+    const __m256i bits = _mm256_castpd_si256(x);
+    const __m256d two52 = _mm256_set1_pd(4503599627370496.0);
+    __m256i biased = _mm256_srli_epi64(bits, 52);
+    __m256d e = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(biased, _mm256_castpd_si256(two52))), two52);
+    e = _mm256_sub_pd(e, _mm256_set1_pd(1023));
+    // mantissa in [1, 2), brought to [sqrt(1/2), sqrt(2))
+    __m256d m = _mm256_castsi256_pd(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi64x(0x000FFFFFFFFFFFFFLL)),
+                                                    _mm256_set1_epi64x(0x3FF0000000000000LL)));
+    __m256d high = _mm256_cmp_pd(m, _mm256_set1_pd(SQRT2), _CMP_GT_OQ);
+    m = _mm256_blendv_pd(m, _mm256_mul_pd(m, _mm256_set1_pd(0.5)), high);
+    e = _mm256_add_pd(e, _mm256_and_pd(high, _mm256_set1_pd(1.0)));
+    __m256d one = _mm256_set1_pd(1.0);
+    __m256d f = _mm256_div_pd(_mm256_sub_pd(m, one), _mm256_add_pd(m, one));
+    __m256d s = _mm256_mul_pd(f, f);
+    __m256d p = _mm256_set1_pd(LOG_COEFFS[9]);
+    for (int n = 8; n >= 0; n--) {
+        p = _mm256_fmadd_pd(p, s, _mm256_set1_pd(LOG_COEFFS[n]));
+    }
+    __m256d logM = _mm256_mul_pd(_mm256_add_pd(f, f), p);
+    return _mm256_add_pd(_mm256_fmadd_pd(e, _mm256_set1_pd(LN2_HI), logM), _mm256_mul_pd(e, _mm256_set1_pd(LN2_LO)));
+}
+
+void normal_tail4(__m256d x, __m256d& tail, __m256d& gauss) {
+    __m256d ax = _mm256_andnot_pd(_mm256_set1_pd(-0.0), x);
+    gauss = exp4(_mm256_mul_pd(_mm256_set1_pd(-0.5), _mm256_mul_pd(ax, ax)));
+    __m256d num = _mm256_set1_pd(HART_NUM[0]);
+    for (int k = 1; k < 7; k++) num = _mm256_fmadd_pd(num, ax, _mm256_set1_pd(HART_NUM[k]));
+    __m256d den = _mm256_set1_pd(HART_DEN[0]);
+    for (int k = 1; k < 8; k++) den = _mm256_fmadd_pd(den, ax, _mm256_set1_pd(HART_DEN[k]));
+    __m256d rational = _mm256_div_pd(_mm256_mul_pd(gauss, num), den);
+    __m256d fraction = _mm256_add_pd(ax, _mm256_set1_pd(0.65));
+    fraction = _mm256_add_pd(ax, _mm256_div_pd(_mm256_set1_pd(4), fraction));
+    fraction = _mm256_add_pd(ax, _mm256_div_pd(_mm256_set1_pd(3), fraction));
+    fraction = _mm256_add_pd(ax, _mm256_div_pd(_mm256_set1_pd(2), fraction));
+    fraction = _mm256_add_pd(ax, _mm256_div_pd(_mm256_set1_pd(1), fraction));
+    __m256d asymptotic = _mm256_div_pd(_mm256_div_pd(gauss, fraction), _mm256_set1_pd(SQRT_2PI));
+    tail = _mm256_blendv_pd(asymptotic, rational, _mm256_cmp_pd(ax, _mm256_set1_pd(HART_SWITCH), _CMP_LT_OQ));
+    tail = _mm256_andnot_pd(_mm256_cmp_pd(ax, _mm256_set1_pd(CDF_CUTOFF), _CMP_GT_OQ), tail);
+}
+
+void quote4(OptionType type, const BlackScholesQuotes& q, const BlackScholesGreeks& g, std::size_t i) {
+    __m256d S = _mm256_loadu_pd(q.S + i);
+    __m256d K = _mm256_loadu_pd(q.K + i);
+    __m256d T = _mm256_loadu_pd(q.T + i);
+    __m256d r = _mm256_loadu_pd(q.r + i);
+    __m256d sigma = _mm256_loadu_pd(q.sigma + i);
+    __m256d half = _mm256_set1_pd(0.5);
+    __m256d one = _mm256_set1_pd(1.0);
+    __m256d zero = _mm256_setzero_pd();
+
+    __m256d sqrtT = _mm256_sqrt_pd(T);
+    __m256d volSqrtT = _mm256_mul_pd(sigma, sqrtT);
+    __m256d carry = _mm256_mul_pd(_mm256_fmadd_pd(_mm256_mul_pd(half, sigma), sigma, r), T);
+    __m256d d1 = _mm256_div_pd(_mm256_add_pd(log4(_mm256_div_pd(S, K)), carry), volSqrtT);
+    __m256d d2 = _mm256_sub_pd(d1, volSqrtT);
+    __m256d tail1, gauss1, tail2, gauss2;
+    normal_tail4(d1, tail1, gauss1);
+    normal_tail4(d2, tail2, gauss2);
+    __m256d positive1 = _mm256_cmp_pd(d1, zero, _CMP_GT_OQ);
+    __m256d positive2 = _mm256_cmp_pd(d2, zero, _CMP_GT_OQ);
+    __m256d N1 = _mm256_blendv_pd(tail1, _mm256_sub_pd(one, tail1), positive1);
+    __m256d N1m = _mm256_blendv_pd(_mm256_sub_pd(one, tail1), tail1, positive1);
+    __m256d N2 = _mm256_blendv_pd(tail2, _mm256_sub_pd(one, tail2), positive2);
+    __m256d N2m = _mm256_blendv_pd(_mm256_sub_pd(one, tail2), tail2, positive2);
+    __m256d discountedK = _mm256_mul_pd(K, exp4(_mm256_sub_pd(zero, _mm256_mul_pd(r, T))));
+    __m256d pdf1 = _mm256_mul_pd(gauss1, _mm256_set1_pd(INV_SQRT_2PI));
+    __m256d SPdf1 = _mm256_mul_pd(S, pdf1);
+    __m256d timeDecay = _mm256_sub_pd(zero, _mm256_div_pd(_mm256_mul_pd(SPdf1, sigma), _mm256_add_pd(sqrtT, sqrtT)));
+    __m256d price, delta, theta, rho;
+    if (type == OptionType::Call) {
+        price = _mm256_sub_pd(_mm256_mul_pd(S, N1), _mm256_mul_pd(discountedK, N2));
+        delta = N1;
+        theta = _mm256_sub_pd(timeDecay, _mm256_mul_pd(_mm256_mul_pd(r, discountedK), N2));
+        rho = _mm256_mul_pd(_mm256_mul_pd(T, discountedK), N2);
+    } else {
+        price = _mm256_sub_pd(_mm256_mul_pd(discountedK, N2m), _mm256_mul_pd(S, N1m));
+        delta = _mm256_sub_pd(zero, N1m);
+        theta = _mm256_add_pd(timeDecay, _mm256_mul_pd(_mm256_mul_pd(r, discountedK), N2m));
+        rho = _mm256_sub_pd(zero, _mm256_mul_pd(_mm256_mul_pd(T, discountedK), N2m));
+    }
+    _mm256_storeu_pd(g.price + i, price);
+    _mm256_storeu_pd(g.delta + i, delta);
+    _mm256_storeu_pd(g.gamma + i, _mm256_div_pd(pdf1, _mm256_mul_pd(S, volSqrtT)));
+    _mm256_storeu_pd(g.theta + i, theta);
+    _mm256_storeu_pd(g.vega + i, _mm256_mul_pd(SPdf1, sqrtT));
+    _mm256_storeu_pd(g.rho + i, rho);
+}
+#endif
+}
+
+double fast_exp(double x) {
+    if (x < EXP_MIN) {
+        return 0;
+    }
+    x = std::fmin(x, EXP_MAX);
+    double k = std::nearbyint(x * LOG2E);
+    double r = (x - k * LN2_HI) - k * LN2_LO;
+    double p = EXP_COEFFS[12];
+    for (int n = 11; n >= 0; n--) {
+        p = p * r + EXP_COEFFS[n];
+    }
+    // 2^k as 2^(k/2) * 2^(k - k/2): k reaches 1024 near EXP_MAX, past the largest exponent
+    std::int64_t ki = static_cast<std::int64_t>(k);
+    for (std::int64_t part : {ki / 2, ki - ki / 2}) {
+        std::int64_t scaleBits = (part + 1023) << 52;
+        double scale;
+        std::memcpy(&scale, &scaleBits, sizeof(scale));
+        p *= scale;
+    }
+    return p;
+}
+
+double fast_log(double x) {
+    std::int64_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    double e = static_cast<double>((bits >> 52) & 0x7FF) - 1023;
+    std::int64_t mantissaBits = (bits & 0x000FFFFFFFFFFFFFLL) | 0x3FF0000000000000LL;
+    double m;
+    std::memcpy(&m, &mantissaBits, sizeof(m));
+    if (m > SQRT2) {
+        m *= 0.5;
+        e += 1;
+    }
+    double f = (m - 1) / (m + 1);
+    double s = f * f;
+    double p = LOG_COEFFS[9];
+    for (int n = 8; n >= 0; n--) {
+        p = p * s + LOG_COEFFS[n];
+    }
+    return (e * LN2_HI + 2 * f * p) + e * LN2_LO;
+}
+
+double fast_norm_cdf(double x) {
+    double tail, gauss;
+    normal_tail(x, tail, gauss);
+    return x > 0 ? 1 - tail : tail;
+}
+
+void black_scholes_batch(OptionType type, const BlackScholesQuotes& quotes, const BlackScholesGreeks& greeks) {
+    std::size_t i = 0;
+#if defined(__AVX2__) && defined(__FMA__)
+    for (; i + 4 <= quotes.size; i += 4) {
+        quote4(type, quotes, greeks, i);
+    }
+#endif
+    for (; i < quotes.size; i++) {
+        quote(type, quotes.S[i], quotes.K[i], quotes.T[i], quotes.r[i], quotes.sigma[i], greeks.price[i], greeks.delta[i],
+              greeks.gamma[i], greeks.theta[i], greeks.vega[i], greeks.rho[i]);
+    }
+}
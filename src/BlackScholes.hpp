@@ -0,0 +1,36 @@
+#pragma once
+#include <cstddef>
+
+enum class OptionType { Call, Put };
+
+// structure of arrays, one entry per quote (T > 0, sigma > 0)
+struct BlackScholesQuotes {
+    const double* S;
+    const double* K;
+    const double* T;
+    const double* r;
+    const double* sigma;
+    std::size_t size;
+};
+
+// outputs of the batch, all of them written (theta per unit of time, vega and rho per unit of sigma and r)
+struct BlackScholesGreeks {
+    double* price;
+    double* delta;
+    double* gamma;
+    double* theta;
+    double* vega;
+    double* rho;
+};
+
+// closed form prices and greeks of european calls or puts in one pass: d1/d2, the densities and the discount factor
+// are computed once per quote, 4 quotes per AVX2 instruction when available (same algorithms on the scalar tail)
+void black_scholes_batch(OptionType type, const BlackScholesQuotes& quotes, const BlackScholesGreeks& greeks);
+
+// the approximations used by the batch (measured against the libm over their range of use):
+// fast_exp: relative error < 4e-16 on [-708, 709.78], 0 below
+// fast_log: relative error < 3e-16 for normal positive doubles (absolute error < 3e-16 around 1)
+// fast_norm_cdf: Hart's double precision rational approximation, absolute error < 1e-15 (0 or 1 beyond |x| > 37)
+double fast_exp(double x);
+double fast_log(double x);
+double fast_norm_cdf(double x);
@@ -0,0 +1,145 @@
+#pragma once
+#include "Pricers.hpp"
+#include <array>
+#include <cmath>
+#include <type_traits>
+
+// uniform N x N_T mesh with its sizes known at compile time, the nodes computed instead of stored: a constexpr mesh
+// gives constexpr dx, dt and coordinates (same nodes as SpaceTimeMesh(x0, R, T, N, N_T))
+template <std::size_t N, std::size_t N_T>
+class FixedSpaceTimeMesh {
+    static_assert(N % 2 == 1 && N >= 3, "N has to be odd, x0 being the middle node");
+    static_assert(N_T >= 2, "the mesh needs the maturity and the pricing slices");
+
+private:
+    double x0;
+    double R;
+    double T;
+
+public:
+    constexpr FixedSpaceTimeMesh(double x0, double R, double T) : x0(x0), R(R), T(T) {}
+    static constexpr std::size_t get_N() { return N; }
+    static constexpr std::size_t get_N_T() { return N_T; }
+    constexpr double get_x0() const { return x0; }
+    constexpr double get_R() const { return R; }
+    constexpr double get_T() const { return T; }
+    constexpr double get_dx() const { return 2*R/(N-1); }
+    constexpr double get_dt() const { return T/(N_T-1); }
+    constexpr std::pair<double, double> getCoords(std::size_t i, std::size_t n) const {
+        return {x0 - R + 2*R * static_cast<double>(i) / static_cast<double>(N - 1), (static_cast<double>(n) / (N_T - 1)) * T};
+    }
+    // the runtime mesh of the same nodes, to hand the problem over to the other pricers
+    SpaceTimeMesh toSpaceTimeMesh() const { return SpaceTimeMesh(x0, R, T, static_cast<int>(N), static_cast<int>(N_T)); }
+};
+
+// lower x edge closed like the upper one (zero gamma in S) when FixedGridPricer::price is given no dirichlet data
+struct NoLowerEdge {};
+
+// european pricing at constant vol and rate on a FixedSpaceTimeMesh, for small grids quoted in a loop: the two rolling
+// slices and the factored system live in the pricer (no heap allocation), the payoff and the lower edge are template
+// arguments (no std::function) and every loop runs to a compile-time bound. Same scheme as DiscretePricer with a
+// constant vol/rate process, so the prices agree with it up to rounding. Greeks in x = log S like DiscretePricer.
+template <std::size_t N, std::size_t N_T>
+class FixedGridPricer {
+private:
+    const FixedSpaceTimeMesh<N, N_T>& mesh;
+    std::array<std::array<double, N>, 2> slices; // t_0 then t_1 once priced
+    std::array<double, N> modLower;
+    std::array<double, N> modUpper;
+    std::array<double, N> invPivots;
+
+    // a*b + c in one rounding where the target has the instruction: the substitutions are chains of these
+    static double multiplyAdd(double a, double b, double c) {
+#if defined(__FMA__)
+        return std::fma(a, b, c);
+#else
+        return a*b + c;
+#endif
+    }
+
+public:
+    explicit FixedGridPricer(const FixedSpaceTimeMesh<N, N_T>& mesh) : mesh(mesh), slices(), modLower(), modUpper(), invPivots() {}
+
+    // payoff(S) on the maturity slice; lowerEdge(t, x), when given, the dirichlet value of node 0 on every other slice
+    template <class Payoff, class LowerEdge = NoLowerEdge>
+    void price(const Payoff& payoff, double sigma, double r, double theta = 0.5, const LowerEdge& lowerEdge = LowerEdge()) {
+        PRICER_PHASE(PricingPhase::BackwardSweep);
+        PRICER_COUNT_NODES((N_T - 1) * N, (N_T - 1) * N * sizeof(double));
+        constexpr bool dirichlet = !std::is_same_v<LowerEdge, NoLowerEdge>;
+        const double dx = mesh.get_dx();
+        const double invDt = 1/mesh.get_dt();
+        const double explicitWeight = 1 - theta;
+
+        // -L with constant coefficients: one stencil (c, b, a) inside, the edge rows closed like close_edges
+        const double sigma2 = sigma*sigma;
+        const double diffusion = 0.5*sigma2/(dx*dx);
+        const double convection = 0.5*(r - 0.5*sigma2)/dx;
+        const double a = -(diffusion + convection);
+        const double b = r + sigma2/(dx*dx);
+        const double c = convection - diffusion;
+        const double firstDiag = b + 2*c/(1 + dx/2);
+        const double firstUpper = a - c*(1 - dx/2)/(1 + dx/2);
+        const double lastDiag = b + 2*a/(1 - dx/2);
+        const double lastLower = c - a*(1 + dx/2)/(1 - dx/2);
+
+        // (I/dt + theta (-L)) factored once from both ends towards the middle node (twisted factorization): the two
+        // eliminations, then the two substitutions, are independent chains of N/2 rows instead of one of N
+        constexpr std::size_t mid = N/2;
+        const double l = theta*c;
+        const double d = theta*b + invDt;
+        const double u = theta*a;
+        const double lastL = theta*lastLower;
+        invPivots[0] = 1/(dirichlet ? 1 : theta*firstDiag + invDt);
+        modUpper[0] = (dirichlet ? 0 : theta*firstUpper)*invPivots[0];
+        invPivots[N-1] = 1/(theta*lastDiag + invDt);
+        modLower[N-1] = lastL*invPivots[N-1];
+        for (std::size_t i = 1; i < mid; i++) {
+            std::size_t j = N - 1 - i;
+            invPivots[i] = 1/(d - l*modUpper[i-1]);
+            modLower[i] = l*invPivots[i];
+            modUpper[i] = u*invPivots[i];
+            invPivots[j] = 1/(d - u*modLower[j+1]);
+            modLower[j] = l*invPivots[j];
+            modUpper[j] = u*invPivots[j];
+        }
+        invPivots[mid] = 1/(d - l*modUpper[mid-1] - u*modLower[mid+1]);
+
+        std::array<double, N>* next = &slices[(N_T - 1) & 1];
+        for (std::size_t i = 0; i < N; i++) {
+            (*next)[i] = payoff(std::exp(mesh.getCoords(i, N_T - 1).first));
+        }
+        for (std::size_t n = N_T - 1; n-- > 0;) {
+            const std::array<double, N>& v = *next;
+            std::array<double, N>& x = slices[n & 1];
+            // right hand side computed row by row inside the eliminations (down to the middle row and up to it), off
+            // their dependency chains, then the middle node and the substitutions outwards
+            auto rhs = [&](std::size_t i) { return v[i]*invDt - explicitWeight*((c*v[i-1] + b*v[i]) + a*v[i+1]); };
+            double first = v[0]*invDt - explicitWeight*(firstDiag*v[0] + firstUpper*v[1]);
+            if constexpr (dirichlet) {
+                std::pair<double, double> edge = mesh.getCoords(0, n);
+                first = lowerEdge(edge.second, edge.first);
+            }
+            double top = x[0] = first*invPivots[0];
+            double bottom = x[N-1] = (v[N-1]*invDt - explicitWeight*(lastLower*v[N-2] + lastDiag*v[N-1]))*invPivots[N-1];
+            for (std::size_t i = 1; i < mid; i++) {
+                std::size_t j = N - 1 - i;
+                top = x[i] = multiplyAdd(-modLower[i], top, rhs(i)*invPivots[i]);
+                bottom = x[j] = multiplyAdd(-modUpper[j], bottom, rhs(j)*invPivots[j]);
+            }
+            top = bottom = x[mid] = (rhs(mid) - l*top - u*bottom)*invPivots[mid];
+            for (std::size_t i = mid; i-- > 0;) {
+                std::size_t j = N - 1 - i;
+                top = x[i] = multiplyAdd(-modUpper[i], top, x[i]);
+                bottom = x[j] = multiplyAdd(-modLower[j], bottom, x[j]);
+            }
+            next = &x;
+        }
+    }
+
+    double priceAt(std::size_t i, std::size_t n) const { return slices[n][i]; } // n = 0 or 1
+    double getPrice() const { return slices[0][N/2]; }
+    double delta() const { return (slices[0][N/2 + 1] - slices[0][N/2 - 1]) / (2*mesh.get_dx()); }
+    double gamma() const { return (slices[0][N/2 + 1] + slices[0][N/2 - 1] - 2*slices[0][N/2]) / (mesh.get_dx()*mesh.get_dx()); }
+    double theta() const { return (slices[0][N/2] - slices[1][N/2]) / mesh.get_dt(); }
+    PricingResult getResult() const { return {getPrice(), delta(), gamma(), theta()}; }
+};
@@ -0,0 +1,126 @@
+#include "Instrumentation.hpp"
+#include <iomanip>
+#include <ostream>
+
+const char* phase_name(PricingPhase phase) {
+    switch (phase) {
+    case PricingPhase::ProcessSolve: return "process solve";
+    case PricingPhase::BoundaryApplication: return "boundary application";
+    case PricingPhase::Payoff: return "payoff";
+    case PricingPhase::BackwardSweep: return "backward sweep";
+    }
+    return "";
+}
+
+PhaseStats& PhaseStats::operator+=(const PhaseStats& other) {
+    calls += other.calls;
+    nanoseconds += other.nanoseconds;
+    nodes += other.nodes;
+    boundaryCalls += other.boundaryCalls;
+    allocations += other.allocations;
+    bytes += other.bytes;
+    return *this;
+}
+
+PricingStats& PricingStats::operator+=(const PricingStats& other) {
+    for (std::size_t p = 0; p < pricingPhaseCount; p++) {
+        phases[p] += other.phases[p];
+    }
+    pricings += other.pricings;
+    return *this;
+}
+
+PhaseStats PricingStats::total() const {
+    PhaseStats sum;
+    for (const PhaseStats& phase : phases) {
+        sum += phase;
+    }
+    return sum;
+}
+
+void PricingStats::report(std::ostream& out) const {
+    PhaseStats sum = total();
+    out << "pricings: " << pricings << ", instrumented time: " << sum.nanoseconds * 1e-6 << " ms" << std::endl;
+    for (std::size_t p = 0; p < pricingPhaseCount; p++) {
+        const PhaseStats& phase = phases[p];
+        out << std::left << std::setw(22) << phase_name(static_cast<PricingPhase>(p)) << std::right
+            << " calls " << std::setw(9) << phase.calls
+            << "  ms " << std::setw(10) << phase.nanoseconds * 1e-6
+            << "  ns/node " << std::setw(8) << (phase.nodes ? static_cast<double>(phase.nanoseconds) / phase.nodes : 0.)
+            << "  nodes " << std::setw(11) << phase.nodes
+            << "  boundary calls " << std::setw(9) << phase.boundaryCalls
+            << "  allocations " << std::setw(6) << phase.allocations
+            << "  MB " << phase.bytes * 1e-6 << std::endl;
+    }
+}
+
+StatsRegistry& StatsRegistry::global() {
+    static StatsRegistry registry;
+    return registry;
+}
+
+void StatsRegistry::add(const PricingStats& delta) {
+    std::lock_guard<std::mutex> lock(mutex);
+    stats += delta;
+}
+
+void StatsRegistry::add(PricingPhase phase, const PhaseStats& delta) {
+    std::lock_guard<std::mutex> lock(mutex);
+    stats[phase] += delta;
+}
+
+PricingStats StatsRegistry::snapshot() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+void StatsRegistry::reset() {
+    std::lock_guard<std::mutex> lock(mutex);
+    stats = PricingStats();
+}
+
+void StatsRegistry::dump(std::ostream& out, bool reset) {
+    PricingStats current;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        current = stats;
+        if (reset) {
+            stats = PricingStats();
+        }
+    }
+    current.report(out);
+}
+
+#ifdef PRICER_INSTRUMENTATION
+namespace instrumentation {
+thread_local PhaseScope* activeScope = nullptr;
+thread_local PricingStats* activeSink = nullptr;
+
+PhaseScope::~PhaseScope() {
+    std::uint64_t elapsed = static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+    stats.calls += parent && parent->phase == phase ? 0 : 1;
+    stats.nanoseconds += elapsed - nestedNanoseconds;
+    if (parent) {
+        parent->nestedNanoseconds += elapsed;
+    }
+    activeScope = parent;
+    if (activeSink) {
+        (*activeSink)[phase] += stats;
+    } else {
+        StatsRegistry::global().add(phase, stats);
+    }
+}
+
+StatsCollector::StatsCollector(PricingStats& target, bool pricing) : target(target), previousSink(activeSink) {
+    collected.pricings = pricing ? 1 : 0;
+    activeSink = &collected;
+}
+
+StatsCollector::~StatsCollector() {
+    activeSink = previousSink;
+    target += collected;
+    StatsRegistry::global().add(collected);
+}
+}
+#endif
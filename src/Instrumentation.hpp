@@ -0,0 +1,109 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <mutex>
+
+// phases of a pricing timed and counted by the instrumentation (built with PRICER_INSTRUMENTATION, compiled out otherwise)
+enum class PricingPhase { ProcessSolve, BoundaryApplication, Payoff, BackwardSweep };
+constexpr std::size_t pricingPhaseCount = 4;
+const char* phase_name(PricingPhase phase);
+
+struct PhaseStats {
+    std::uint64_t calls = 0; // scopes entered (one nested in a scope of the same phase is part of it)
+    std::uint64_t nanoseconds = 0; // wall time, exclusive of the phases nested in it
+    std::uint64_t nodes = 0; // mesh nodes (or paths) computed
+    std::uint64_t boundaryCalls = 0; // boundary function evaluations
+    std::uint64_t allocations = 0; // mesh and rolling buffers allocated
+    std::uint64_t bytes = 0; // bytes of mesh / slice buffers written
+    PhaseStats& operator+=(const PhaseStats& other);
+};
+
+struct PricingStats {
+    std::array<PhaseStats, pricingPhaseCount> phases;
+    std::uint64_t pricings = 0; // price() calls
+    PhaseStats& operator[](PricingPhase phase) { return phases[static_cast<std::size_t>(phase)]; }
+    const PhaseStats& operator[](PricingPhase phase) const { return phases[static_cast<std::size_t>(phase)]; }
+    PricingStats& operator+=(const PricingStats& other);
+    PhaseStats total() const;
+    // one line per phase: calls, time, ns/node and the counters
+    void report(std::ostream& out) const;
+};
+
+// process wide totals of every instrumented scope, safe to read and dump from any thread while pricings run
+class StatsRegistry {
+private:
+    mutable std::mutex mutex;
+    PricingStats stats;
+
+public:
+    static StatsRegistry& global();
+    void add(const PricingStats& delta);
+    void add(PricingPhase phase, const PhaseStats& delta);
+    PricingStats snapshot() const;
+    void reset();
+    // snapshot report, then reset if asked (periodic dumps of what happened since the last one)
+    void dump(std::ostream& out, bool reset = false);
+};
+
+#ifdef PRICER_INSTRUMENTATION
+namespace instrumentation {
+class PhaseScope;
+// innermost phase of the thread (counters go there) and collector of the thread's scopes (registry when none)
+extern thread_local PhaseScope* activeScope;
+extern thread_local PricingStats* activeSink;
+
+class PhaseScope {
+private:
+    PricingPhase phase;
+    PhaseStats stats;
+    std::chrono::steady_clock::time_point start;
+    std::uint64_t nestedNanoseconds = 0;
+    PhaseScope* parent;
+
+public:
+    explicit PhaseScope(PricingPhase phase) : phase(phase), start(std::chrono::steady_clock::now()), parent(activeScope) {
+        activeScope = this;
+    }
+    PhaseScope(const PhaseScope&) = delete;
+    PhaseScope& operator=(const PhaseScope&) = delete;
+    ~PhaseScope();
+    PhaseStats& counters() { return stats; }
+};
+
+// routes the scopes of the thread to target (and to the registry) while alive
+class StatsCollector {
+private:
+    PricingStats& target;
+    PricingStats collected;
+    PricingStats* previousSink;
+
+public:
+    StatsCollector(PricingStats& target, bool pricing);
+    StatsCollector(const StatsCollector&) = delete;
+    StatsCollector& operator=(const StatsCollector&) = delete;
+    ~StatsCollector();
+};
+
+inline void count(std::uint64_t PhaseStats::*counter, std::uint64_t amount) {
+    if (activeScope) {
+        activeScope->counters().*counter += amount;
+    }
+}
+}
+
+#define PRICER_PHASE(phase) instrumentation::PhaseScope pricerPhaseScope(phase)
+#define PRICER_COLLECT_STATS(target, pricing) instrumentation::StatsCollector pricerStatsCollector(target, pricing)
+// nodes computed and the bytes they take, boundary function evaluations, buffer allocations
+#define PRICER_COUNT_NODES(n, size) (instrumentation::count(&PhaseStats::nodes, (n)), instrumentation::count(&PhaseStats::bytes, (size)))
+#define PRICER_COUNT_BOUNDARY_CALLS(n) instrumentation::count(&PhaseStats::boundaryCalls, (n))
+#define PRICER_COUNT_ALLOCATIONS(n) instrumentation::count(&PhaseStats::allocations, (n))
+#else
+#define PRICER_PHASE(phase) ((void)0)
+#define PRICER_COLLECT_STATS(target, pricing) ((void)0)
+#define PRICER_COUNT_NODES(n, size) ((void)0)
+#define PRICER_COUNT_BOUNDARY_CALLS(n) ((void)0)
+#define PRICER_COUNT_ALLOCATIONS(n) ((void)0)
+#endif
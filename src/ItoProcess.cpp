@@ -1,5 +1,6 @@
 #include "ItoProcess.hpp"
 #include <cmath>
+#include <algorithm>
 
 std::pair<std::function<double(double, double, double)>, std::function<double(double, double, double)>>
 ItoDynamics::convert_S_to_x(const std::function<double(double, double, double)>& f,
@@ -30,117 +31,299 @@ double ItoDynamics::getPseudoVol(double t, double x, double p) const {
     return partial_x(t, x, p);
 }
 
-ItoProcess::ItoProcess(const SpaceTimeMesh& stm) :processMesh(stm) {
+void ItoDynamics::evaluate(double t, const double* x, const double* p, double* drift, double* pseudoVol, std::size_t count) const {
+    if (kernel) {
+        kernel->evaluate(t, x, p, drift, pseudoVol, count);
+        return;
+    }
+    for (std::size_t k = 0; k < count; k++) {
+        drift[k] = partial_t(t, x[k], p[k]);
+        pseudoVol[k] = partial_x(t, x[k], p[k]);
+    }
+}
 
+const DynamicsKernel* ItoDynamics::getKernel() const {
+    return kernel.get();
 }
 
-void ItoProcess::solve(const BoundaryConditions& bc, const ItoDynamics& dynamics) {
-    processMesh.applyBoundaryConditions(bc);
-    double dx = processMesh.getSpaceTimeMesh().get_dx();
-    double dt = processMesh.getSpaceTimeMesh().get_dt();
+template <typename T>
+BasicItoProcess<T>::BasicItoProcess(const SpaceTimeMesh& stm, PricingArena* arena) :processMesh(stm, arena) {
+
+}
+
+template <typename T>
+ProcessLayout BasicItoProcess<T>::detectLayout(const BoundaryConditions& bc, std::size_t N, std::size_t N_T) {
     bool flag1 = true; // check for easy case, itoprocess given at t= 0
-    for (int x = 0; x < processMesh.getNumRows(); x++) {
-            if (!bc.check(x, 0)) {
-                flag1 = false;
-            }
-    }
     bool flag2 = true; // check for easy case, itoprocess given at t= T
-    for (int x = 0; x < processMesh.getNumRows(); x++) {
-            if (!bc.check(x, processMesh.getNumCols()-1)) {
-                flag2 = false;
-            }
+    for (std::size_t x = 0; x < N; x++) {
+        flag1 = flag1 && bc.check(x, 0);
+        flag2 = flag2 && bc.check(x, N_T-1);
     }
     bool flag3 = true; // check for easy case, itoprocess given at x= 0 (i.e inf x)
-    for (int y= 0; y < processMesh.getNumCols(); y++) {
-            if (!bc.check(0, y)) {
-                flag3 = false;
-            }
-    }
     bool flag4 = true; // check for easy case, itoprocess given at x= -1 (i.e sup x)
-    for (int y= 0; y < processMesh.getNumCols(); y++) {
-        if (!bc.check(processMesh.getNumRows()-1, y)) {
-                flag4 = false;
-            }
+    for (std::size_t y = 0; y < N_T; y++) {
+        flag3 = flag3 && bc.check(0, y);
+        flag4 = flag4 && bc.check(N-1, y);
     }
-    
-    if (flag1){
-        for (int y = 1; y<processMesh.getNumCols(); y++){
-            for (int x = 0; x<processMesh.getNumRows();x++){
-                std::pair<double, double> spaceTimeCoords = processMesh.getSpaceTimeMesh().getCoords(x, y);
-                processMesh.setMeshData(x, y,  processMesh.getMeshData(x, y-1) + dt*dynamics.getDrift(spaceTimeCoords.second, spaceTimeCoords.first, processMesh.getMeshData(x, y-1)));
-            }
+    if (flag1) return ProcessLayout::GivenAtStart;
+    if (flag2) return ProcessLayout::GivenAtEnd;
+    if (flag3) return ProcessLayout::GivenAtLowerX;
+    if (flag4) return ProcessLayout::GivenAtUpperX;
+    return ProcessLayout::General;
+}
+
+template <typename T>
+void BasicItoProcess<T>::stepInTime(const SpaceTimeMesh& stm, const ItoDynamics& dynamics, const double* from, double* to, std::size_t n, double signedDt) {
+    if (const DynamicsKernel* kernel = dynamics.getKernel()) {
+        kernel->stepInTime(stm, from, to, n, signedDt);
+        return;
+    }
+    for (std::size_t x = 0; x < stm.get_N(); x++) {
+        std::pair<double, double> spaceTimeCoords = stm.getCoords(x, n);
+        to[x] = from[x] + signedDt*dynamics.getDrift(spaceTimeCoords.second, spaceTimeCoords.first, from[x]);
+    }
+}
+
+template <typename T>
+void BasicItoProcess<T>::sweepInX(const SpaceTimeMesh& stm, const ItoDynamics& dynamics, double* slice, std::size_t n, bool upward) {
+    if (const DynamicsKernel* kernel = dynamics.getKernel()) {
+        kernel->sweepInX(stm, slice, n, upward);
+        return;
+    }
+    if (upward) {
+        for (std::size_t x = 1; x < stm.get_N(); x++) {
+            std::pair<double, double> spaceTimeCoords = stm.getCoords(x, n);
+            slice[x] = slice[x-1] + stm.get_dx(x-1)*dynamics.getPseudoVol(spaceTimeCoords.second, spaceTimeCoords.first, slice[x-1]);
         }
-    }else if (flag2){
-        for (int y = processMesh.getNumCols()-2; y>=0; y-- ){
-            for (int x= 0; x<processMesh.getNumRows(); x++){
-                std::pair<double, double> spaceTimeCoords = processMesh.getSpaceTimeMesh().getCoords(x, y);
-                processMesh.setMeshData(x, y,  processMesh.getMeshData(x, y+1) - dt*dynamics.getDrift(spaceTimeCoords.second, spaceTimeCoords.first, processMesh.getMeshData(x, y+1)));
-            }
+    } else {
+        for (std::size_t x = stm.get_N() - 1; x-- > 0;) {
+            std::pair<double, double> spaceTimeCoords = stm.getCoords(x, n);
+            slice[x] = slice[x+1] - stm.get_dx(x)*dynamics.getPseudoVol(spaceTimeCoords.second, spaceTimeCoords.first, slice[x+1]);
         }
-        
-    }else if (flag3){
-        for (int y =0; y<processMesh.getNumCols(); y++){
-            for (int x= 1; x<processMesh.getNumRows(); x++){
-                std::pair<double, double> spaceTimeCoords = processMesh.getSpaceTimeMesh().getCoords(x, y);
-                processMesh.setMeshData(x, y,  processMesh.getMeshData(x-1, y) + dx*dynamics.getPseudoVol(spaceTimeCoords.second, spaceTimeCoords.first, processMesh.getMeshData(x-1, y)));
-            }
+    }
+}
+
+template <typename T>
+void BasicItoProcess<T>::propagate(const BoundaryConditions& bc, const ItoDynamics& dynamics) {
+    // breadth first from every frontier node at once: each node is reached once, from its neighbour
+    // closest to the frontier, seeds in mesh order then neighbours in a fixed direction order (deterministic)
+    const SpaceTimeMesh& stm = processMesh.getSpaceTimeMesh();
+    std::size_t N = processMesh.getNumRows();
+    std::size_t N_T = processMesh.getNumCols();
+    std::vector<unsigned char> visited(N * N_T, 0);
+    std::vector<std::size_t> queue; // node y*N + x, every node is pushed at most once
+    queue.reserve(N * N_T);
+    std::vector<std::size_t> rows;
+    for (std::size_t y = 0; y < N_T; y++) {
+        bc.collectSlice(y, N, rows);
+        for (std::size_t x : rows) {
+            visited[y * N + x] = 1;
+            queue.push_back(y * N + x);
         }
-        
-    }else if (flag4){
-        for (int y =0; y<processMesh.getNumCols(); y++){
-            for (int x= processMesh.getNumRows()-2; x>=0; x++){
-                std::pair<double, double> spaceTimeCoords = processMesh.getSpaceTimeMesh().getCoords(x, y);
-                processMesh.setMeshData(x, y,  processMesh.getMeshData(x+1, y) - dx*dynamics.getPseudoVol(spaceTimeCoords.second, spaceTimeCoords.first, processMesh.getMeshData(x+1, y)));
+    }
+
+    const int dirs[4][2] = {{-1, 0}, {0, -1}, {0, 1}, {1, 0}}; // (dx, dt) steps
+    for (std::size_t head = 0; head < queue.size(); head++) {
+        std::size_t x = queue[head] % N;
+        std::size_t y = queue[head] / N;
+        double value = processMesh.getMeshData(x, y);
+        std::pair<double, double> spaceTimeCoords = stm.getCoords(x, y);
+        bool driftKnown = false, pseudoVolKnown = false;
+        double drift = 0, pseudoVol = 0;
+        for (const auto& dir : dirs) {
+            if ((dir[0] < 0 && x == 0) || (dir[0] > 0 && x + 1 == N) || (dir[1] < 0 && y == 0) || (dir[1] > 0 && y + 1 == N_T)) {
+                continue;
             }
-        }
-        
-    }else{
-        std::set<std::pair<int, int>> visited;
-        std::set<std::pair<int, int>> not_visited;
-
-        for (int x = 0; x < processMesh.getNumRows(); x++) {
-            for (int y = 0; y < processMesh.getNumCols(); y++) {
-                if (bc.check(x, y)) {
-                    visited.insert({x, y});
-                } else {
-                    not_visited.insert({x, y});
+            std::size_t neighbour = (y + dir[1]) * N + (x + dir[0]);
+            if (visited[neighbour]) {
+                continue;
+            }
+            visited[neighbour] = 1;
+            queue.push_back(neighbour);
+            double new_val = value;
+            if (dir[0] != 0) {
+                if (!pseudoVolKnown) {
+                    pseudoVol = dynamics.getPseudoVol(spaceTimeCoords.second, spaceTimeCoords.first, value);
+                    pseudoVolKnown = true;
+                }
+                new_val += dir[0] * pseudoVol * stm.get_dx(dir[0] < 0 ? x - 1 : x);
+            } else {
+                if (!driftKnown) {
+                    drift = dynamics.getDrift(spaceTimeCoords.second, spaceTimeCoords.first, value);
+                    driftKnown = true;
                 }
+                new_val += dir[1] * drift * stm.get_dt(dir[1] < 0 ? y - 1 : y);
             }
+            processMesh.setMeshData(x + dir[0], y + dir[1], new_val);
         }
+    }
+    if (queue.size() != N * N_T) {
+        throw std::runtime_error("Convergence error: Boundaries aren't sufficient.");
+    }
+}
 
-        std::size_t overflow_counter = 0;
-        std::set<std::pair<int, int>> dirs = {{0, 1}, {0, -1}, {-1, 0}, {1, 0}};
-        std::size_t max_iter = (processMesh.getNumCols()+1)*(processMesh.getNumRows() +1);
-        while (!not_visited.empty()) {
-            if (overflow_counter > max_iter) {
-                throw std::runtime_error("Convergence error: Boundaries aren't sufficient.");
-                return;
-            }
-            for (auto& p : visited) {
-                for (auto& dir : dirs) {
-                    if (not_visited.find({p.first + dir.first, p.second + dir.second}) != not_visited.end()) {
-                        not_visited.erase({p.first + dir.first, p.second + dir.second});
-                        visited.insert({p.first + dir.first, p.second + dir.second});
-                        std::pair<double, double> spaceTimeCoords = processMesh.getSpaceTimeMesh().getCoords(p.first, p.second);
-                        double new_val = processMesh.getMeshData(p.first,p.second) +
-                        dir.first * dynamics.getPseudoVol(spaceTimeCoords.second,spaceTimeCoords.first, processMesh.getMeshData(p.first,p.second))*dx +
-                                                      dir.second * dynamics.getDrift(spaceTimeCoords.second,spaceTimeCoords.first, processMesh.getMeshData(p.first,p.second)) *dt;
-                        processMesh.setMeshData(p.first + dir.first,p.second + dir.second, new_val);
-                    }
-                }
+template <typename T>
+void BasicItoProcess<T>::solve(const BoundaryConditions& bc, const ItoDynamics& dynamics) {
+    PRICER_PHASE(PricingPhase::ProcessSolve);
+    const SpaceTimeMesh& stm = processMesh.getSpaceTimeMesh();
+    std::size_t N = processMesh.getNumRows();
+    std::size_t N_T = processMesh.getNumCols();
+    PRICER_COUNT_NODES(N * N_T, N * N_T * sizeof(T));
+    ProcessLayout layout = detectLayout(bc, N, N_T);
+
+    if (layout == ProcessLayout::General) {
+        if constexpr (std::is_same_v<T, double>) {
+            processMesh.applyBoundaryConditions(bc);
+            propagate(bc, dynamics);
+        } else {
+            ItoProcess wide(stm);
+            wide.solve(bc, dynamics);
+            for (std::size_t y = 0; y < N_T; y++) {
+                const double* from = wide.getProcessMesh().getTimeSlice(y).data();
+                std::copy(from, from + N, processMesh.getTimeSlice(y).data());
             }
-            overflow_counter++;
+        }
+        return;
+    }
+    // slice y worked on in double: in place for double storage, in one of two buffers rounded into the mesh otherwise
+    std::vector<double> buffers(std::is_same_v<T, double> ? 0 : 2 * N);
+    auto working = [&](std::size_t y) -> double* {
+        if constexpr (std::is_same_v<T, double>) {
+            return processMesh.getTimeSlice(y).data();
+        } else {
+            return buffers.data() + (y % 2) * N;
+        }
+    };
+    auto store = [&](std::size_t y) {
+        if constexpr (!std::is_same_v<T, double>) {
+            const double* slice = working(y);
+            std::copy(slice, slice + N, processMesh.getTimeSlice(y).data());
+        }
+    };
+
+    if (layout == ProcessLayout::GivenAtStart){
+        bc.applySlice(stm, 0, working(0));
+        store(0);
+        for (std::size_t y = 1; y < N_T; y++){
+            stepInTime(stm, dynamics, working(y-1), working(y), y, stm.get_dt(y-1));
+            store(y);
+        }
+    }else if (layout == ProcessLayout::GivenAtEnd){
+        bc.applySlice(stm, N_T-1, working(N_T-1));
+        store(N_T-1);
+        for (std::size_t y = N_T-1; y-- > 0;){
+            stepInTime(stm, dynamics, working(y+1), working(y), y, -stm.get_dt(y));
+            store(y);
+        }
+    }else{
+        for (std::size_t y = 0; y < N_T; y++){
+            bc.applySlice(stm, y, working(y));
+            sweepInX(stm, dynamics, working(y), y, layout == ProcessLayout::GivenAtLowerX);
+            store(y);
         }
     }
-    
 }
-double ItoProcess::getVal(std::size_t i, std::size_t j){
+template <typename T>
+T BasicItoProcess<T>::getVal(std::size_t i, std::size_t j){
     return processMesh.getMeshData(i, j);
 }
-void ItoProcess::logMesh() const{
+template <typename T>
+void BasicItoProcess<T>::logMesh() const{
     processMesh.logMesh();
 }
-const FunctionMesh& ItoProcess::getProcessMesh() const{
+template <typename T>
+const BasicFunctionMesh<T>& BasicItoProcess<T>::getProcessMesh() const{
     return processMesh;
 }
 
+template class BasicItoProcess<float>;
+template class BasicItoProcess<double>;
+template class BasicItoProcess<long double>;
+
+RollingItoProcess::RollingItoProcess(const SpaceTimeMesh& stm, const BoundaryConditions& bc, const ItoDynamics& dynamics, PricingArena* arena)
+    : stm(stm), bc(bc), dynamics(dynamics), layout(ItoProcess::detectLayout(bc, stm.get_N(), stm.get_N_T())),
+      N(stm.get_N()), stride(1), checkpoints(AlignedAllocator<double>(arena)), block(AlignedAllocator<double>(arena)), blockStart(0),
+      lastSlice(stm.get_N_T()) {
+    PRICER_PHASE(PricingPhase::ProcessSolve);
+    std::size_t N_T = stm.get_N_T();
+    if (layout == ProcessLayout::GivenAtStart) {
+        // forward march once, keeping every stride-th slice, blocks are recomputed from them on the way back
+        stride = static_cast<std::size_t>(std::ceil(std::sqrt(static_cast<double>(N_T))));
+        checkpoints.assign(((N_T - 1) / stride + 1) * N, 0);
+        block.assign(stride * N, 0);
+        AlignedVector<double> march(2 * N, 0, AlignedAllocator<double>(arena));
+        double* previous = march.data();
+        double* current = march.data() + N;
+        PRICER_COUNT_NODES((N_T - 1) * N, (N_T - 1) * N * sizeof(double));
+        bc.applySlice(stm, 0, previous);
+        std::copy(previous, previous + N, checkpoints.begin());
+        for (std::size_t y = 1; y < N_T; y++) {
+            ItoProcess::stepInTime(stm, dynamics, previous, current, y, stm.get_dt(y - 1));
+            if (y % stride == 0) {
+                std::copy(current, current + N, checkpoints.begin() + (y / stride) * N);
+            }
+            std::swap(previous, current);
+        }
+        blockStart = N_T; // no block computed yet
+    } else if (layout == ProcessLayout::General) {
+        fullProcess.emplace(stm, arena);
+        fullProcess->solve(bc, dynamics);
+    } else {
+        block.assign(2 * N, 0);
+    }
+}
+
+const double* RollingItoProcess::getSlice(std::size_t n) {
+    assert(n < stm.get_N_T());
+    assert(n <= lastSlice || lastSlice == stm.get_N_T());
+    PRICER_PHASE(PricingPhase::ProcessSolve);
+    switch (layout) {
+    case ProcessLayout::GivenAtStart: {
+        if (n < blockStart || n >= blockStart + stride) {
+            blockStart = (n / stride) * stride;
+            std::copy(checkpoints.begin() + (blockStart / stride) * N, checkpoints.begin() + (blockStart / stride + 1) * N, block.begin());
+            for (std::size_t k = 1; k < stride && blockStart + k < stm.get_N_T(); k++) {
+                ItoProcess::stepInTime(stm, dynamics, block.data() + (k - 1) * N, block.data() + k * N, blockStart + k, stm.get_dt(blockStart + k - 1));
+                PRICER_COUNT_NODES(N, N * sizeof(double));
+            }
+        }
+        lastSlice = n;
+        return block.data() + (n - blockStart) * N;
+    }
+    case ProcessLayout::GivenAtEnd: {
+        // block holds the last handed out slice in its first half
+        if (lastSlice == stm.get_N_T()) {
+            lastSlice = stm.get_N_T() - 1;
+            bc.applySlice(stm, lastSlice, block.data());
+        }
+        while (lastSlice > n) {
+            ItoProcess::stepInTime(stm, dynamics, block.data(), block.data() + N, lastSlice - 1, -stm.get_dt(lastSlice - 1));
+            std::copy(block.begin() + N, block.end(), block.begin());
+            PRICER_COUNT_NODES(N, N * sizeof(double));
+            lastSlice--;
+        }
+        return block.data();
+    }
+    case ProcessLayout::GivenAtLowerX:
+    case ProcessLayout::GivenAtUpperX: {
+        if (lastSlice != n) {
+            bc.applySlice(stm, n, block.data());
+            ItoProcess::sweepInX(stm, dynamics, block.data(), n, layout == ProcessLayout::GivenAtLowerX);
+            PRICER_COUNT_NODES(N, N * sizeof(double));
+            lastSlice = n;
+        }
+        return block.data();
+    }
+    default:
+        lastSlice = n;
+        return fullProcess->getProcessMesh().getTimeSlice(n).data();
+    }
+}
+
+std::size_t RollingItoProcess::memoryFootprint() const {
+    std::size_t bytes = (checkpoints.size() + block.size()) * sizeof(double);
+    if (fullProcess) {
+        bytes += fullProcess->getProcessMesh().getNumRows() * fullProcess->getProcessMesh().getNumCols() * sizeof(double);
+    }
+    return bytes;
+}
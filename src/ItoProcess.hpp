@@ -1,15 +1,112 @@
 #pragma once
 
 #include "MeshUtils.hpp"
-#include <set>
+#include "ValueIdentity.hpp"
 #include <stdexcept>
 #include <functional>
 #include <utility>
+#include <optional>
+#include <vector>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+// slice loops of a process instantiated on a concrete dynamics type:
+// one virtual call per slice instead of one std::function call per node
+class DynamicsKernel {
+public:
+    virtual ~DynamicsKernel() = default;
+    virtual void stepInTime(const SpaceTimeMesh& stm, const double* from, double* to, std::size_t n, double signedDt) const = 0;
+    virtual void sweepInX(const SpaceTimeMesh& stm, double* slice, std::size_t n, bool upward) const = 0;
+    virtual void evaluate(double t, const double* x, const double* p, double* drift, double* pseudoVol, std::size_t count) const = 0;
+    // see ValueIdentity
+    virtual bool appendIdentity(std::string& key) const = 0;
+};
+
+template <typename Dynamics>
+class TypedDynamicsKernel : public DynamicsKernel {
+private:
+    Dynamics dynamics;
+
+public:
+    explicit TypedDynamicsKernel(const Dynamics& dynamics) : dynamics(dynamics) {}
+    const Dynamics& get() const { return dynamics; }
+
+    void stepInTime(const SpaceTimeMesh& stm, const double* from, double* to, std::size_t n, double signedDt) const override {
+        for (std::size_t x = 0; x < stm.get_N(); x++) {
+            std::pair<double, double> coords = stm.getCoords(x, n);
+            to[x] = from[x] + signedDt*dynamics.getDrift(coords.second, coords.first, from[x]);
+        }
+    }
+
+    void sweepInX(const SpaceTimeMesh& stm, double* slice, std::size_t n, bool upward) const override {
+        if (upward) {
+            for (std::size_t x = 1; x < stm.get_N(); x++) {
+                std::pair<double, double> coords = stm.getCoords(x, n);
+                slice[x] = slice[x-1] + stm.get_dx(x-1)*dynamics.getPseudoVol(coords.second, coords.first, slice[x-1]);
+            }
+        } else {
+            for (std::size_t x = stm.get_N() - 1; x-- > 0;) {
+                std::pair<double, double> coords = stm.getCoords(x, n);
+                slice[x] = slice[x+1] - stm.get_dx(x)*dynamics.getPseudoVol(coords.second, coords.first, slice[x+1]);
+            }
+        }
+    }
+
+    void evaluate(double t, const double* x, const double* p, double* drift, double* pseudoVol, std::size_t count) const override {
+        for (std::size_t k = 0; k < count; k++) {
+            drift[k] = dynamics.getDrift(t, x[k], p[k]);
+            pseudoVol[k] = dynamics.getPseudoVol(t, x[k], p[k]);
+        }
+    }
+
+    bool appendIdentity(std::string& key) const override {
+        return append_value_identity(dynamics, key);
+    }
+};
+
+// dp = drift dt + pseudoVol dx with constant coefficients (0, 0 for a constant vol/rate)
+struct ConstantDynamics {
+    double drift;
+    double pseudoVol;
+
+    ConstantDynamics(double drift = 0, double pseudoVol = 0) : drift(drift), pseudoVol(pseudoVol) {}
+    double getDrift(double, double, double) const { return drift; }
+    double getPseudoVol(double, double, double) const { return pseudoVol; }
+};
+
+template <>
+struct ValueIdentity<ConstantDynamics> {
+    static bool append(const ConstantDynamics& dynamics, std::string& key) {
+        key.append("ConstantDynamics");
+        key.push_back(0);
+        append_identity_value(key, dynamics.drift);
+        append_identity_value(key, dynamics.pseudoVol);
+        return true;
+    }
+};
+
+// deterministic process depending on t only: dp = f(t) dt (hence no dependency on x)
+template <typename F>
+struct TimeDependentDynamics {
+    F drift;
+
+    explicit TimeDependentDynamics(F drift) : drift(drift) {}
+    double getDrift(double t, double, double) const { return drift(t); }
+    double getPseudoVol(double, double, double) const { return 0; }
+};
+
+template <typename D, typename = void>
+struct is_dynamics : std::false_type {};
+template <typename D>
+struct is_dynamics<D, std::void_t<decltype(std::declval<const D&>().getDrift(0., 0., 0.)),
+                                  decltype(std::declval<const D&>().getPseudoVol(0., 0., 0.))>> : std::true_type {};
 
 class ItoDynamics {
 private:
     const std::function<double(double, double, double)> partial_t;
     const std::function<double(double, double, double)> partial_x;
+    std::shared_ptr<const DynamicsKernel> kernel; // only when built from a concrete dynamics type
 
 public:
     static std::pair<std::function<double(double, double, double)>, std::function<double(double, double, double)>>
@@ -18,22 +115,73 @@ public:
 
     ItoDynamics(const std::function<double(double, double, double)>& partial_t,
                 const std::function<double(double, double, double)>& partial_x);
+    // compile-time dynamics (ConstantDynamics, TimeDependentDynamics, ...): the process loops get inlined,
+    // getDrift/getPseudoVol stay available through the type-erased path
+    template <typename Dynamics, std::enable_if_t<is_dynamics<Dynamics>::value && !std::is_same_v<Dynamics, ItoDynamics>, int> = 0>
+    ItoDynamics(const Dynamics& dynamics)
+        : ItoDynamics(std::make_shared<const TypedDynamicsKernel<Dynamics>>(dynamics)) {}
 
     double getDrift(double t, double x, double p) const;
     double getPseudoVol(double t, double x, double p) const;
-    
+    // drift and pseudo vol of count (x[k], p[k]) pairs at time t (simulated paths), one virtual call for typed dynamics
+    void evaluate(double t, const double* x, const double* p, double* drift, double* pseudoVol, std::size_t count) const;
+    const DynamicsKernel* getKernel() const; // nullptr for the std::function path
+
+private:
+    template <typename Dynamics>
+    ItoDynamics(const std::shared_ptr<const TypedDynamicsKernel<Dynamics>>& typed)
+        : partial_t([typed](double t, double x, double p) { return typed->get().getDrift(t, x, p); }),
+          partial_x([typed](double t, double x, double p) { return typed->get().getPseudoVol(t, x, p); }),
+          kernel(typed) {}
 
 };
 
-class ItoProcess {
+// which part of the mesh the boundary conditions fully determine (decides how the process is propagated)
+enum class ProcessLayout { GivenAtStart, GivenAtEnd, GivenAtLowerX, GivenAtUpperX, General };
+
+// process mesh stored as T (float, double or long double), always computed in double: a slice is stepped in double
+// then rounded, so that float storage doesn't compound its rounding along the mesh
+template <typename T>
+class BasicItoProcess {
 private:
-    FunctionMesh processMesh;
+    BasicFunctionMesh<T> processMesh;
+    // General layout: flood fill from the frontier, O(N*N_T)
+    void propagate(const BoundaryConditions& bc, const ItoDynamics& dynamics);
 public:
-    ItoProcess(const SpaceTimeMesh& stm);
+    BasicItoProcess(const SpaceTimeMesh& stm, PricingArena* arena = nullptr); // mesh taken from the arena when given
     void solve(const BoundaryConditions& bc, const ItoDynamics& dynamics);
-    double getVal(std::size_t i, std::size_t j);
+    static ProcessLayout detectLayout(const BoundaryConditions& bc, std::size_t N, std::size_t N_T);
+    // to = from + signedDt*drift, coordinates taken at slice n (the one being written)
+    static void stepInTime(const SpaceTimeMesh& stm, const ItoDynamics& dynamics, const double* from, double* to, std::size_t n, double signedDt);
+    // propagates slice n along x from its lower (upward) or upper edge
+    static void sweepInX(const SpaceTimeMesh& stm, const ItoDynamics& dynamics, double* slice, std::size_t n, bool upward);
+    T getVal(std::size_t i, std::size_t j);
     void logMesh() const;
-    const FunctionMesh& getProcessMesh() const;
+    const BasicFunctionMesh<T>& getProcessMesh() const;
 
 };
 
+using ItoProcess = BasicItoProcess<double>;
+
+// process slices handed out from t = T down to t = 0 (order of the pricing sweep) without keeping the whole mesh:
+// O(N) when given at t = T or along an x edge, O(N sqrt(N_T)) checkpoints when given at t = 0, full mesh otherwise
+class RollingItoProcess {
+private:
+    const SpaceTimeMesh& stm;
+    const BoundaryConditions& bc;
+    const ItoDynamics& dynamics;
+    ProcessLayout layout;
+    std::size_t N;
+    std::size_t stride; // checkpoint spacing
+    AlignedVector<double> checkpoints; // slices 0, stride, 2*stride, ...
+    AlignedVector<double> block; // slices of the checkpoint block being read (or the current slice)
+    std::size_t blockStart;
+    std::size_t lastSlice;
+    std::optional<ItoProcess> fullProcess;
+
+public:
+    // arena: buffers (and the full process of the General layout) taken from it instead of the heap
+    RollingItoProcess(const SpaceTimeMesh& stm, const BoundaryConditions& bc, const ItoDynamics& dynamics, PricingArena* arena = nullptr);
+    const double* getSlice(std::size_t n); // n can only decrease (or stay) between calls
+    std::size_t memoryFootprint() const; // bytes
+};
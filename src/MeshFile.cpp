@@ -0,0 +1,172 @@
+#include "MeshFile.hpp"
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+// doubles of an array padded to a multiple of 64 bytes
+std::size_t padded(std::size_t count) {
+    return (count + 7) / 8 * 8;
+}
+
+void write_padding(std::ofstream& out, std::size_t count) {
+    const double zeros[8] = {};
+    out.write(reinterpret_cast<const char*>(zeros), (padded(count) - count) * sizeof(double));
+}
+
+void write_array(std::ofstream& out, const double* values, std::size_t count) {
+    out.write(reinterpret_cast<const char*>(values), count * sizeof(double));
+    write_padding(out, count);
+}
+
+void write_meshes(const std::string& path, MeshFileKind kind, const std::vector<const FunctionMesh*>& meshes) {
+    const SpaceTimeMesh& stm = meshes[0]->getSpaceTimeMesh();
+    std::size_t N = stm.get_N();
+    std::size_t N_T = stm.get_N_T();
+    MeshFileHeader header = {};
+    std::memcpy(header.magic, MeshFileHeader::expectedMagic, sizeof(header.magic));
+    header.version = MeshFileHeader::currentVersion;
+    header.kind = kind;
+    header.N = N;
+    header.N_T = N_T;
+    header.meshes = meshes.size();
+    header.uniformX = stm.isUniformX();
+    header.uniformT = stm.isUniformT();
+    header.x0 = stm.getXNodes()[N / 2];
+    header.R = stm.get_R();
+    header.T = stm.get_T();
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("mesh file: cannot open " + path + " for writing.");
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    std::vector<double> tNodes(N_T);
+    for (std::size_t n = 0; n < N_T; n++) {
+        tNodes[n] = stm.getCoords(0, n).second;
+    }
+    write_array(out, stm.getXNodes(), N);
+    write_array(out, tNodes.data(), N_T);
+    for (const FunctionMesh* mesh : meshes) {
+        assert(mesh->getNumRows() == N && mesh->getNumCols() == N_T);
+        for (std::size_t n = 0; n < N_T; n++) {
+            out.write(reinterpret_cast<const char*>(mesh->getTimeSlice(n).data()), N * sizeof(double));
+        }
+        write_padding(out, N * N_T);
+    }
+    out.flush();
+    if (!out) {
+        throw std::runtime_error("mesh file: writing " + path + " failed.");
+    }
+}
+}
+
+void write_mesh_file(const std::string& path, const FunctionMesh& mesh) {
+    write_meshes(path, MeshFileKind::Function, {&mesh});
+}
+
+void write_mesh_file(const std::string& path, const ItoProcess& process) {
+    write_meshes(path, MeshFileKind::Process, {&process.getProcessMesh()});
+}
+
+void write_mesh_file(const std::string& path, const DiscretePricer& pricer) {
+    write_meshes(path, MeshFileKind::Pricing,
+                 {&pricer.getPriceMesh(), &pricer.getVolApprox().getProcessMesh(), &pricer.getRateApprox().getProcessMesh()});
+}
+
+MappedMeshFile::MappedMeshFile(const std::string& path) : mapping(nullptr), length(0), header(nullptr) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("mesh file: cannot open " + path + ".");
+    }
+    struct stat status;
+    if (::fstat(fd, &status) != 0 || static_cast<std::size_t>(status.st_size) < sizeof(MeshFileHeader)) {
+        ::close(fd);
+        throw std::runtime_error("mesh file: " + path + " is too short.");
+    }
+    length = static_cast<std::size_t>(status.st_size);
+    void* address = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd); // the mapping keeps the file
+    if (address == MAP_FAILED) {
+        throw std::runtime_error("mesh file: cannot map " + path + ".");
+    }
+    mapping = static_cast<const unsigned char*>(address);
+    header = reinterpret_cast<const MeshFileHeader*>(mapping);
+
+    std::string problem;
+    if (std::memcmp(header->magic, MeshFileHeader::expectedMagic, sizeof(header->magic)) != 0) {
+        problem = " isn't a mesh file.";
+    } else if (header->version != MeshFileHeader::currentVersion) {
+        problem = " has version " + std::to_string(header->version) + ", " + std::to_string(MeshFileHeader::currentVersion) + " expected.";
+    } else if (header->N < 3 || header->N_T < 2 || header->meshes == 0 ||
+               length != sizeof(MeshFileHeader) + (padded(header->N) + padded(header->N_T) + header->meshes * padded(header->N * header->N_T)) * sizeof(double)) {
+        problem = " has an inconsistent size.";
+    }
+    if (!problem.empty()) {
+        ::munmap(const_cast<unsigned char*>(mapping), length);
+        throw std::runtime_error("mesh file: " + path + problem);
+    }
+}
+
+MappedMeshFile::MappedMeshFile(MappedMeshFile&& other) noexcept : mapping(other.mapping), length(other.length), header(other.header) {
+    other.mapping = nullptr;
+    other.header = nullptr;
+}
+
+MappedMeshFile& MappedMeshFile::operator=(MappedMeshFile&& other) noexcept {
+    if (this != &other) {
+        if (mapping) {
+            ::munmap(const_cast<unsigned char*>(mapping), length);
+        }
+        mapping = other.mapping;
+        length = other.length;
+        header = other.header;
+        other.mapping = nullptr;
+        other.header = nullptr;
+    }
+    return *this;
+}
+
+MappedMeshFile::~MappedMeshFile() {
+    if (mapping) {
+        ::munmap(const_cast<unsigned char*>(mapping), length);
+    }
+}
+
+const double* MappedMeshFile::array(std::size_t offset) const {
+    return reinterpret_cast<const double*>(mapping + sizeof(MeshFileHeader)) + offset;
+}
+
+MeshFileKind MappedMeshFile::getKind() const {
+    return header->kind;
+}
+
+std::size_t MappedMeshFile::get_N() const {
+    return header->N;
+}
+
+std::size_t MappedMeshFile::get_N_T() const {
+    return header->N_T;
+}
+
+std::size_t MappedMeshFile::getMeshCount() const {
+    return header->meshes;
+}
+
+SpaceTimeMesh MappedMeshFile::getSpaceTimeMesh() const {
+    const double* x = array(0);
+    const double* t = array(padded(header->N));
+    return SpaceTimeMesh(header->x0, header->R, header->T, std::vector<double>(x, x + header->N), std::vector<double>(t, t + header->N_T),
+                         header->uniformX != 0, header->uniformT != 0);
+}
+
+MeshView MappedMeshFile::getMesh(std::size_t k) const {
+    if (k >= header->meshes) {
+        throw std::out_of_range("mesh file: no mesh " + std::to_string(k) + ".");
+    }
+    return MeshView(array(padded(header->N) + padded(header->N_T) + k * padded(header->N * header->N_T)), header->N, header->N_T);
+}
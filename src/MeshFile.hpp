@@ -0,0 +1,87 @@
+#pragma once
+#include "Pricers.hpp"
+#include <cstdint>
+#include <string>
+
+// binary mesh file, version 1 (host byte order, a file written on a little endian machine only reads on one):
+//   header (128 bytes, MeshFileHeader)
+//   x nodes (N doubles) then t nodes (N_T doubles), each padded with zeros to a multiple of 8 doubles
+//   meshes: N*N_T doubles each, time-slice-major like FunctionMesh (value at (x_i, t_n) at n*N + i), padded the same way
+// every array starts at a multiple of 64 bytes, so that a mapped file is read in place with the alignment of the meshes
+enum class MeshFileKind : std::uint32_t {
+    Function = 1, // one FunctionMesh
+    Process = 2, // one ItoProcess mesh
+    Pricing = 3, // FullGrid DiscretePricer: prices, vol process, rate process
+};
+
+struct MeshFileHeader {
+    static constexpr char expectedMagic[8] = {'P', 'D', 'E', 'M', 'E', 'S', 'H', 0};
+    static constexpr std::uint32_t currentVersion = 1;
+
+    char magic[8];
+    std::uint32_t version;
+    MeshFileKind kind;
+    std::uint64_t N;
+    std::uint64_t N_T;
+    std::uint64_t meshes;
+    std::uint32_t uniformX;
+    std::uint32_t uniformT;
+    double x0;
+    double R;
+    double T;
+    char reserved[56];
+};
+static_assert(sizeof(MeshFileHeader) == 128, "the mesh file header is 128 bytes");
+
+// streamed slice by slice, nothing copied; std::runtime_error when the file can't be written
+void write_mesh_file(const std::string& path, const FunctionMesh& mesh);
+void write_mesh_file(const std::string& path, const ItoProcess& process);
+void write_mesh_file(const std::string& path, const DiscretePricer& pricer); // FullGrid pricer after price()
+
+// mesh of a mapped file, valid as long as the file stays mapped
+class MeshView {
+private:
+    const double* first;
+    std::size_t N;
+    std::size_t N_T;
+
+public:
+    MeshView(const double* first, std::size_t N, std::size_t N_T) : first(first), N(N), N_T(N_T) {}
+    double getMeshData(std::size_t i, std::size_t n) const {
+        assert(i < N && n < N_T);
+        return first[n * N + i];
+    }
+    StridedView<const double> getTimeSlice(std::size_t n) const { return StridedView<const double>(first + n * N, N); }
+    StridedView<const double> getRow(std::size_t i) const { return StridedView<const double>(first + i, N_T, N); }
+    const double* data() const { return first; }
+    std::size_t getNumRows() const { return N; }
+    std::size_t getNumCols() const { return N_T; }
+};
+
+// read only, shared mapping of a mesh file: the meshes are read in place (zero copy) and several processes mapping the
+// same file share its pages. Checks the magic, version and size, std::runtime_error otherwise.
+class MappedMeshFile {
+private:
+    const unsigned char* mapping;
+    std::size_t length;
+    const MeshFileHeader* header;
+
+    const double* array(std::size_t offset) const;
+
+public:
+    explicit MappedMeshFile(const std::string& path);
+    MappedMeshFile(const MappedMeshFile&) = delete;
+    MappedMeshFile& operator=(const MappedMeshFile&) = delete;
+    MappedMeshFile(MappedMeshFile&& other) noexcept;
+    MappedMeshFile& operator=(MappedMeshFile&& other) noexcept;
+    ~MappedMeshFile();
+
+    MeshFileKind getKind() const;
+    std::size_t get_N() const;
+    std::size_t get_N_T() const;
+    std::size_t getMeshCount() const;
+    // the mesh the meshes were solved on (nodes copied, bitwise equal)
+    SpaceTimeMesh getSpaceTimeMesh() const;
+    // k in [0, getMeshCount()), for Pricing files 0: prices, 1: vol, 2: rate
+    MeshView getMesh(std::size_t k = 0) const;
+};
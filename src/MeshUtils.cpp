@@ -1,21 +1,25 @@
 #include "MeshUtils.hpp"
 
 #include <iomanip>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <type_traits>
 
 template <typename T>
-void logMatrix(const std::vector<std::vector<T>>& mat) {
-    for (std::size_t i = 0; i < mat[0].size(); i++) {
+void logMatrix(const T* data, std::size_t X, std::size_t Y) {
+    for (std::size_t y = 0; y < Y; y++) {
         std::cout << "--";
     }
     std::cout << "-> (axe des t)" << std::endl;
 
-    for (const auto& row : mat) {
+    for (std::size_t x = 0; x < X; x++) {
         std::cout << "| ";
-        for (const auto& e : row) {
-            if constexpr (std::is_same_v<T, double>) {
-                std::cout << std::fixed << std::setprecision(3) << e << " ";
+        for (std::size_t y = 0; y < Y; y++) {
+            if constexpr (std::is_floating_point_v<T>) {
+                std::cout << std::fixed << std::setprecision(3) << data[y * X + x] << " ";
             } else {
-                std::cout << e << " ";
+                std::cout << static_cast<int>(data[y * X + x]) << " "; // the frontier, not printed as characters
             }
         }
         std::cout << '\n';
@@ -25,34 +29,201 @@ void logMatrix(const std::vector<std::vector<T>>& mat) {
 }
 
 BoundaryConditions::BoundaryConditions(const std::vector<std::vector<bool>>& contour, const std::function<double(double, double)>& function)
-    : frontier(contour), frontier_function(function) {}
+    : X(contour.size()), Y(contour.empty() ? 0 : contour[0].size()), frontier(Y),
+      frontier_function(std::make_shared<const std::function<double(double, double)>>(function)) {
+    for (std::size_t y = 0; y < Y; y++) {
+        for (std::size_t x = 0; x < X; x++) {
+            if (!contour[x][y]) {
+                continue;
+            }
+            if (!frontier[y].empty() && frontier[y].back().end == x) {
+                frontier[y].back().end++;
+            } else {
+                frontier[y].push_back({x, x + 1});
+            }
+        }
+    }
+}
 
 BoundaryConditions::BoundaryConditions(std::size_t X, std::size_t Y, const std::function<double(double, double)>& function)
-    : frontier(X, std::vector<bool>(Y, false)), frontier_function(function) {}
+    : X(X), Y(Y), frontier(Y), frontier_function(std::make_shared<const std::function<double(double, double)>>(function)) {}
 BoundaryConditions::BoundaryConditions(const BoundaryConditions& other, const std::function<double(double, double)>& new_function)
-        : frontier(other.frontier), frontier_function(new_function) {
+        : X(other.X), Y(other.Y), frontier(other.frontier),
+          frontier_function(std::make_shared<const std::function<double(double, double)>>(new_function)) {
     }
 double BoundaryConditions::apply(double x, double y) const {
-    return frontier_function(x, y);
+    return (*frontier_function)(x, y);
 }
 
 bool BoundaryConditions::check(std::size_t x, std::size_t y) const {
-    return frontier[x][y];
+    if (x >= X || y >= Y) {
+        return false;
+    }
+    const std::vector<FrontierRun>& runs = frontier[y];
+    // first run ending after x
+    auto run = std::upper_bound(runs.begin(), runs.end(), x, [](std::size_t value, const FrontierRun& r) { return value < r.end; });
+    return run != runs.end() && run->begin <= x;
+}
+bool BoundaryConditions::sameFrontier(const BoundaryConditions& other) const {
+    return X == other.X && Y == other.Y && frontier == other.frontier;
+}
+void BoundaryConditions::collectSlice(std::size_t y, std::size_t N, std::vector<std::size_t>& rows) const {
+    rows.clear();
+    if (y >= Y) {
+        return;
+    }
+    for (const FrontierRun& run : frontier[y]) {
+        for (std::size_t x = run.begin; x < std::min(run.end, N); x++) {
+            rows.push_back(x);
+        }
+    }
 }
 void BoundaryConditions::uncheck(std::size_t x, std::size_t y) {
-    frontier[x][y] = false;
+    std::vector<FrontierRun>& runs = frontier[y];
+    auto run = std::upper_bound(runs.begin(), runs.end(), x, [](std::size_t value, const FrontierRun& r) { return value < r.end; });
+    if (run == runs.end() || run->begin > x) {
+        return;
+    }
+    FrontierRun right{x + 1, run->end};
+    run->end = x;
+    if (run->begin == run->end) {
+        run = runs.erase(run);
+    } else {
+        ++run;
+    }
+    if (right.begin < right.end) {
+        runs.insert(run, right);
+    }
+}
+void BoundaryConditions::checkRun(std::size_t y, std::size_t begin, std::size_t end) {
+    assert(y < Y && end <= X);
+    if (begin >= end) {
+        return;
+    }
+    // merge with every run it overlaps or touches
+    std::vector<FrontierRun>& runs = frontier[y];
+    auto first = std::lower_bound(runs.begin(), runs.end(), begin, [](const FrontierRun& r, std::size_t value) { return r.end < value; });
+    auto last = first;
+    while (last != runs.end() && last->begin <= end) {
+        begin = std::min(begin, last->begin);
+        end = std::max(end, last->end);
+        ++last;
+    }
+    first = runs.erase(first, last);
+    runs.insert(first, {begin, end});
+}
+const std::vector<FrontierRun>& BoundaryConditions::getRuns(std::size_t y) const {
+    assert(y < Y);
+    return frontier[y];
+}
+std::size_t BoundaryConditions::size() const {
+    std::size_t cells = 0;
+    for (const std::vector<FrontierRun>& runs : frontier) {
+        for (const FrontierRun& run : runs) {
+            cells += run.end - run.begin;
+        }
+    }
+    return cells;
 }
 void BoundaryConditions::ToggleDir(bool dir, bool pos) {
     
-    if (dir && pos) {for (std::size_t x = 0; x < frontier.size(); x++) {frontier[x][frontier[0].size() - 1] = true;}}
-    else if (dir && !pos) {for (std::size_t x = 0; x < frontier.size(); x++) {frontier[x][0] = true;}}
-    else if (!dir && pos) {for (std::size_t y = 0; y < frontier[0].size(); y++) {frontier[frontier.size() - 1][y] = true;}}
-    else {for (std::size_t y = 0; y < frontier[0].size(); y++) {frontier[0][y] = true;}}
+    if (dir && pos) {checkRun(Y - 1, 0, X);}
+    else if (dir && !pos) {checkRun(0, 0, X);}
+    else if (!dir && pos) {for (std::size_t y = 0; y < Y; y++) {checkRun(y, X - 1, X);}}
+    else {for (std::size_t y = 0; y < Y; y++) {checkRun(y, 0, 1);}}
 }
 
-SpaceTimeMesh::SpaceTimeMesh(double x0, double R, double T, int N, int N_T): x0(x0), R(R), T(T), N(N), N_T(N_T) {
+SpaceTimeMesh::SpaceTimeMesh(double x0, double R, double T, int N, int N_T)
+    : x0(x0), R(R), T(T), N(N), N_T(N_T), xNodes(N), tNodes(N_T), uniformX(true), uniformT(true) {
     assert( ((N & 1) == 1) && (N >= 2));
     assert(N_T >= 2);
+    for (std::size_t i = 0; i < this->N; i++) {
+        xNodes[i] = x0 - R + 2*R * (static_cast<int>(i)) / static_cast<double>(N - 1); // good
+    }
+    for (std::size_t n = 0; n < this->N_T; n++) {
+        tNodes[n] = (static_cast<double>(n) / (N_T - 1)) * T; // good
+    }
+}
+
+SpaceTimeMesh::SpaceTimeMesh(double x0, double R, double T, std::vector<double> xNodes, std::vector<double> tNodes, bool uniformX, bool uniformT)
+    : x0(x0), R(R), T(T), N(xNodes.size()), N_T(tNodes.size()), xNodes(std::move(xNodes)), tNodes(std::move(tNodes)), uniformX(uniformX),
+      uniformT(uniformT) {
+    assert(((N & 1) == 1) && (N >= 2));
+    assert(N_T >= 2);
+}
+
+SpaceTimeMesh::SpaceTimeMesh(double x0, double R, double T, int N, int N_T, const MeshStretching& stretching)
+    : SpaceTimeMesh(x0, R, T, N, N_T) {
+    assert(stretching.concentration >= 0);
+    assert(stretching.timeGrading >= 0 && stretching.timeGrading < 1);
+    if (stretching.concentration > 0) {
+        uniformX = false;
+        std::vector<double> centers = stretching.centers.empty() ? std::vector<double>{x0} : stretching.centers;
+        double alpha = 2*R/stretching.concentration;
+        auto map = [&](double x) {
+            double value = 0;
+            for (double c : centers) value += std::asinh((x - c)/alpha);
+            return value;
+        };
+        auto density = [&](double x) {
+            double value = 0;
+            for (double c : centers) value += 1/std::sqrt(alpha*alpha + (x - c)*(x - c));
+            return value;
+        };
+        // pinned nodes: the edges, x0 (node N/2) and the centers inside the mesh, each at the index its map value
+        // rounds to (a center landing on an index already pinned is dropped), equal steps of the map in between
+        std::size_t half = this->N / 2;
+        double lowMap = map(x0 - R);
+        double midMap = map(x0);
+        double highMap = map(x0 + R);
+        std::vector<std::pair<std::size_t, double>> pinned = {{0, x0 - R}, {half, x0}, {this->N - 1, x0 + R}};
+        for (double c : centers) {
+            if (c <= x0 - R || c >= x0 + R || c == x0) {
+                continue;
+            }
+            std::size_t index = c < x0 ? static_cast<std::size_t>(std::lround(half*(map(c) - lowMap)/(midMap - lowMap)))
+                                       : half + static_cast<std::size_t>(std::lround(half*(map(c) - midMap)/(highMap - midMap)));
+            if (std::none_of(pinned.begin(), pinned.end(), [index](const std::pair<std::size_t, double>& node) { return node.first == index; })) {
+                pinned.push_back({index, c});
+            }
+        }
+        std::sort(pinned.begin(), pinned.end());
+        for (std::size_t k = 0; k + 1 < pinned.size(); k++) {
+            std::size_t first = pinned[k].first;
+            std::size_t last = pinned[k + 1].first;
+            double startMap = map(pinned[k].second);
+            double endMap = map(pinned[k + 1].second);
+            xNodes[first] = pinned[k].second;
+            xNodes[last] = pinned[k + 1].second;
+            for (std::size_t i = first + 1; i < last; i++) {
+                double target = startMap + (endMap - startMap)*(i - first)/(last - first);
+                double a = pinned[k].second;
+                double b = pinned[k + 1].second;
+                // Newton on the increasing map, bisection whenever it leaves the bracket
+                double x = a + (b - a)*(i - first)/(last - first);
+                for (int iteration = 0; iteration < 100 && b - a > 1e-15*R; iteration++) {
+                    double residual = map(x) - target;
+                    if (residual == 0) break;
+                    (residual > 0 ? b : a) = x;
+                    double newton = x - residual/density(x);
+                    if (std::abs(newton - x) <= 1e-15*R) {
+                        x = newton;
+                        break;
+                    }
+                    x = (newton > a && newton < b) ? newton : (a + b)/2;
+                }
+                xNodes[i] = x;
+            }
+        }
+    }
+    if (stretching.timeGrading > 0) {
+        uniformT = false;
+        double w = stretching.timeGrading;
+        for (std::size_t n = 1; n + 1 < this->N_T; n++) {
+            double s = static_cast<double>(n) / (N_T - 1);
+            tNodes[n] = T * s * (1 + w*(1 - s));
+        }
+    }
 }
 
 std::size_t SpaceTimeMesh::get_N() const {
@@ -75,40 +246,162 @@ double SpaceTimeMesh::get_dx() const{ // good
 double SpaceTimeMesh::get_dt() const{
     return T/(N_T-1);
 }
-std::pair<double, double> SpaceTimeMesh::getCoords(size_t i, size_t n) const {
-    assert (i<N);
-    assert(n<N_T);
-    return {
-        x0 - R + 2*R * (static_cast<int>(i)) / static_cast<double>(N - 1), // good
-        (static_cast<double>(n) / (N_T - 1)) * T // good
-    };
+bool SpaceTimeMesh::isUniformX() const {
+    return uniformX;
+}
+bool SpaceTimeMesh::isUniformT() const {
+    return uniformT;
+}
+const double* SpaceTimeMesh::getXNodes() const {
+    return xNodes.data();
 }
+template <typename T>
+BasicFunctionMesh<T>::BasicFunctionMesh(const SpaceTimeMesh& stm, PricingArena* arena)
+    : N(stm.get_N()), N_T(stm.get_N_T()), mesh_data(stm.get_N() * stm.get_N_T(), 0, AlignedAllocator<T>(arena)), spaceTimeMesh(stm) {}
 
-FunctionMesh::FunctionMesh(const SpaceTimeMesh& stm): spaceTimeMesh(stm) {
-    mesh_data = std::vector<std::vector<double>>(stm.get_N(), std::vector<double>(stm.get_N_T(), 0));
+void BoundaryConditions::applySlice(const SpaceTimeMesh& stm, std::size_t n, double* slice) const {
+    if (n >= Y) {
+        return;
+    }
+    PRICER_PHASE(PricingPhase::BoundaryApplication);
+    const std::vector<FrontierRun>* runs = &frontier[n];
+    std::vector<FrontierRun> clipped; // only when the frontier is wider than the mesh
+    if (!runs->empty() && runs->back().end > stm.get_N()) {
+        for (const FrontierRun& run : *runs) {
+            if (run.begin < stm.get_N()) {
+                clipped.push_back({run.begin, std::min(run.end, stm.get_N())});
+            }
+        }
+        runs = &clipped;
+    }
+#ifdef PRICER_INSTRUMENTATION
+    std::size_t cells = 0;
+    for (const FrontierRun& run : *runs) {
+        cells += run.end - run.begin;
+    }
+    PRICER_COUNT_NODES(cells, cells * sizeof(double));
+    PRICER_COUNT_BOUNDARY_CALLS(cells);
+#endif
+    if (kernel) {
+        kernel->applySlice(stm, n, *runs, slice);
+        return;
+    }
+    double t = stm.getCoords(0, n).second;
+    for (const FrontierRun& run : *runs) {
+        for (std::size_t x = run.begin; x < run.end; x++) {
+            slice[x] = apply(t, stm.getCoords(x, n).first); // attention f(t,x) not f(x,t) 
+        }
+    }
 }
 
-void FunctionMesh::applyBoundaryConditions(const BoundaryConditions& bc){
-    for (int x = 0; x < mesh_data.size(); x++) {
-        for (int y = 0; y < mesh_data[0].size(); y++) {
-            if (bc.check(x, y)) {
-                std::pair<double, double> coords = spaceTimeMesh.getCoords(x, y);
-                mesh_data[x][y] = bc.apply(coords.second, coords.first); // attention f(t,x) not f(x,t) 
+template <typename T>
+void BasicFunctionMesh<T>::applyBoundaryConditions(const BoundaryConditions& bc){
+    PRICER_PHASE(PricingPhase::BoundaryApplication);
+    if constexpr (std::is_same_v<T, double>) {
+        for (std::size_t y = 0; y < N_T; y++) {
+            bc.applySlice(spaceTimeMesh, y, mesh_data.data() + y * N);
+        }
+    } else {
+        std::vector<double> slice(N);
+        std::vector<std::size_t> rows;
+        for (std::size_t y = 0; y < N_T; y++) {
+            bc.applySlice(spaceTimeMesh, y, slice.data());
+            bc.collectSlice(y, N, rows);
+            for (std::size_t x : rows) {
+                mesh_data[y * N + x] = static_cast<T>(slice[x]);
             }
         }
     }
 }
-void FunctionMesh::logMesh() const{
-    logMatrix(mesh_data);
+template <typename T>
+void BasicFunctionMesh<T>::logMesh() const{
+    logMatrix(mesh_data.data(), N, N_T);
 }
 
 void BoundaryConditions::logMesh() const{
-    logMatrix(frontier);
+    std::vector<unsigned char> dense(X * Y, 0);
+    for (std::size_t y = 0; y < Y; y++) {
+        for (const FrontierRun& run : frontier[y]) {
+            std::fill(dense.begin() + y * X + run.begin, dense.begin() + y * X + run.end, 1);
+        }
+    }
+    logMatrix(dense.data(), X, Y);
+}
+template <typename T>
+void BasicFunctionMesh<T>::setMeshData(std::size_t i, std::size_t j, T val){
+    mesh_data[j * N + i] = val;
+}
+template <typename T>
+T BasicFunctionMesh<T>::getMeshData(std::size_t i, std::size_t j) const{ return  mesh_data[j * N + i];}
+template <typename T>
+StridedView<T> BasicFunctionMesh<T>::getTimeSlice(std::size_t n){
+    assert(n < N_T);
+    return {mesh_data.data() + n * N, N, 1};
 }
-void FunctionMesh::setMeshData(std::size_t i, std::size_t j, double val){
-    mesh_data[i][j] = val;
+template <typename T>
+StridedView<const T> BasicFunctionMesh<T>::getTimeSlice(std::size_t n) const{
+    assert(n < N_T);
+    return {mesh_data.data() + n * N, N, 1};
+}
+template <typename T>
+StridedView<T> BasicFunctionMesh<T>::getRow(std::size_t i){
+    assert(i < N);
+    return {mesh_data.data() + i, N_T, static_cast<std::ptrdiff_t>(N)};
+}
+template <typename T>
+StridedView<const T> BasicFunctionMesh<T>::getRow(std::size_t i) const{
+    assert(i < N);
+    return {mesh_data.data() + i, N_T, static_cast<std::ptrdiff_t>(N)};
 }
-double FunctionMesh::getMeshData(std::size_t i, std::size_t j) const{ return  mesh_data[i][j];}
-std::size_t FunctionMesh::getNumRows() const{return mesh_data.size();}
-std::size_t FunctionMesh::getNumCols() const{return mesh_data[0].size();}
-const SpaceTimeMesh& FunctionMesh::getSpaceTimeMesh() const{ return spaceTimeMesh;}
+template <typename T>
+std::size_t BasicFunctionMesh<T>::getNumRows() const{return N;}
+template <typename T>
+std::size_t BasicFunctionMesh<T>::getNumCols() const{return N_T;}
+template <typename T>
+const SpaceTimeMesh& BasicFunctionMesh<T>::getSpaceTimeMesh() const{ return spaceTimeMesh;}
+
+SpaceVolTimeMesh::SpaceVolTimeMesh(double x0, double R, double T, int N, int N_T, double sigmaMin, double sigmaMax, int M)
+    : stm(x0, R, T, N, N_T) {
+    if (!(sigmaMin >= 0 && sigmaMax > sigmaMin) || M < 3) {
+        throw std::invalid_argument("vol axis needs 0 <= sigmaMin < sigmaMax and at least 3 nodes.");
+    }
+    sigmaNodes.resize(M);
+    for (int j = 0; j < M; j++) {
+        sigmaNodes[j] = sigmaMin + (sigmaMax - sigmaMin) * j / (M - 1);
+    }
+}
+const SpaceTimeMesh& SpaceVolTimeMesh::getSpaceTimeMesh() const{ return stm;}
+std::size_t SpaceVolTimeMesh::get_N() const{ return stm.get_N();}
+std::size_t SpaceVolTimeMesh::get_M() const{ return sigmaNodes.size();}
+std::size_t SpaceVolTimeMesh::get_N_T() const{ return stm.get_N_T();}
+double SpaceVolTimeMesh::get_dsigma() const{ return (sigmaNodes.back() - sigmaNodes.front()) / (sigmaNodes.size() - 1);}
+const double* SpaceVolTimeMesh::getSigmaNodes() const{ return sigmaNodes.data();}
+
+FunctionMesh2D::FunctionMesh2D(const SpaceVolTimeMesh& mesh)
+    : N(mesh.get_N()), M(mesh.get_M()), N_T(mesh.get_N_T()), mesh_data(mesh.get_N() * mesh.get_M() * mesh.get_N_T(), 0), spaceVolTimeMesh(mesh) {}
+void FunctionMesh2D::setMeshData(std::size_t i, std::size_t j, std::size_t n, double val){
+    assert(i < N && j < M && n < N_T);
+    mesh_data[(n * M + j) * N + i] = val;
+}
+double FunctionMesh2D::getMeshData(std::size_t i, std::size_t j, std::size_t n) const{
+    assert(i < N && j < M && n < N_T);
+    return mesh_data[(n * M + j) * N + i];
+}
+double* FunctionMesh2D::getTimeSlice(std::size_t n){
+    assert(n < N_T);
+    return mesh_data.data() + n * M * N;
+}
+const double* FunctionMesh2D::getTimeSlice(std::size_t n) const{
+    assert(n < N_T);
+    return mesh_data.data() + n * M * N;
+}
+const SpaceVolTimeMesh& FunctionMesh2D::getSpaceVolTimeMesh() const{ return spaceVolTimeMesh;}
+
+template class BasicFunctionMesh<float>;
+template class BasicFunctionMesh<double>;
+template class BasicFunctionMesh<long double>;
+
+template void logMatrix<float>(const float* data, std::size_t X, std::size_t Y);
+template void logMatrix<double>(const double* data, std::size_t X, std::size_t Y);
+template void logMatrix<long double>(const long double* data, std::size_t X, std::size_t Y);
+template void logMatrix<unsigned char>(const unsigned char* data, std::size_t X, std::size_t Y);
@@ -1,28 +1,83 @@
 #pragma once
+#include "Instrumentation.hpp"
+#include "PricingArena.hpp"
 #include<iostream>
 #include<vector>
 #include<functional>
 #include<cassert>
+#include<cstddef>
+#include<new>
+#include<memory>
+#include<type_traits>
+
+// 64-byte aligned allocator: every mesh buffer starts on a cache line (and on an AVX register boundary), taken from
+// the heap or, when given one, from a PricingArena (the containers then have to go before the arena is reset)
+template <typename T, std::size_t Alignment = 64>
+struct AlignedAllocator {
+    static_assert(Alignment <= PricingArena::Alignment, "arena buffers are 64-byte aligned");
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    template <typename U>
+    struct rebind { using other = AlignedAllocator<U, Alignment>; };
+
+    PricingArena* arena = nullptr;
+
+    AlignedAllocator() noexcept = default;
+    explicit AlignedAllocator(PricingArena* arena) noexcept : arena(arena) {}
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>& other) noexcept : arena(other.arena) {}
+
+    T* allocate(std::size_t n) {
+        if (arena) {
+            return static_cast<T*>(arena->allocate(n * sizeof(T)));
+        }
+        PRICER_COUNT_ALLOCATIONS(1);
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+    }
+    void deallocate(T* p, std::size_t n) noexcept {
+        if (arena) {
+            arena->deallocate(p, n * sizeof(T));
+            return;
+        }
+        ::operator delete(p, std::align_val_t(Alignment));
+    }
+};
+template <typename T, typename U, std::size_t A>
+bool operator==(const AlignedAllocator<T, A>& a, const AlignedAllocator<U, A>& b) { return a.arena == b.arena; }
+template <typename T, typename U, std::size_t A>
+bool operator!=(const AlignedAllocator<T, A>& a, const AlignedAllocator<U, A>& b) { return a.arena != b.arena; }
 
-// for printing out the different meshes
 template <typename T>
-void logMatrix(const std::vector<std::vector<T>>& mat);
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
 
-class BoundaryConditions {
+// non owning view over a mesh buffer, stride 1 for a time slice and stride N for an x-row
+template <typename T>
+class StridedView {
 private:
-    // frontier_function is copied for stability
-    std::vector<std::vector<bool>> frontier; // all vector matrices can be replaced with one continuous vector (but for readability sake we opt for this approach)
-    const std::function<double(double, double)>& frontier_function;
-	
+    T* first;
+    std::size_t length;
+    std::ptrdiff_t step;
+
 public:
-    BoundaryConditions(const std::vector<std::vector<bool>>& contour, const std::function<double(double, double)>& function);
-    BoundaryConditions(std::size_t X, std::size_t Y, const std::function<double(double, double)>& function);
-    BoundaryConditions(const BoundaryConditions& other, const std::function<double(double, double)>& new_function); // necessary for vega calculus
-    double apply(double x, double y) const; // basically frontier_function(x,y);
-    bool check(std::size_t x, std::size_t y) const;
-    void uncheck(std::size_t x, std::size_t y);
-    void ToggleDir(bool dir, bool pos);
-    void logMesh() const;
+    StridedView(T* first, std::size_t length, std::ptrdiff_t step = 1) : first(first), length(length), step(step) {}
+    T& operator[](std::size_t k) const { return first[static_cast<std::ptrdiff_t>(k) * step]; }
+    std::size_t size() const { return length; }
+    std::ptrdiff_t stride() const { return step; }
+    bool contiguous() const { return step == 1; }
+    T* data() const { return first; }
+};
+
+// for printing out the different meshes (flat buffer stored time-slice-major, i.e. data[y*X + x])
+template <typename T>
+void logMatrix(const T* data, std::size_t X, std::size_t Y);
+
+// clustering of the nodes of a SpaceTimeMesh: sinh map in x (Tavella-Randall, one asinh term per center, i.e. node
+// density ~ sum 1/sqrt(alpha^2 + (x - c)^2) with alpha = 2R/concentration) and a quadratic grading in t
+struct MeshStretching {
+    std::vector<double> centers; // x = log S points to resolve (log K, barriers...), x0 when empty; those inside the mesh become nodes
+    double concentration = 0; // 0: uniform x axis, larger: finer around the centers (coarser far from them)
+    double timeGrading = 0; // in [0, 1): steps shrink by 1 - timeGrading at maturity and grow by 1 + timeGrading at t = 0
 };
 
 class SpaceTimeMesh {
@@ -32,28 +87,185 @@ private:
     double T;
     std::size_t N;
     std::size_t N_T;
+    std::vector<double> xNodes;
+    std::vector<double> tNodes;
+    bool uniformX;
+    bool uniformT;
 
 public:
     SpaceTimeMesh(double x0, double R, double T, int N, int N_T);
+    // stretched nodes on the same [x0 - R, x0 + R] x [0, T], x0 stays the middle node
+    SpaceTimeMesh(double x0, double R, double T, int N, int N_T, const MeshStretching& stretching);
+    // nodes of an existing mesh (e.g. read back from a mesh file), an axis flagged uniform has to hold uniform nodes
+    SpaceTimeMesh(double x0, double R, double T, std::vector<double> xNodes, std::vector<double> tNodes, bool uniformX, bool uniformT);
     std::size_t get_N() const;
     std::size_t get_N_T() const;
     double get_T() const;
     double get_R() const;
-    double get_dx() const;
+    double get_dx() const; // spacing of a uniform axis, mean spacing otherwise
     double get_dt() const;
-    std::pair<double, double> getCoords(std::size_t i, std::size_t n) const;
+    bool isUniformX() const;
+    bool isUniformT() const;
+    const double* getXNodes() const;
+    // x_{i+1} - x_i and t_{n+1} - t_n, exactly get_dx() and get_dt() on uniform axes
+    double get_dx(std::size_t i) const {
+        assert(i + 1 < N);
+        return uniformX ? 2*R/(N-1) : xNodes[i+1] - xNodes[i];
+    }
+    double get_dt(std::size_t n) const {
+        assert(n + 1 < N_T);
+        return uniformT ? T/(N_T-1) : tNodes[n+1] - tNodes[n];
+    }
+    // (x_i, t_n), inline so that the typed slice kernels compile down to arithmetic
+    std::pair<double, double> getCoords(std::size_t i, std::size_t n) const {
+        assert(i < N);
+        assert(n < N_T);
+        return {xNodes[i], tNodes[n]};
+    }
+};
+
+// checked x indices [begin, end) of one time slice
+struct FrontierRun {
+    std::size_t begin;
+    std::size_t end;
+    bool operator==(const FrontierRun& other) const { return begin == other.begin && end == other.end; }
+};
+
+// writes the boundary values of one time slice with the boundary function type known at compile time
+class BoundaryKernel {
+public:
+    virtual ~BoundaryKernel() = default;
+    virtual const std::function<double(double, double)>& erased() const = 0;
+    // runs: the checked cells of slice n, already clipped to the mesh
+    virtual void applySlice(const SpaceTimeMesh& stm, std::size_t n, const std::vector<FrontierRun>& runs, double* slice) const = 0;
 };
 
-class FunctionMesh {
-    std::vector<std::vector<double>> mesh_data;
+template <typename F>
+class TypedBoundaryKernel : public BoundaryKernel {
+private:
+    F function;
+    std::function<double(double, double)> fallback;
+
+public:
+    explicit TypedBoundaryKernel(const F& function) : function(function), fallback(function) {}
+    const std::function<double(double, double)>& erased() const override { return fallback; }
+    void applySlice(const SpaceTimeMesh& stm, std::size_t n, const std::vector<FrontierRun>& runs, double* slice) const override {
+        double t = stm.getCoords(0, n).second;
+        for (const FrontierRun& run : runs) {
+            for (std::size_t x = run.begin; x < run.end; x++) {
+                slice[x] = function(t, stm.getCoords(x, n).first); // f(t,x)
+            }
+        }
+    }
+};
+
+template <typename F>
+struct is_std_function : std::false_type {};
+template <typename Signature>
+struct is_std_function<std::function<Signature>> : std::true_type {};
+
+// any callable f(t,x) that isn't already a std::function
+template <typename F>
+using EnableIfBoundaryFunction = std::enable_if_t<
+    std::is_invocable_r_v<double, const F&, double, double> && !is_std_function<F>::value, int>;
+
+class BoundaryConditions {
+private:
+    std::size_t X;
+    std::size_t Y;
+    // per time slice, sorted disjoint runs of checked x: a ToggleDir edge is one run per slice (or one run)
+    // and applying the conditions costs the size of the boundary, not X*Y
+    std::vector<std::vector<FrontierRun>> frontier;
+    std::shared_ptr<const BoundaryKernel> kernel; // owns the function when built from a concrete callable
+    // owned and shared by the copies: points into the kernel, or at a copy of the std::function the conditions were built from
+    std::shared_ptr<const std::function<double(double, double)>> frontier_function;
+
+public:
+    BoundaryConditions(const std::vector<std::vector<bool>>& contour, const std::function<double(double, double)>& function);
+    BoundaryConditions(std::size_t X, std::size_t Y, const std::function<double(double, double)>& function);
+    BoundaryConditions(const BoundaryConditions& other, const std::function<double(double, double)>& new_function); // necessary for vega calculus
+    // typed callables (lambdas, functors) are stored in the conditions and applied without std::function per node
+    template <typename F, EnableIfBoundaryFunction<F> = 0>
+    BoundaryConditions(std::size_t X, std::size_t Y, const F& function)
+        : X(X), Y(Y), frontier(Y), kernel(std::make_shared<const TypedBoundaryKernel<F>>(function)),
+          frontier_function(kernel, &kernel->erased()) {}
+    template <typename F, EnableIfBoundaryFunction<F> = 0>
+    BoundaryConditions(const BoundaryConditions& other, const F& new_function)
+        : X(other.X), Y(other.Y), frontier(other.frontier), kernel(std::make_shared<const TypedBoundaryKernel<F>>(new_function)),
+          frontier_function(kernel, &kernel->erased()) {}
+    double apply(double x, double y) const; // basically frontier_function(x,y);
+    bool check(std::size_t x, std::size_t y) const; // false outside of the contour
+    bool sameFrontier(const BoundaryConditions& other) const;
+    // x indices checked in slice y, in increasing order (one pass over the slice instead of N check calls), clipped
+    // to x < N like applySlice: a frontier wider than the mesh gives no row outside of it
+    void collectSlice(std::size_t y, std::size_t N, std::vector<std::size_t>& rows) const;
+    void uncheck(std::size_t x, std::size_t y);
+    void checkRun(std::size_t y, std::size_t begin, std::size_t end); // checks x in [begin, end) of slice y
+    const std::vector<FrontierRun>& getRuns(std::size_t y) const;
+    std::size_t size() const; // number of checked cells
+    void ToggleDir(bool dir, bool pos);
+    // writes the boundary values of time slice n (slice[x] for every checked x)
+    void applySlice(const SpaceTimeMesh& stm, std::size_t n, double* slice) const;
+    void logMesh() const;
+};
+
+// values of a function on the mesh stored as T (defined for T = float, double, long double): float halves the memory
+// and bandwidth of a mesh, long double is for reference runs
+template <typename T>
+class BasicFunctionMesh {
+    // one aligned buffer, time-slice-major: mesh_data[n*N + i] = f(x_i, t_n)
+    // so that a time slice is contiguous and an x-row is a stride N view
+    std::size_t N;
+    std::size_t N_T;
+    AlignedVector<T> mesh_data;
     const SpaceTimeMesh& spaceTimeMesh;
 public:
-    FunctionMesh(const SpaceTimeMesh& stm);
-    void applyBoundaryConditions(const BoundaryConditions& bc);
+    BasicFunctionMesh(const SpaceTimeMesh& stm, PricingArena* arena = nullptr); // buffer taken from the arena when given
+    void applyBoundaryConditions(const BoundaryConditions& bc); // values computed in double, then rounded to T
     void logMesh() const;
-    void setMeshData(std::size_t i, std::size_t j, double val);
-    double getMeshData(std::size_t i, std::size_t j) const;
+    void setMeshData(std::size_t i, std::size_t j, T val);
+    T getMeshData(std::size_t i, std::size_t j) const;
+    StridedView<T> getTimeSlice(std::size_t n);
+    StridedView<const T> getTimeSlice(std::size_t n) const;
+    StridedView<T> getRow(std::size_t i);
+    StridedView<const T> getRow(std::size_t i) const;
     std::size_t getNumRows() const;
     std::size_t getNumCols() const;
     const SpaceTimeMesh& getSpaceTimeMesh() const;
 };
+
+using FunctionMesh = BasicFunctionMesh<double>;
+
+// (x, sigma, t) mesh of a two state variable problem: a uniform (x, t) SpaceTimeMesh times a uniform vol axis
+// sigma_j = sigmaMin + j*dsigma, j in [0, M) (std::invalid_argument unless 0 <= sigmaMin < sigmaMax and M >= 3)
+class SpaceVolTimeMesh {
+private:
+    SpaceTimeMesh stm;
+    std::vector<double> sigmaNodes;
+
+public:
+    SpaceVolTimeMesh(double x0, double R, double T, int N, int N_T, double sigmaMin, double sigmaMax, int M);
+    const SpaceTimeMesh& getSpaceTimeMesh() const;
+    std::size_t get_N() const;
+    std::size_t get_M() const;
+    std::size_t get_N_T() const;
+    double get_dsigma() const;
+    const double* getSigmaNodes() const;
+};
+
+// values of a function on a SpaceVolTimeMesh, one aligned buffer, time-slice-major then vol-major:
+// mesh_data[(n*M + j)*N + i] = f(x_i, sigma_j, t_n), so that a time slice and each of its x-lines are contiguous
+class FunctionMesh2D {
+    std::size_t N;
+    std::size_t M;
+    std::size_t N_T;
+    AlignedVector<double> mesh_data;
+    const SpaceVolTimeMesh& spaceVolTimeMesh;
+public:
+    FunctionMesh2D(const SpaceVolTimeMesh& mesh);
+    void setMeshData(std::size_t i, std::size_t j, std::size_t n, double val);
+    double getMeshData(std::size_t i, std::size_t j, std::size_t n) const;
+    double* getTimeSlice(std::size_t n); // N*M values, x-line j at j*N
+    const double* getTimeSlice(std::size_t n) const;
+    const SpaceVolTimeMesh& getSpaceVolTimeMesh() const;
+};
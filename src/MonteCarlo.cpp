@@ -0,0 +1,238 @@
+#include "MonteCarlo.hpp"
+#include "Pricers.hpp"
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <stdexcept>
+
+struct MonteCarloPricer::Workspace {
+    std::vector<double> normals; // draw d of path k at d*stride + k
+    std::vector<double> increments; // bridged increments, step n of path k at n*stride + k
+    std::vector<double> x, vol, rate, discount, controlX;
+    std::vector<double> volDrift, volPseudoVol, rateDrift, ratePseudoVol;
+    std::vector<double> spot, payoff;
+    std::vector<std::uint32_t> words;
+
+    Workspace(std::size_t steps, std::size_t stride, std::size_t dimensions)
+        : normals(steps * stride), increments(steps * stride), x(stride), vol(stride), rate(stride), discount(stride),
+          controlX(stride), volDrift(stride), volPseudoVol(stride), rateDrift(stride), ratePseudoVol(stride), spot(stride),
+          payoff(stride), words(dimensions) {}
+};
+
+void MonteCarloPricer::Moments::add(double y, double c) {
+    count += 1;
+    double dy = y - meanY;
+    double dc = c - meanC;
+    meanY += dy / count;
+    meanC += dc / count;
+    m2Y += dy * (y - meanY);
+    m2C += dc * (c - meanC);
+    coYC += dy * (c - meanC);
+}
+
+void MonteCarloPricer::Moments::merge(const Moments& other) {
+    double total = count + other.count;
+    if (total == 0) {
+        return;
+    }
+    double dy = other.meanY - meanY;
+    double dc = other.meanC - meanC;
+    double weight = count * other.count / total;
+    meanY += dy * other.count / total;
+    meanC += dc * other.count / total;
+    m2Y += other.m2Y + dy * dy * weight;
+    m2C += other.m2C + dc * dc * weight;
+    coYC += other.coYC + dy * dc * weight;
+    count = total;
+}
+
+MonteCarloPricer::MonteCarloPricer(const Contract& contract, double sigma_0, double r_0, const MonteCarloSettings& settings)
+    : contract(contract), sigma_0(sigma_0), r_0(r_0), settings(settings),
+      units(settings.antithetic ? (settings.paths + 1) / 2 : settings.paths) {
+    if (units < 2 || settings.steps == 0) {
+        throw std::invalid_argument("Monte Carlo: at least two samples and one step needed.");
+    }
+    if (contract.getExercise().style != ExerciseStyle::European) {
+        throw std::invalid_argument("Monte Carlo: european exercise only.");
+    }
+    if (settings.source == RandomSource::Sobol) {
+        sobol.emplace(std::min(settings.steps, SobolSequence::maxDimensions));
+        bridge.emplace(settings.steps);
+        for (std::size_t d = 0; d < sobol->getDimensions(); d++) {
+            digitalShift.push_back(philox4x32({static_cast<std::uint32_t>(d), 0, 0, 1},
+                                              {static_cast<std::uint32_t>(settings.seed), static_cast<std::uint32_t>(settings.seed >> 32)})[0]);
+        }
+    }
+}
+
+void MonteCarloPricer::drawNormals(std::size_t firstUnit, std::size_t count, Workspace& workspace) const {
+    std::size_t stride = workspace.x.size();
+    std::size_t quasiDimensions = sobol ? sobol->getDimensions() : 0;
+    std::array<std::uint32_t, 2> key = {static_cast<std::uint32_t>(settings.seed), static_cast<std::uint32_t>(settings.seed >> 32)};
+    double* normals = workspace.normals.data();
+    for (std::size_t u = 0; u < count; u++) {
+        std::uint64_t unit = firstUnit + u;
+        if (sobol) {
+            if (u == 0) {
+                sobol->point(unit, workspace.words.data());
+            } else {
+                sobol->next(unit - 1, workspace.words.data());
+            }
+            for (std::size_t d = 0; d < quasiDimensions; d++) {
+                std::uint32_t word = workspace.words[d] ^ digitalShift[d];
+                normals[d * stride + u] = inverse_norm_cdf((static_cast<double>(word) + 0.5) * 0x1.0p-32);
+            }
+        }
+        // two normals per Philox call, counter (sample, draw pair)
+        for (std::size_t d = quasiDimensions & ~static_cast<std::size_t>(1); d < settings.steps; d += 2) {
+            std::array<std::uint32_t, 4> words = philox4x32(
+                {static_cast<std::uint32_t>(unit), static_cast<std::uint32_t>(unit >> 32), static_cast<std::uint32_t>(d / 2), 0}, key);
+            if (d >= quasiDimensions) {
+                normals[d * stride + u] = inverse_norm_cdf(to_uniform(words[0], words[1]));
+            }
+            if (d + 1 < settings.steps) {
+                normals[(d + 1) * stride + u] = inverse_norm_cdf(to_uniform(words[2], words[3]));
+            }
+        }
+    }
+    if (settings.antithetic) {
+        for (std::size_t d = 0; d < settings.steps; d++) {
+            for (std::size_t u = 0; u < count; u++) {
+                normals[d * stride + count + u] = -normals[d * stride + u];
+            }
+        }
+    }
+}
+
+void MonteCarloPricer::simulateBlocks(std::size_t first, std::size_t last, std::vector<Moments>& moments) const {
+    std::size_t width = settings.antithetic ? 2 : 1;
+    std::size_t stride = blockUnits * width;
+    std::size_t steps = settings.steps;
+    Workspace workspace(steps, stride, sobol ? sobol->getDimensions() : 0);
+    const ItoDynamics& volDynamics = contract.getUnderlying().getVolDynamics();
+    const ItoDynamics& rateDynamics = contract.getUnderlying().getRateDynamics();
+    double T = contract.getMaturity();
+    double dt = T / steps;
+    double sqrtDt = std::sqrt(dt);
+    double x0 = std::log(contract.getUnderlying().getS0());
+    double controlDrift = (r_0 - 0.5 * sigma_0 * sigma_0) * dt;
+    double controlDiscount = std::exp(-r_0 * T);
+
+    for (std::size_t block = first; block < last; block++) {
+        std::size_t firstUnit = block * blockUnits;
+        std::size_t count = std::min(blockUnits, units - firstUnit);
+        std::size_t paths = count * width;
+        drawNormals(firstUnit, count, workspace);
+        const double* increments = workspace.normals.data();
+        if (bridge) {
+            bridge->transform(workspace.normals.data(), workspace.increments.data(), stride, paths);
+            increments = workspace.increments.data();
+        }
+
+        double* x = workspace.x.data();
+        double* vol = workspace.vol.data();
+        double* rate = workspace.rate.data();
+        double* discount = workspace.discount.data();
+        double* controlX = workspace.controlX.data();
+        double* volDrift = workspace.volDrift.data();
+        double* volPseudoVol = workspace.volPseudoVol.data();
+        double* rateDrift = workspace.rateDrift.data();
+        double* ratePseudoVol = workspace.ratePseudoVol.data();
+        std::fill_n(x, paths, x0);
+        std::fill_n(vol, paths, sigma_0);
+        std::fill_n(rate, paths, r_0);
+        std::fill_n(discount, paths, 0.);
+        std::fill_n(controlX, paths, x0);
+        for (std::size_t n = 0; n < steps; n++) {
+            double t = n * dt;
+            const double* z = increments + n * stride;
+            // coefficients at the start of the step
+            volDynamics.evaluate(t, x, vol, volDrift, volPseudoVol, paths);
+            rateDynamics.evaluate(t, x, rate, rateDrift, ratePseudoVol, paths);
+            if (settings.scheme == Discretization::Milstein) {
+                for (std::size_t k = 0; k < paths; k++) {
+                    double dW = sqrtDt * z[k];
+                    double dx = (rate[k] - 0.5 * vol[k] * vol[k]) * dt + vol[k] * dW + 0.5 * volPseudoVol[k] * vol[k] * (dW * dW - dt);
+                    discount[k] += rate[k] * dt;
+                    vol[k] += volDrift[k] * dt + volPseudoVol[k] * dx;
+                    rate[k] += rateDrift[k] * dt + ratePseudoVol[k] * dx;
+                    x[k] += dx;
+                    controlX[k] += controlDrift + sigma_0 * dW;
+                }
+            } else {
+                for (std::size_t k = 0; k < paths; k++) {
+                    double dW = sqrtDt * z[k];
+                    double dx = (rate[k] - 0.5 * vol[k] * vol[k]) * dt + vol[k] * dW;
+                    discount[k] += rate[k] * dt;
+                    vol[k] += volDrift[k] * dt + volPseudoVol[k] * dx;
+                    rate[k] += rateDrift[k] * dt + ratePseudoVol[k] * dx;
+                    x[k] += dx;
+                    controlX[k] += controlDrift + sigma_0 * dW;
+                }
+            }
+        }
+
+        double* spot = workspace.spot.data();
+        double* payoff = workspace.payoff.data();
+        for (std::size_t k = 0; k < paths; k++) {
+            spot[k] = std::exp(x[k]);
+        }
+        contract.applyPayoff(spot, payoff, paths);
+        double strike = settings.controlStrike.value_or(0);
+        Moments& blockMoments = moments[block];
+        blockMoments = Moments();
+        for (std::size_t u = 0; u < count; u++) {
+            double y = 0;
+            double c = 0;
+            for (std::size_t k = u; k < paths; k += count) {
+                y += std::exp(-discount[k]) * payoff[k];
+                if (settings.controlStrike) {
+                    c += controlDiscount * std::max(std::exp(controlX[k]) - strike, 0.);
+                }
+            }
+            blockMoments.add(y / width, c / width);
+        }
+    }
+}
+
+MonteCarloResult MonteCarloPricer::finish(const std::vector<Moments>& moments) const {
+    Moments total;
+    for (const Moments& block : moments) {
+        total.merge(block);
+    }
+    double price = total.meanY;
+    double variance = total.m2Y / (total.count - 1);
+    if (settings.controlStrike && total.m2C > 0) {
+        BlackScholesCallPricer control(contract.getUnderlying().getS0(), *settings.controlStrike, contract.getMaturity(), r_0, sigma_0);
+        control.price();
+        double beta = total.coYC / total.m2C;
+        price -= beta * (total.meanC - control.getPrice());
+        variance = (total.m2Y - beta * total.coYC) / (total.count - 1);
+    }
+    return {price, std::sqrt(std::max(variance, 0.) / total.count), units * (settings.antithetic ? 2 : 1)};
+}
+
+MonteCarloResult MonteCarloPricer::price() const {
+    std::size_t blocks = (units + blockUnits - 1) / blockUnits;
+    std::vector<Moments> moments(blocks);
+    simulateBlocks(0, blocks, moments);
+    return finish(moments);
+}
+
+MonteCarloResult MonteCarloPricer::price(ThreadPool& pool) const {
+    std::size_t blocks = (units + blockUnits - 1) / blockUnits;
+    std::vector<Moments> moments(blocks);
+    // a few chunks per worker for stealing to balance, each with its own workspace
+    std::size_t chunks = std::min(blocks, 4 * pool.size());
+    std::vector<std::future<void>> futures;
+    futures.reserve(chunks);
+    for (std::size_t c = 0; c < chunks; c++) {
+        std::size_t first = blocks * c / chunks;
+        std::size_t last = blocks * (c + 1) / chunks;
+        futures.push_back(pool.submit([this, first, last, &moments]() { simulateBlocks(first, last, moments); }));
+    }
+    for (std::future<void>& future : futures) {
+        future.get();
+    }
+    return finish(moments);
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include "Asset.hpp"
+#include "Random.hpp"
+#include "ThreadPool.hpp"
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+// step of the log price: Euler, or Milstein (the vol process moves with x, which gives x a state dependent diffusion;
+// the vol and rate processes themselves are always stepped with Euler)
+enum class Discretization { Euler, Milstein };
+enum class RandomSource { Pseudo, Sobol };
+
+struct MonteCarloSettings {
+    std::size_t paths = 100000;
+    std::size_t steps = 100;
+    Discretization scheme = Discretization::Euler;
+    // Sobol: the first SobolSequence::maxDimensions draws of each path are quasi random (digitally shifted by the seed)
+    // and go through a Brownian bridge, the following ones come from the pseudo random stream
+    RandomSource source = RandomSource::Pseudo;
+    bool antithetic = false; // paths in pairs with opposite increments, the pair average being one sample
+    std::optional<double> controlStrike; // control variate: call of this strike on a constant sigma_0, r_0 path with the same increments
+    std::uint64_t seed = 0;
+};
+
+struct MonteCarloResult {
+    double price;
+    double standardError; // of the independent samples (not a confidence bound for Sobol points)
+    std::size_t paths;
+};
+
+// simulates x = log S with its vol and rate processes (asset dynamics, started at sigma_0 and r_0):
+// dx = (r - vol^2/2) dt + vol dW, dvol = drift dt + pseudoVol dx (same for r), payoff discounted along the path.
+// Paths are simulated in blocks of blockUnits samples stored as structure of arrays (one contiguous array per state
+// variable and per step). Draws come from a counter based generator indexed by (sample, draw), and block statistics are
+// merged in block order, so the result only depends on the settings, not on the number of threads.
+// European contracts only (std::invalid_argument otherwise).
+class MonteCarloPricer {
+public:
+    static constexpr std::size_t blockUnits = 32;
+
+private:
+    // running means and centered (co)moments of the discounted payoff y and of the control c
+    struct Moments {
+        double count = 0;
+        double meanY = 0;
+        double meanC = 0;
+        double m2Y = 0;
+        double m2C = 0;
+        double coYC = 0;
+        void add(double y, double c);
+        void merge(const Moments& other);
+    };
+    struct Workspace;
+
+    const Contract& contract;
+    double sigma_0;
+    double r_0;
+    MonteCarloSettings settings;
+    std::size_t units; // independent samples
+    std::optional<SobolSequence> sobol;
+    std::optional<BrownianBridge> bridge;
+    std::vector<std::uint32_t> digitalShift;
+
+    void drawNormals(std::size_t firstUnit, std::size_t count, Workspace& workspace) const;
+    void simulateBlocks(std::size_t first, std::size_t last, std::vector<Moments>& moments) const;
+    MonteCarloResult finish(const std::vector<Moments>& moments) const;
+
+public:
+    MonteCarloPricer(const Contract& contract, double sigma_0, double r_0, const MonteCarloSettings& settings);
+    // on the calling thread
+    MonteCarloResult price() const;
+    // blocks shared between the pool's workers, same result as price()
+    MonteCarloResult price(ThreadPool& pool) const;
+};
@@ -0,0 +1,142 @@
+#include "PriceSurface.hpp"
+#include "Pricers.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+// second derivatives of the natural cubic spline through (x_i, y_i), zero at both ends
+void natural_spline(const double* x, const double* y, double* secondDerivatives, std::size_t N,
+                    std::vector<double>& lower, std::vector<double>& diag, std::vector<double>& upper, std::vector<double>& work) {
+    lower.assign(N, 0);
+    diag.assign(N, 1);
+    upper.assign(N, 0);
+    work.resize(3 * N);
+    secondDerivatives[0] = 0;
+    secondDerivatives[N - 1] = 0;
+    for (std::size_t i = 1; i + 1 < N; i++) {
+        double below = x[i] - x[i - 1];
+        double above = x[i + 1] - x[i];
+        lower[i] = below / 6;
+        diag[i] = (below + above) / 3;
+        upper[i] = above / 6;
+        secondDerivatives[i] = (y[i + 1] - y[i]) / above - (y[i] - y[i - 1]) / below;
+    }
+    solve_tridiagonal(lower.data(), diag.data(), upper.data(), secondDerivatives, work.data(), work.data() + N, work.data() + 2 * N, N);
+}
+
+// value and first two derivatives of the spline on [x_i, x_{i+1}] at A = (x_{i+1} - x) / h
+struct SplineValue {
+    double f;
+    double fx;
+    double fxx;
+};
+SplineValue spline_at(const double* y, const double* yxx, std::size_t i, double h, double A) {
+    double B = 1 - A;
+    return {A * y[i] + B * y[i + 1] + ((A * A * A - A) * yxx[i] + (B * B * B - B) * yxx[i + 1]) * h * h / 6,
+            (y[i + 1] - y[i]) / h - (3 * A * A - 1) / 6 * h * yxx[i] + (3 * B * B - 1) / 6 * h * yxx[i + 1],
+            A * yxx[i] + B * yxx[i + 1]};
+}
+}
+
+PriceSurface::PriceSurface(const SpaceTimeMesh& stm, const FunctionMesh& prices) : PriceSurface(stm, prices.getTimeSlice(0).data()) {}
+
+PriceSurface::PriceSurface(const SpaceTimeMesh& stm, const double* prices)
+    : N(stm.get_N()), N_T(stm.get_N_T()), x(stm.getXNodes(), stm.getXNodes() + N), t(N_T), uniformX(stm.isUniformX()),
+      uniformT(stm.isUniformT()), value(prices, prices + N * N_T), valueXX(N * N_T), slope(N * N_T), slopeXX(N * N_T) {
+    if (N < 3 || N_T < 3) {
+        throw std::invalid_argument("price surface: at least three nodes in x and t needed.");
+    }
+    for (std::size_t n = 0; n < N_T; n++) {
+        t[n] = stm.getCoords(0, n).second;
+    }
+    // slopes in t: three point differences on the (possibly graded) nodes, one sided of the same order at both ends
+    for (std::size_t n = 0; n < N_T; n++) {
+        std::size_t mid = std::min(std::max<std::size_t>(n, 1), N_T - 2);
+        double h0 = t[mid] - t[mid - 1];
+        double h1 = t[mid + 1] - t[mid];
+        double s = t[n] - t[mid]; // -h0, 0 or h1
+        // derivative at t_mid + s of the parabola through the three slices
+        double w0 = (2 * s - h1) / (h0 * (h0 + h1));
+        double w1 = -(2 * s + h0 - h1) / (h0 * h1);
+        double w2 = (2 * s + h0) / (h1 * (h0 + h1));
+        const double* v0 = value.data() + (mid - 1) * N;
+        const double* v1 = value.data() + mid * N;
+        const double* v2 = value.data() + (mid + 1) * N;
+        double* out = slope.data() + n * N;
+        for (std::size_t i = 0; i < N; i++) {
+            out[i] = w0 * v0[i] + w1 * v1[i] + w2 * v2[i];
+        }
+    }
+    std::vector<double> lower, diag, upper, work;
+    for (std::size_t n = 0; n < N_T; n++) {
+        natural_spline(x.data(), value.data() + n * N, valueXX.data() + n * N, N, lower, diag, upper, work);
+        natural_spline(x.data(), slope.data() + n * N, slopeXX.data() + n * N, N, lower, diag, upper, work);
+    }
+}
+
+std::size_t PriceSurface::locate(const std::vector<double>& nodes, bool uniform, double point) const {
+    std::size_t intervals = nodes.size() - 1;
+    std::size_t k = uniform ? static_cast<std::size_t>((point - nodes[0]) / (nodes[intervals] - nodes[0]) * intervals)
+                            : static_cast<std::size_t>(std::upper_bound(nodes.begin(), nodes.end(), point) - nodes.begin()) - 1;
+    return std::min(k, intervals - 1);
+}
+
+double PriceSurface::minSpot() const {
+    return std::exp(x.front());
+}
+
+double PriceSurface::maxSpot() const {
+    return std::exp(x.back());
+}
+
+double PriceSurface::getT() const {
+    return t.back();
+}
+
+double PriceSurface::price(double S, double t) const {
+    return evaluate(S, t).price;
+}
+
+SurfacePoint PriceSurface::evaluate(double S, double time) const {
+    double logS = std::log(S);
+    // small tolerance so that the edges of the mesh (exp(log) round trip) are inside
+    if (!(logS >= x.front() - 1e-12 && logS <= x.back() + 1e-12 && time >= 0 && time <= t.back())) {
+        throw std::out_of_range("price surface: (S, t) outside of the solved mesh.");
+    }
+    std::size_t i = locate(x, uniformX, logS);
+    std::size_t n = locate(t, uniformT, time);
+    double h = x[i + 1] - x[i];
+    double A = std::min(std::max((x[i + 1] - logS) / h, 0.), 1.);
+    SplineValue v0 = spline_at(value.data() + n * N, valueXX.data() + n * N, i, h, A);
+    SplineValue v1 = spline_at(value.data() + (n + 1) * N, valueXX.data() + (n + 1) * N, i, h, A);
+    SplineValue s0 = spline_at(slope.data() + n * N, slopeXX.data() + n * N, i, h, A);
+    SplineValue s1 = spline_at(slope.data() + (n + 1) * N, slopeXX.data() + (n + 1) * N, i, h, A);
+
+    // cubic Hermite basis on [t_n, t_{n+1}] and its derivative in t
+    double k = t[n + 1] - t[n];
+    double u = std::min(std::max((time - t[n]) / k, 0.), 1.);
+    double h00 = (1 + 2 * u) * (1 - u) * (1 - u);
+    double h10 = u * (1 - u) * (1 - u) * k;
+    double h01 = u * u * (3 - 2 * u);
+    double h11 = u * u * (u - 1) * k;
+    double d00 = 6 * u * (u - 1) / k;
+    double d10 = (1 - u) * (1 - 3 * u);
+    double d01 = -d00;
+    double d11 = u * (3 * u - 2);
+    double f = h00 * v0.f + h10 * s0.f + h01 * v1.f + h11 * s1.f;
+    double fx = h00 * v0.fx + h10 * s0.fx + h01 * v1.fx + h11 * s1.fx;
+    double fxx = h00 * v0.fxx + h10 * s0.fxx + h01 * v1.fxx + h11 * s1.fxx;
+    double ft = d00 * v0.f + d10 * s0.f + d01 * v1.f + d11 * s1.f;
+    // V(S) = f(log S): dV/dS = f_x / S, d2V/dS2 = (f_xx - f_x) / S^2
+    return {f, fx / S, (fxx - fx) / (S * S), ft};
+}
+
+std::vector<SurfacePoint> PriceSurface::evaluate(const std::vector<double>& spots, double time) const {
+    std::vector<SurfacePoint> points;
+    points.reserve(spots.size());
+    for (double S : spots) {
+        points.push_back(evaluate(S, time));
+    }
+    return points;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include "MeshUtils.hpp"
+#include <vector>
+
+// price and greeks of a solved surface at one (S, t), greeks in S and calendar t (same conventions as BlackScholesPricer)
+struct SurfacePoint {
+    double price;
+    double delta; // dV/dS
+    double gamma; // d2V/dS2
+    double theta; // dV/dt
+};
+
+// every node of a solved price mesh, queried anywhere inside it without solving again: natural cubic spline in x = log S
+// on each time slice, cubic Hermite in t between slices (slopes from three point differences in t), all coefficients
+// computed once in the constructor (about four doubles per node). Owns its data, so it outlives the pricer.
+class PriceSurface {
+private:
+    std::size_t N;
+    std::size_t N_T;
+    std::vector<double> x; // nodes of the mesh
+    std::vector<double> t;
+    bool uniformX;
+    bool uniformT;
+    // time-slice-major like the meshes: value, its spline second derivative in x, its slope in t and the spline second
+    // derivative of that slope
+    std::vector<double> value;
+    std::vector<double> valueXX;
+    std::vector<double> slope;
+    std::vector<double> slopeXX;
+
+    std::size_t locate(const std::vector<double>& nodes, bool uniform, double point) const;
+
+public:
+    // prices[n*N + i] at (x_i, t_n) of the mesh, e.g. a FullGrid DiscretePricer's prices or a mapped mesh file
+    PriceSurface(const SpaceTimeMesh& stm, const double* prices);
+    PriceSurface(const SpaceTimeMesh& stm, const FunctionMesh& prices);
+    double minSpot() const;
+    double maxSpot() const;
+    double getT() const;
+    // S in [minSpot(), maxSpot()], t in [0, T], std::out_of_range otherwise
+    double price(double S, double t) const;
+    SurfacePoint evaluate(double S, double t) const;
+    // spot ladder at one date
+    std::vector<SurfacePoint> evaluate(const std::vector<double>& spots, double t) const;
+};
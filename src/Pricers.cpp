@@ -1,113 +1,874 @@
 #include "Pricers.hpp"
+#include <algorithm>
+#include <type_traits>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
 
 double norm_cdf(double x) {
     return 0.5 * erfc(-x / sqrt(2));
 }
-std::pair<long double, long double> solve_Mx_b(long double& A, long double& B, long double& C, long double& D, long double& E, long double& F) {
-    long double det = A * E - B * D;
-    if (det == 0) {
-        throw std::invalid_argument("det nul, system non détérminé.");
+template <typename Real>
+void factor_tridiagonal(const Real* lower, const Real* diag, const Real* upper, Real* modLower, Real* modUpper, Real* invPivots, std::size_t n) {
+    Real m = diag[0];
+    for (std::size_t i = 0; i < n; i++) {
+        if (i > 0) {
+            m = diag[i] - lower[i] * modUpper[i - 1];
+        }
+        if (m == 0) {
+            throw std::invalid_argument("pivot nul, system non détérminé.");
+        }
+        invPivots[i] = 1 / m;
+        modLower[i] = lower[i] * invPivots[i];
+        modUpper[i] = upper[i] * invPivots[i];
+    }
+}
+
+template <typename Real>
+void substitute_tridiagonal(const Real* modLower, const Real* modUpper, const Real* invPivots, Real* rhs, std::size_t n) {
+    rhs[0] *= invPivots[0];
+    for (std::size_t i = 1; i < n; i++) {
+        rhs[i] = rhs[i] * invPivots[i] - modLower[i] * rhs[i - 1];
+    }
+    for (std::size_t i = n - 1; i-- > 0;) {
+        rhs[i] -= modUpper[i] * rhs[i + 1];
+    }
+}
+
+template <typename Real>
+void solve_tridiagonal(const Real* lower, const Real* diag, const Real* upper, Real* rhs, Real* modLower, Real* modUpper, Real* invPivots, std::size_t n) {
+    factor_tridiagonal(lower, diag, upper, modLower, modUpper, invPivots, n);
+    substitute_tridiagonal(modLower, modUpper, invPivots, rhs, n);
+}
+
+namespace {
+// factor_tridiagonal eliminating from row n-1 down to row 0 (UL), the pivots then come from the top rows
+template <typename Real>
+void factor_tridiagonal_reversed(const Real* lower, const Real* diag, const Real* upper, Real* modLower, Real* modUpper, Real* invPivots, std::size_t n) {
+    Real m = diag[n - 1];
+    for (std::size_t i = n; i-- > 0;) {
+        if (i + 1 < n) {
+            m = diag[i] - upper[i] * modLower[i + 1];
+        }
+        if (m == 0) {
+            throw std::invalid_argument("pivot nul, system non détérminé.");
+        }
+        invPivots[i] = 1 / m;
+        modLower[i] = lower[i] * invPivots[i];
+        modUpper[i] = upper[i] * invPivots[i];
+    }
+}
+
+// substitutions projecting each node on the obstacle, the length of the run of exercised nodes from the edge where
+// they start is counted on the way. above: LU factors, from row n-1 down; below: reversed factors, from row 0 up
+template <typename Real>
+std::size_t substitute_projected_above(const Real* modLower, const Real* modUpper, const Real* invPivots, Real* rhs, const double* obstacle, std::size_t n) {
+    rhs[0] *= invPivots[0];
+    for (std::size_t i = 1; i < n; i++) {
+        rhs[i] = rhs[i] * invPivots[i] - modLower[i] * rhs[i - 1];
+    }
+    std::size_t exercised = 0;
+    for (std::size_t i = n; i-- > 0;) {
+        Real value = i + 1 < n ? rhs[i] - modUpper[i] * rhs[i + 1] : rhs[i];
+        Real bound = static_cast<Real>(obstacle[i]);
+        if (value <= bound) {
+            value = bound;
+            exercised += exercised == n - 1 - i;
+        }
+        rhs[i] = value;
+    }
+    return exercised;
+}
+
+template <typename Real>
+std::size_t substitute_projected_below(const Real* modLower, const Real* modUpper, const Real* invPivots, Real* rhs, const double* obstacle, std::size_t n) {
+    rhs[n - 1] *= invPivots[n - 1];
+    for (std::size_t i = n - 1; i-- > 0;) {
+        rhs[i] = rhs[i] * invPivots[i] - modUpper[i] * rhs[i + 1];
+    }
+    std::size_t exercised = 0;
+    for (std::size_t i = 0; i < n; i++) {
+        Real value = i > 0 ? rhs[i] - modLower[i] * rhs[i - 1] : rhs[i];
+        Real bound = static_cast<Real>(obstacle[i]);
+        if (value <= bound) {
+            value = bound;
+            exercised += exercised == i;
+        }
+        rhs[i] = value;
+    }
+    return exercised;
+}
+
+// edges without dirichlet data: zero gamma in S (f_xx = f_x) gives the ghost nodes, at the spacing h of the edge,
+// u_{-1} = (2u_0 - (1-h/2)u_1)/(1+h/2) and u_N = (2u_{N-1} - (1+h/2)u_{N-2})/(1-h/2)
+template <typename Real>
+void close_edges(Real* lower, Real* diag, Real* upper, Real hLow, Real hHigh, std::size_t N) {
+    diag[0] += 2*lower[0]/(1 + hLow/2);
+    upper[0] -= lower[0]*(1 - hLow/2)/(1 + hLow/2);
+    lower[0] = 0;
+    diag[N-1] += 2*upper[N-1]/(1 - hHigh/2);
+    lower[N-1] -= upper[N-1]*(1 + hHigh/2)/(1 - hHigh/2);
+    upper[N-1] = 0;
+}
+}
+
+NonUniformStencil::NonUniformStencil(const double* x, std::size_t i, std::size_t N)
+    : below(i > 0 ? x[i] - x[i-1] : x[1] - x[0]), above(i + 1 < N ? x[i+1] - x[i] : x[N-1] - x[N-2]) {
+    double span = below + above;
+    first[0] = -above/(below*span);
+    first[1] = (above - below)/(below*above);
+    first[2] = below/(above*span);
+    second[0] = 2/(below*span);
+    second[1] = -2/(below*above);
+    second[2] = 2/(above*span);
+}
+
+std::vector<NonUniformStencil> nonuniform_stencils(const double* x, std::size_t N) {
+    std::vector<NonUniformStencil> stencils;
+    nonuniform_stencils(x, N, stencils);
+    return stencils;
+}
+
+void nonuniform_stencils(const double* x, std::size_t N, std::vector<NonUniformStencil>& stencils) {
+    stencils.clear();
+    stencils.reserve(N);
+    for (std::size_t i = 0; i < N; i++) {
+        stencils.emplace_back(x, i, N);
+    }
+}
+
+template <typename Real>
+void assemble_operator(const double* vol, const double* rate, double dx, Real* lower, Real* diag, Real* upper, std::size_t N) {
+    const Real invDx = 1/static_cast<Real>(dx);
+    const Real invDx2 = invDx*invDx;
+    std::size_t i = 0;
+#if defined(__AVX2__)
+    if constexpr (std::is_same_v<Real, double>) {
+        const __m256d half = _mm256_set1_pd(0.5);
+        const __m256d vInvDx = _mm256_set1_pd(invDx);
+        const __m256d vInvDx2 = _mm256_set1_pd(invDx2);
+        for (; i + 4 <= N; i += 4) {
+            __m256d r = _mm256_loadu_pd(rate + i);
+            __m256d sigma = _mm256_loadu_pd(vol + i);
+            __m256d sigma2 = _mm256_mul_pd(sigma, sigma);
+            __m256d drift = _mm256_sub_pd(r, _mm256_mul_pd(half, sigma2));
+            __m256d diffusion = _mm256_mul_pd(_mm256_mul_pd(half, sigma2), vInvDx2);
+            __m256d convection = _mm256_mul_pd(_mm256_mul_pd(half, drift), vInvDx);
+            _mm256_storeu_pd(upper + i, _mm256_sub_pd(_mm256_setzero_pd(), _mm256_add_pd(diffusion, convection))); // a
+            _mm256_storeu_pd(diag + i, _mm256_add_pd(r, _mm256_mul_pd(sigma2, vInvDx2))); // b
+            _mm256_storeu_pd(lower + i, _mm256_sub_pd(convection, diffusion)); // c
+        }
+    }
+#endif
+    for (; i < N; i++) {
+        Real r = rate[i];
+        Real sigma2 = static_cast<Real>(vol[i]) * static_cast<Real>(vol[i]);
+        Real drift = r - Real(0.5)*sigma2;
+        Real diffusion = Real(0.5)*sigma2*invDx2;
+        Real convection = Real(0.5)*drift*invDx;
+        upper[i] = -(diffusion + convection); // a
+        diag[i] = r + sigma2*invDx2; // b
+        lower[i] = convection - diffusion; // c
+    }
+    close_edges(lower, diag, upper, static_cast<Real>(dx), static_cast<Real>(dx), N);
+}
+
+template <typename Real>
+void assemble_operator(const double* vol, const double* rate, const NonUniformStencil* stencils, Real* lower, Real* diag, Real* upper, std::size_t N) {
+    for (std::size_t i = 0; i < N; i++) {
+        const NonUniformStencil& stencil = stencils[i];
+        Real r = rate[i];
+        Real halfSigma2 = Real(0.5)*static_cast<Real>(vol[i])*static_cast<Real>(vol[i]);
+        Real drift = r - halfSigma2;
+        upper[i] = -(halfSigma2*static_cast<Real>(stencil.second[2]) + drift*static_cast<Real>(stencil.first[2]));
+        diag[i] = r - (halfSigma2*static_cast<Real>(stencil.second[1]) + drift*static_cast<Real>(stencil.first[1]));
+        lower[i] = -(halfSigma2*static_cast<Real>(stencil.second[0]) + drift*static_cast<Real>(stencil.first[0]));
+    }
+    close_edges(lower, diag, upper, static_cast<Real>(stencils[0].above), static_cast<Real>(stencils[N-1].below), N);
+}
+
+void assemble_operator_adjoint(const double* vol, double dx, const double* lowerBar, const double* diagBar,
+                               const double* upperBar, double* volBar, double* rateBar, std::size_t N) {
+    const double invDx = 1/dx;
+    const double invDx2 = invDx*invDx;
+    const double h = dx;
+    for (std::size_t i = 0; i < N; i++) {
+        // back to the coefficients a (upper), b (diag), c (lower) of node i before the edges are closed
+        double aBar = upperBar[i];
+        double bBar = diagBar[i];
+        double cBar = lowerBar[i];
+        if (i == 0) {
+            cBar = 2*diagBar[0]/(1 + h/2) - upperBar[0]*(1 - h/2)/(1 + h/2);
+        }
+        if (i == N-1) {
+            aBar = 2*diagBar[N-1]/(1 - h/2) - lowerBar[N-1]*(1 + h/2)/(1 - h/2);
+        }
+        // a = -(sigma^2/2dx^2 + (r - sigma^2/2)/2dx), b = r + sigma^2/dx^2, c = (r - sigma^2/2)/2dx - sigma^2/2dx^2
+        double sigma = vol[i];
+        volBar[i] += aBar*(sigma*invDx/2 - sigma*invDx2) + bBar*2*sigma*invDx2 - cBar*(sigma*invDx/2 + sigma*invDx2);
+        rateBar[i] += -aBar*invDx/2 + bBar + cBar*invDx/2;
+    }
+}
+
+void assemble_operator_adjoint(const double* vol, const NonUniformStencil* stencils, const double* lowerBar, const double* diagBar,
+                               const double* upperBar, double* volBar, double* rateBar, std::size_t N) {
+    const double hLow = stencils[0].above;
+    const double hHigh = stencils[N-1].below;
+    for (std::size_t i = 0; i < N; i++) {
+        double aBar = upperBar[i];
+        double bBar = diagBar[i];
+        double cBar = lowerBar[i];
+        if (i == 0) {
+            cBar = 2*diagBar[0]/(1 + hLow/2) - upperBar[0]*(1 - hLow/2)/(1 + hLow/2);
+        }
+        if (i == N-1) {
+            aBar = 2*diagBar[N-1]/(1 - hHigh/2) - lowerBar[N-1]*(1 + hHigh/2)/(1 - hHigh/2);
+        }
+        // coefficient k = -(sigma^2/2 D2_k + (r - sigma^2/2) D1_k) (+ r on the diagonal)
+        const NonUniformStencil& stencil = stencils[i];
+        double sigma = vol[i];
+        volBar[i] += sigma*(cBar*(stencil.first[0] - stencil.second[0]) + bBar*(stencil.first[1] - stencil.second[1])
+                            + aBar*(stencil.first[2] - stencil.second[2]));
+        rateBar[i] += bBar - cBar*stencil.first[0] - bBar*stencil.first[1] - aBar*stencil.first[2];
+    }
+}
+
+template <typename Real>
+BasicThetaScheme<Real>::BasicThetaScheme(std::size_t N, double dx, double dt, double theta)
+    : N(N), dx(dx), dt(dt), theta(theta), mesh(nullptr), operatorStorage(6 * N),
+      lower(nullptr), diag(nullptr), upper(nullptr), lower_next(nullptr), diag_next(nullptr), upper_next(nullptr),
+      sys_lower(N), sys_diag(N), sys_upper(N), rhs(N),
+      fac_lower(N), fac_diag(N), fac_upper(N), modLower(N), modUpper(N), invPivots(N), factored(false), factoredReversed(false), grownBuffers(0) {
+    assert(N >= 3);
+}
+
+template <typename Real>
+BasicThetaScheme<Real>::BasicThetaScheme(const SpaceTimeMesh& stm, double theta)
+    : BasicThetaScheme(stm.get_N(), stm.get_dx(), stm.get_dt(), theta) {
+    mesh = &stm;
+    if (!stm.isUniformX()) {
+        nonuniform_stencils(stm.getXNodes(), N, stencils);
+    }
+}
+
+template <typename Real>
+void BasicThetaScheme<Real>::reset(const SpaceTimeMesh& stm, double newTheta) {
+    reset(stm.get_N(), stm.get_dx(), stm.get_dt(), newTheta);
+    mesh = &stm;
+    if (!stm.isUniformX()) {
+        grownBuffers += stencils.capacity() < N;
+        nonuniform_stencils(stm.getXNodes(), N, stencils);
+    }
+}
+
+template <typename Real>
+template <typename T>
+void BasicThetaScheme<Real>::grow(std::vector<T>& buffer, std::size_t size) {
+    grownBuffers += buffer.capacity() < size;
+    buffer.resize(size);
+}
+
+template <typename Real>
+void BasicThetaScheme<Real>::reset(std::size_t newN, double newDx, double newDt, double newTheta) {
+    assert(newN >= 3);
+    if (newN != N) {
+        N = newN;
+        operatorStorage.assign(6 * N, 0);
+        for (std::vector<Real>* buffer : {&sys_lower, &sys_diag, &sys_upper, &rhs, &fac_lower, &fac_diag, &fac_upper, &modLower, &modUpper, &invPivots}) {
+            buffer->assign(N, 0);
+        }
+        revLower.clear();
+        revUpper.clear();
+        revInvPivots.clear();
+        factored = false;
+        factoredReversed = false;
+    }
+    dx = newDx;
+    dt = newDt;
+    theta = newTheta;
+    mesh = nullptr;
+    lower = diag = upper = nullptr;
+    lower_next = diag_next = upper_next = nullptr;
+}
+
+template <typename Real>
+void BasicThetaScheme<Real>::buildOperator(const double* vol, const double* rate) {
+    // write into the owned slot the explicit part isn't using
+    Real* slot = operatorStorage.data();
+    if (lower == slot) {
+        slot += 3 * N;
+    }
+    if (mesh && !mesh->isUniformX()) {
+        assemble_operator(vol, rate, stencils.data(), slot, slot + N, slot + 2 * N, N);
+    } else {
+        assemble_operator(vol, rate, static_cast<double>(dx), slot, slot + N, slot + 2 * N, N);
+    }
+    useOperator(slot, slot + N, slot + 2 * N);
+}
+
+template <typename Real>
+void BasicThetaScheme<Real>::useOperator(const Real* newLower, const Real* newDiag, const Real* newUpper) {
+    lower_next = lower;
+    diag_next = diag;
+    upper_next = upper;
+    lower = newLower;
+    diag = newDiag;
+    upper = newUpper;
+}
+
+template <typename Real>
+void BasicThetaScheme<Real>::prepareSystem(const BoundaryConditions& bc, std::size_t n) {
+    if (mesh) {
+        dt = mesh->get_dt(n);
+    }
+    const Real invDt = 1/dt;
+    std::size_t rowsCapacity = dirichletRows.capacity();
+    bc.collectSlice(n, N, dirichletRows);
+    grownBuffers += dirichletRows.capacity() != rowsCapacity;
+    // dirichlet rows (values already applied on the current slice) go through the same loop so that
+    // the comparison with the factored system is done in the same pass
+    std::size_t nextDirichlet = 0;
+    bool changed = !factored;
+    for (std::size_t i = 0; i < N; i++) {
+        Real l = theta*lower[i];
+        Real d = theta*diag[i] + invDt;
+        Real u = theta*upper[i];
+        if (nextDirichlet < dirichletRows.size() && dirichletRows[nextDirichlet] == i) {
+            l = 0;
+            d = 1;
+            u = 0;
+            nextDirichlet++;
+        }
+        changed = changed || l != fac_lower[i] || d != fac_diag[i] || u != fac_upper[i];
+        sys_lower[i] = l;
+        sys_diag[i] = d;
+        sys_upper[i] = u;
+    }
+    // constant coefficients (in time) give the same system at every step, the LU sweep is then done once
+    if (changed) {
+        fac_lower.swap(sys_lower);
+        fac_diag.swap(sys_diag);
+        fac_upper.swap(sys_upper);
+        factor_tridiagonal(fac_lower.data(), fac_diag.data(), fac_upper.data(), modLower.data(), modUpper.data(), invPivots.data(), N);
+        factored = true;
+        factoredReversed = false;
+    }
+}
+
+template <typename Real>
+void BasicThetaScheme<Real>::buildRhs(const double* next, const double* current) {
+    assert(lower_next != nullptr && factored);
+    const Real invDt = 1/dt;
+    const Real explicitWeight = 1 - theta;
+    rhs[0] = next[0]*invDt - explicitWeight*(diag_next[0]*next[0] + upper_next[0]*next[1]);
+    std::size_t i = 1;
+#if defined(__AVX2__)
+    if constexpr (std::is_same_v<Real, double>) {
+        const __m256d vInvDt = _mm256_set1_pd(invDt);
+        const __m256d vWeight = _mm256_set1_pd(explicitWeight);
+        for (; i + 4 < N; i += 4) {
+            __m256d left = _mm256_loadu_pd(next + i - 1);
+            __m256d middle = _mm256_loadu_pd(next + i);
+            __m256d right = _mm256_loadu_pd(next + i + 1);
+            __m256d applied = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(_mm256_loadu_pd(lower_next + i), left),
+                                                          _mm256_mul_pd(_mm256_loadu_pd(diag_next + i), middle)),
+                                            _mm256_mul_pd(_mm256_loadu_pd(upper_next + i), right));
+            _mm256_storeu_pd(rhs.data() + i, _mm256_sub_pd(_mm256_mul_pd(middle, vInvDt), _mm256_mul_pd(vWeight, applied)));
+        }
+    }
+#endif
+    for (; i + 1 < N; i++) {
+        rhs[i] = next[i]*invDt - explicitWeight*((lower_next[i]*next[i-1] + diag_next[i]*next[i]) + upper_next[i]*next[i+1]);
+    }
+    rhs[N-1] = next[N-1]*invDt - explicitWeight*(lower_next[N-1]*next[N-2] + diag_next[N-1]*next[N-1]);
+    for (std::size_t row : dirichletRows) {
+        rhs[row] = current[row];
+    }
+}
+
+template <typename Real>
+void BasicThetaScheme<Real>::solveSlice(const double* next, double* current) {
+    buildRhs(next, current);
+    substitute_tridiagonal(modLower.data(), modUpper.data(), invPivots.data(), rhs.data(), N);
+    std::copy(rhs.begin(), rhs.end(), current);
+}
+
+template <typename Real>
+std::size_t BasicThetaScheme<Real>::solveSliceProjected(const double* next, double* current, const double* obstacle, bool exerciseBelow) {
+    buildRhs(next, current);
+    std::size_t exercised;
+    if (exerciseBelow) {
+        if (!factoredReversed) {
+            grow(revLower, N);
+            grow(revUpper, N);
+            grow(revInvPivots, N);
+            factor_tridiagonal_reversed(fac_lower.data(), fac_diag.data(), fac_upper.data(), revLower.data(), revUpper.data(), revInvPivots.data(), N);
+            factoredReversed = true;
+        }
+        exercised = substitute_projected_below(revLower.data(), revUpper.data(), revInvPivots.data(), rhs.data(), obstacle, N);
+    } else {
+        exercised = substitute_projected_above(modLower.data(), modUpper.data(), invPivots.data(), rhs.data(), obstacle, N);
+    }
+    std::copy(rhs.begin(), rhs.end(), current);
+    return exercised;
+}
+
+template <typename Real>
+void BasicThetaScheme<Real>::step(const double* next, double* current, const BoundaryConditions& bc, std::size_t n) {
+    prepareSystem(bc, n);
+    solveSlice(next, current);
+}
+
+template void factor_tridiagonal<float>(const float*, const float*, const float*, float*, float*, float*, std::size_t);
+template void factor_tridiagonal<double>(const double*, const double*, const double*, double*, double*, double*, std::size_t);
+template void factor_tridiagonal<long double>(const long double*, const long double*, const long double*, long double*, long double*, long double*, std::size_t);
+template void substitute_tridiagonal<float>(const float*, const float*, const float*, float*, std::size_t);
+template void substitute_tridiagonal<double>(const double*, const double*, const double*, double*, std::size_t);
+template void substitute_tridiagonal<long double>(const long double*, const long double*, const long double*, long double*, std::size_t);
+template void solve_tridiagonal<float>(const float*, const float*, const float*, float*, float*, float*, float*, std::size_t);
+template void solve_tridiagonal<double>(const double*, const double*, const double*, double*, double*, double*, double*, std::size_t);
+template void solve_tridiagonal<long double>(const long double*, const long double*, const long double*, long double*, long double*, long double*, long double*, std::size_t);
+template void assemble_operator<float>(const double*, const double*, double, float*, float*, float*, std::size_t);
+template void assemble_operator<double>(const double*, const double*, double, double*, double*, double*, std::size_t);
+template void assemble_operator<long double>(const double*, const double*, double, long double*, long double*, long double*, std::size_t);
+template void assemble_operator<float>(const double*, const double*, const NonUniformStencil*, float*, float*, float*, std::size_t);
+template void assemble_operator<double>(const double*, const double*, const NonUniformStencil*, double*, double*, double*, std::size_t);
+template void assemble_operator<long double>(const double*, const double*, const NonUniformStencil*, long double*, long double*, long double*, std::size_t);
+template class BasicThetaScheme<float>;
+template class BasicThetaScheme<double>;
+template class BasicThetaScheme<long double>;
+
+PricingWorkspace::PricingWorkspace(std::size_t bytes) : memory(bytes), engineAllocations(0) {}
+
+PricingArena& PricingWorkspace::arena() {
+    return memory;
+}
+
+template <typename Real>
+BasicThetaScheme<Real>& PricingWorkspace::scheme(const SpaceTimeMesh& stm, double theta) {
+    std::optional<BasicThetaScheme<Real>>* slot;
+    if constexpr (std::is_same_v<Real, float>) {
+        slot = &singleScheme;
+    } else if constexpr (std::is_same_v<Real, double>) {
+        slot = &doubleScheme;
+    } else {
+        slot = &extendedScheme;
+    }
+    if (*slot) {
+        engineAllocations += (*slot)->size() != stm.get_N();
+        (*slot)->reset(stm, theta);
+    } else {
+        engineAllocations++;
+        slot->emplace(stm, theta);
     }
-    long double x = (C * E - B * F) / det;
-    long double y = (A * F - C * D) / det;
+    return **slot;
+}
+template BasicThetaScheme<float>& PricingWorkspace::scheme<float>(const SpaceTimeMesh&, double);
+template BasicThetaScheme<double>& PricingWorkspace::scheme<double>(const SpaceTimeMesh&, double);
+template BasicThetaScheme<long double>& PricingWorkspace::scheme<long double>(const SpaceTimeMesh&, double);
+
+void PricingWorkspace::reset() {
+    memory.reset();
+}
+
+std::size_t PricingWorkspace::allocations() const {
+    std::size_t grown = (singleScheme ? singleScheme->allocations() : 0) + (doubleScheme ? doubleScheme->allocations() : 0) +
+                        (extendedScheme ? extendedScheme->allocations() : 0);
+    return memory.allocations() + engineAllocations + grown;
+}
+
+namespace {
+template <typename Flags>
+void mark_exercise_slices(const Exercise& exercise, const SpaceTimeMesh& stm, Flags& slices) {
+    std::size_t last = stm.get_N_T() - 1;
+    slices.assign(stm.get_N_T(), false);
+    if (exercise.style == ExerciseStyle::American) {
+        std::fill(slices.begin(), slices.begin() + last, true);
+    } else if (exercise.style == ExerciseStyle::Bermudan) {
+        for (double date : exercise.dates) {
+            std::size_t nearest = 0;
+            for (std::size_t n = 1; n <= last; n++) {
+                if (std::abs(stm.getCoords(0, n).second - date) < std::abs(stm.getCoords(0, nearest).second - date)) {
+                    nearest = n;
+                }
+            }
+            slices[nearest] = nearest < last;
+        }
+    }
+}
+}
 
-    return {x, y};
+std::vector<bool> exercise_slices(const Exercise& exercise, const SpaceTimeMesh& stm) {
+    std::vector<bool> slices;
+    mark_exercise_slices(exercise, stm, slices);
+    return slices;
 }
 
 DiscretePricer::DiscretePricer(int N, int N_T, const Contract& contract, double sigma_0, const BoundaryConditions& volBC,
-                               const BoundaryConditions& rateBC, const BoundaryConditions& additionalBC, const SpaceTimeMesh& stm)
+                               const BoundaryConditions& rateBC, const BoundaryConditions& additionalBC, const SpaceTimeMesh& stm,
+                               PricingMode mode, PricingWorkspace* workspace)
     : N(N), N_T(N_T), contract(contract), sigma_0(sigma_0),
-      stm(stm),
-       contractPrices(stm), volBC(volBC), rateBC(rateBC), additionalBC(additionalBC),
-        current_theta(0.5), volApprox(stm), rateApprox(stm) {
+      stm(stm), volBC(volBC), rateBC(rateBC), additionalBC(additionalBC),
+        current_theta(0.5), mode(mode), workspace(workspace), firstSlices(AlignedAllocator<double>(arena())),
+        obstacle(AlignedAllocator<double>(arena())), exerciseSlices(AlignedAllocator<bool>(arena())),
+        exerciseBoundary(AlignedAllocator<double>(arena())), current_precision(SolverPrecision::Double), priced(false) {
             assert(stm.get_N() == N);
             assert(stm.get_N_T() == N_T);
-        volApprox.solve(volBC, contract.getUnderlying().getVolDynamics());
-        rateApprox.solve(rateBC, contract.getUnderlying().getRateDynamics());
+        if (mode == PricingMode::RollingSlices) {
+            return; // processes and boundaries are streamed slice by slice in price()
+        }
+        PRICER_COLLECT_STATS(stats, false);
+        {
+            PRICER_PHASE(PricingPhase::ProcessSolve);
+            volApprox.emplace(stm, arena());
+            rateApprox.emplace(stm, arena());
+            volApprox->solve(volBC, contract.getUnderlying().getVolDynamics());
+            rateApprox->solve(rateBC, contract.getUnderlying().getRateDynamics());
+        }
+        PRICER_PHASE(PricingPhase::BackwardSweep); // the price mesh, filled by the sweep
+        contractPrices.emplace(stm, arena());
         // boundary conditions (not payoff), in our case we suppose that it is x = x_0 = inf_{x_r\in mesh} x_r
-        contractPrices.applyBoundaryConditions(additionalBC);
+        contractPrices->applyBoundaryConditions(additionalBC);
         // other boundary condition which is the payoff hence f_0 and f^T are supposed available
-        for (std::size_t i = 0; i < N; i++) {
-            if (i == N-1 && std::abs(contractPrices.getMeshData(i, stm.get_N_T()-1) - contract.getPayoff()(std::exp(stm.getCoords(i, stm.get_N_T() - 1).first)))<10e-3){
-                std::cerr << "Warning, boundary condition x = inf x (f_0) and t=T (payoff) don't coincide, we take the value of payoff..."<<std::endl;
-            }
-            contractPrices.setMeshData(i,stm.get_N_T() - 1, contract.getPayoff()(std::exp(stm.getCoords(i, stm.get_N_T() - 1).first)));
-        }
-            
+        applyPayoff(contractPrices->getTimeSlice(stm.get_N_T() - 1).data());
+}
+
+PricingArena* DiscretePricer::arena() const {
+    return workspace ? &workspace->arena() : nullptr;
 }
 
+void DiscretePricer::applyPayoff(double* lastSlice) const {
+    double boundary = lastSlice[N-1];
+    contract.applyPayoff(stm, lastSlice);
+    if (std::abs(boundary - lastSlice[N-1])<10e-3){
+        std::cerr << "Warning, boundary condition x = inf x (f_0) and t=T (payoff) don't coincide, we take the value of payoff..."<<std::endl;
+    }
+}
 
-void DiscretePricer::price(double theta) {
+void DiscretePricer::price(double theta, SolverPrecision precision) {
     current_theta = theta;
+    current_precision = precision;
     assert(theta <= 1 && theta >= 0);
-    double dx = stm.get_dx();
-    double dt = stm.get_dt();
-    
-    
-    // det of f_1^T-1 , f_2^T-1 and subsequent f_1, f_2
-    
-    for (int n = static_cast<int> (stm.get_N_T() - 2); n>=0; n--){ // int cause size_t -- >=0 gets stuck at 0
-        long double a = -0.5*std::pow(volApprox.getVal(1, n),2)/(dx*dx) + 0.25*std::pow(volApprox.getVal(1, n),2)/(dx) - 0.5*rateApprox.getVal(1, n)/dx;
-        long double b = rateApprox.getVal(1, n)+std::pow(volApprox.getVal(1, n),2)/(dx*dx);
-        long double c = -0.5*std::pow(volApprox.getVal(1, n),2)/(dx*dx) - 0.25*std::pow(volApprox.getVal(1, n),2)/(dx) + 0.5*rateApprox.getVal(1, n)/dx;
-        long double A= a*theta;
-        long double B =(b*theta+1/dt);
-        long double C = contractPrices.getMeshData(1, n+1)/dt - c*contractPrices.getMeshData(0, n) -
-        (1-theta)*( a*contractPrices.getMeshData(2, n+1) + b*contractPrices.getMeshData(1, n+1) +c*contractPrices.getMeshData(0, n+1));
-        long double D = 0.5*std::pow(volApprox.getVal(1, n),2);
-        long double E = -(std::pow(volApprox.getVal(1, n),2)/(dx*dx) +(std::pow(volApprox.getVal(1, n),2) - rateApprox.getVal(1, n))/dx);
-        long double F = - (contractPrices.getMeshData(0, n+1) - contractPrices.getMeshData(0, n))/dt +(
-        rateApprox.getVal(1, n) - (0.5*std::pow(volApprox.getVal(1, n),2)/(dx*dx) + (0.5* std::pow(volApprox.getVal(1, n),2)-rateApprox.getVal(1, n))/dx))*
-        rateApprox.getVal(1, n);
-        auto p  = solve_Mx_b(A, B, C, D, E, F);
-        // std::cout<< n <<"  :  "<<C<< " ,  " << contractPrices.getMeshData(1, n+1) <<"   , " << contractPrices.getMeshData(2, n+1)<< std::endl;
-        contractPrices.setMeshData(2,n , p.first);
-        contractPrices.setMeshData(1,n , p.second);
-    }
-    
-    // det of rest
-    for (size_t i = 3; i<stm.get_N()-1; i++){
-        for (int n = static_cast<int> (stm.get_N_T() - 2); n>=0; n--){ // same
-            long double a = -0.5*std::pow(volApprox.getVal(i, n),2)/(dx*dx) + 0.25*std::pow(volApprox.getVal(i, n),2)/(dx) - 0.5*rateApprox.getVal(i, n)/dx;
-            long double b = rateApprox.getVal(i, n)+std::pow(volApprox.getVal(i, n),2)/(dx*dx);
-            long double c = -0.5*std::pow(volApprox.getVal(i, n),2)/(dx*dx) - 0.25*std::pow(volApprox.getVal(i, n),2)/(dx) + 0.5*rateApprox.getVal(i, n)/dx;
-            long double A= a*theta;
-            long double B =(b*theta+1/dt);
-            long double C = contractPrices.getMeshData(i, n+1)/dt - c*contractPrices.getMeshData(i, n) -
-            (1-theta)*( a*contractPrices.getMeshData(i+1, n+1) + b*contractPrices.getMeshData(i, n+1) +c*contractPrices.getMeshData(i-1, n+1));
-            long double D = 0.5*std::pow(volApprox.getVal(i, n),2);
-            long double E = -(std::pow(volApprox.getVal(i, n),2)/(dx*dx) +(std::pow(volApprox.getVal(i, n),2) - rateApprox.getVal(i, n))/dx);
-            long double F = - (contractPrices.getMeshData(i-1, n+1) - contractPrices.getMeshData(i-1, n))/dt +(
-            rateApprox.getVal(1, n) - (0.5*std::pow(volApprox.getVal(i, n),2)/(dx*dx) + (0.5* std::pow(volApprox.getVal(i, n),2)-rateApprox.getVal(i, n))/dx))*
-            rateApprox.getVal(i, n);
-            auto p  = solve_Mx_b(A, B, C, D, E, F);
-            // std::cout<< n <<"  :  "<<C<< " ,  " << contractPrices.getMeshData(1, n+1) <<"   , " << contractPrices.getMeshData(2, n+1)<< std::endl;
-            contractPrices.setMeshData(i,n , p.second);
-            if (i == stm.get_N() - 2){
-                contractPrices.setMeshData(i+1,n ,p.first);
-            }
+    PRICER_COLLECT_STATS(stats, true);
+    switch (precision) {
+    case SolverPrecision::Single: sweep<float>(theta); break;
+    case SolverPrecision::Double: sweep<double>(theta); break;
+    case SolverPrecision::Extended: sweep<long double>(theta); break;
+    }
+    priced = true;
+}
+
+template <typename Real>
+void DiscretePricer::sweep(double theta) {
+    PRICER_PHASE(PricingPhase::BackwardSweep);
+    std::size_t last = stm.get_N_T() - 1;
+    PRICER_COUNT_NODES(last * N, last * N * sizeof(double));
+    std::optional<BasicThetaScheme<Real>> ownScheme;
+    if (!workspace) {
+        ownScheme.emplace(stm, theta);
+    }
+    BasicThetaScheme<Real>& scheme = workspace ? workspace->scheme<Real>(stm, theta) : *ownScheme;
+    if (mode == PricingMode::RollingSlices) {
+        firstSlices.assign(2 * N, 0); // taken before the exercise buffers, which the pricer gives back first
+    }
+    if (contract.getExercise().style != ExerciseStyle::European) {
+        obstacle.resize(N);
+        contract.applyPayoff(stm, obstacle.data());
+        mark_exercise_slices(contract.getExercise(), stm, exerciseSlices);
+        exerciseBoundary.assign(N_T, std::nan(""));
+    }
+
+    if (mode == PricingMode::RollingSlices) {
+        // same sweep on the two slices kept for the greeks, the vol/rate slices are produced in the order the sweep
+        // reads them (buffers taken after the kept ones, so that an arena gets them back as soon as the sweep ends)
+        double* next = firstSlices.data() + (last % 2) * N;
+        double* current = firstSlices.data() + (1 - last % 2) * N;
+        RollingItoProcess vol(stm, volBC, contract.getUnderlying().getVolDynamics(), arena());
+        RollingItoProcess rate(stm, rateBC, contract.getUnderlying().getRateDynamics(), arena());
+        additionalBC.applySlice(stm, last, next);
+        applyPayoff(next);
+        scheme.buildOperator(vol.getSlice(last), rate.getSlice(last));
+        for (std::size_t n = last; n-- > 0;) {
+            additionalBC.applySlice(stm, n, current);
+            scheme.buildOperator(vol.getSlice(n), rate.getSlice(n));
+            stepSlice(scheme, next, current, n);
+            std::swap(next, current);
         }
+        // slice n went to half n % 2: t_0 first then t_1
+        return;
+    }
+
+    // backward sweep, one tridiagonal solve per time slice (payoff at t = T already in place)
+    const FunctionMesh& volMesh = volApprox->getProcessMesh();
+    const FunctionMesh& rateMesh = rateApprox->getProcessMesh();
+    scheme.buildOperator(volMesh.getTimeSlice(last).data(), rateMesh.getTimeSlice(last).data());
+    for (std::size_t n = last; n-- > 0;) {
+        scheme.buildOperator(volMesh.getTimeSlice(n).data(), rateMesh.getTimeSlice(n).data());
+        stepSlice(scheme, std::as_const(*contractPrices).getTimeSlice(n+1).data(), contractPrices->getTimeSlice(n).data(), n);
+    }
+}
+
+template <typename Real>
+void DiscretePricer::stepSlice(BasicThetaScheme<Real>& scheme, const double* next, double* current, std::size_t n) {
+    scheme.prepareSystem(additionalBC, n);
+    if (exerciseSlices.empty() || !exerciseSlices[n]) {
+        scheme.solveSlice(next, current);
+        return;
+    }
+    // payoff larger at x_0 than at x_{N-1}: exercised at low spots (puts), at high ones otherwise
+    bool below = obstacle[0] > obstacle[N - 1];
+    std::size_t exercised = scheme.solveSliceProjected(next, current, obstacle.data(), below);
+    if (exercised > 0) {
+        exerciseBoundary[n] = std::exp(stm.getCoords(below ? exercised - 1 : N - exercised, n).first);
+    }
+}
+PricingMode DiscretePricer::getMode() const{
+    return mode;
+}
+const PricingStats& DiscretePricer::getStats() const{
+    return stats;
+}
+void DiscretePricer::resetStats(){
+    stats = PricingStats();
+}
+std::size_t DiscretePricer::memoryFootprint() const{
+    std::size_t cells = firstSlices.size() + obstacle.size() + exerciseBoundary.size();
+    if (mode == PricingMode::FullGrid) {
+        cells += 3 * stm.get_N() * stm.get_N_T();
     }
+    return cells * sizeof(double);
 }
 const ItoProcess& DiscretePricer::getVolApprox() const{
-    return volApprox;
+    if (!volApprox) {
+        throw std::logic_error("vol process mesh isn't kept in rolling mode.");
+    }
+    return *volApprox;
 }
 const ItoProcess& DiscretePricer::getRateApprox() const{
-    return rateApprox;
+    if (!rateApprox) {
+        throw std::logic_error("rate process mesh isn't kept in rolling mode.");
+    }
+    return *rateApprox;
+}
+const FunctionMesh& DiscretePricer::getPriceMesh() const{
+    if (!contractPrices) {
+        throw std::logic_error("price mesh isn't kept in rolling mode.");
+    }
+    return *contractPrices;
+}
+PriceSurface DiscretePricer::getSurface() const{
+    return PriceSurface(stm, getPriceMesh());
+}
+const AlignedVector<double>& DiscretePricer::getExerciseBoundary() const{
+    return exerciseBoundary;
+}
+double DiscretePricer::priceAt(std::size_t i, std::size_t n) const{
+    if (mode == PricingMode::RollingSlices) {
+        assert(n < 2 && !firstSlices.empty());
+        return firstSlices[n * N + i];
+    }
+    return contractPrices->getMeshData(i, n);
 }
 double DiscretePricer::getPrice(){
-    return contractPrices.getMeshData(stm.get_N() / 2,0);
+    return priceAt(stm.get_N() / 2,0);
 }
 double DiscretePricer::delta() {
-    return (contractPrices.getMeshData(stm.get_N() / 2 + 1,0) - contractPrices.getMeshData(stm.get_N() / 2 - 1,0)) / (2*stm.get_dx());
+    std::size_t mid = stm.get_N() / 2;
+    if (!stm.isUniformX()) {
+        NonUniformStencil stencil(stm.getXNodes(), mid, stm.get_N());
+        return stencil.first[0]*priceAt(mid - 1,0) + stencil.first[1]*priceAt(mid,0) + stencil.first[2]*priceAt(mid + 1,0);
+    }
+    return (priceAt(stm.get_N() / 2 + 1,0) - priceAt(stm.get_N() / 2 - 1,0)) / (2*stm.get_dx());
 }
 
 double DiscretePricer::gamma() {
-    return (contractPrices.getMeshData(stm.get_N() / 2 + 1,0) + contractPrices.getMeshData(stm.get_N() / 2 - 1,0) - 2 * contractPrices.getMeshData(stm.get_N() / 2 ,0)) / (stm.get_dx() * stm.get_dx());
+    std::size_t mid = stm.get_N() / 2;
+    if (!stm.isUniformX()) {
+        NonUniformStencil stencil(stm.getXNodes(), mid, stm.get_N());
+        return stencil.second[0]*priceAt(mid - 1,0) + stencil.second[1]*priceAt(mid,0) + stencil.second[2]*priceAt(mid + 1,0);
+    }
+    return (priceAt(stm.get_N() / 2 + 1,0) + priceAt(stm.get_N() / 2 - 1,0) - 2 * priceAt(stm.get_N() / 2 ,0)) / (stm.get_dx() * stm.get_dx());
 }
 
 double DiscretePricer::theta() {
-    return (contractPrices.getMeshData(stm.get_N() / 2 ,0) - contractPrices.getMeshData(stm.get_N() / 2 ,1)) / stm.get_dt();
+    return (priceAt(stm.get_N() / 2 ,0) - priceAt(stm.get_N() / 2 ,1)) / stm.get_dt(0);
+}
+
+PricingResult DiscretePricer::getResult() {
+    return {getPrice(), delta(), gamma(), theta()};
+}
+
+void DiscretePricer::sweepBlock(ThetaScheme& scheme, const FunctionMesh& vol, const FunctionMesh& rate, std::size_t bottom, std::size_t top, double* slices) const {
+    scheme.reset(stm, current_theta);
+    scheme.buildOperator(vol.getTimeSlice(top).data(), rate.getTimeSlice(top).data());
+    for (std::size_t n = top; n-- > bottom;) {
+        double* current = slices + (n - bottom) * N;
+        additionalBC.applySlice(stm, n, current);
+        scheme.buildOperator(vol.getTimeSlice(n).data(), rate.getTimeSlice(n).data());
+        scheme.step(current + N, current, additionalBC, n);
+    }
+}
+
+PriceGradient DiscretePricer::priceGradient() {
+    if (contract.getExercise().style != ExerciseStyle::European) {
+        throw std::logic_error("the adjoint sweep doesn't handle early exercise.");
+    }
+    std::size_t last = stm.get_N_T() - 1;
+    double dx = stm.get_dx();
+    std::vector<NonUniformStencil> stencils = stm.isUniformX() ? std::vector<NonUniformStencil>() : nonuniform_stencils(stm.getXNodes(), N);
+    const NonUniformStencil* nodes = stm.isUniformX() ? nullptr : stencils.data();
+    double theta = current_theta;
+    std::optional<ItoProcess> ownVol, ownRate;
+    if (!volApprox) {
+        ownVol.emplace(stm);
+        ownRate.emplace(stm);
+        ownVol->solve(volBC, contract.getUnderlying().getVolDynamics());
+        ownRate->solve(rateBC, contract.getUnderlying().getRateDynamics());
+    }
+    const FunctionMesh& vol = (volApprox ? *volApprox : *ownVol).getProcessMesh();
+    const FunctionMesh& rate = (rateApprox ? *rateApprox : *ownRate).getProcessMesh();
+    auto assemble = [&](std::size_t n, double* lower, double* diag, double* upper) {
+        if (nodes) {
+            assemble_operator(vol.getTimeSlice(n).data(), rate.getTimeSlice(n).data(), nodes, lower, diag, upper, N);
+        } else {
+            assemble_operator(vol.getTimeSlice(n).data(), rate.getTimeSlice(n).data(), dx, lower, diag, upper, N);
+        }
+    };
+    auto assembleAdjoint = [&](std::size_t n, PriceGradient& gradient, const double* lowerBar, const double* diagBar, const double* upperBar) {
+        if (nodes) {
+            assemble_operator_adjoint(vol.getTimeSlice(n).data(), nodes, lowerBar, diagBar, upperBar,
+                                      gradient.vol.getTimeSlice(n).data(), gradient.rate.getTimeSlice(n).data(), N);
+        } else {
+            assemble_operator_adjoint(vol.getTimeSlice(n).data(), dx, lowerBar, diagBar, upperBar,
+                                      gradient.vol.getTimeSlice(n).data(), gradient.rate.getTimeSlice(n).data(), N);
+        }
+    };
+
+
+    // prices: the kept grid if price() filled it in double, otherwise checkpoints every stride slices
+    // (slot k holds slice k*stride, the last slot the payoff slice) and one block recomputed at a time
+    bool keptGrid = priced && contractPrices && current_precision == SolverPrecision::Double;
+    std::size_t stride = std::max<std::size_t>(1, static_cast<std::size_t>(std::ceil(std::sqrt(static_cast<double>(last)))));
+    std::vector<double> checkpoints, block;
+    auto checkpoint = [&](std::size_t n) { return checkpoints.data() + (n == last ? last / stride + 1 : n / stride) * N; };
+    ThetaScheme scheme(stm, theta);
+    if (!keptGrid) {
+        checkpoints.assign((last / stride + 2) * N, 0);
+        block.assign((stride + 1) * N, 0);
+        additionalBC.applySlice(stm, last, checkpoint(last));
+        applyPayoff(checkpoint(last));
+        for (std::size_t top = last; top > 0;) {
+            std::size_t bottom = ((top - 1) / stride) * stride;
+            std::copy(checkpoint(top), checkpoint(top) + N, block.data() + (top - bottom) * N);
+            sweepBlock(scheme, vol, rate, bottom, top, block.data());
+            std::copy(block.data(), block.data() + N, checkpoint(bottom));
+            top = bottom;
+        }
+    }
+
+    PriceGradient gradient{0, FunctionMesh(stm), FunctionMesh(stm), FunctionMesh(stm), std::vector<double>(N, 0)};
+    // adjoint of the prices at slice n, of the operator coefficients of slice n (complete) and n+1 (explicit part only)
+    std::vector<double> uBar(N, 0), uBarNext(N, 0), rBar(N, 0);
+    uBar[N / 2] = 1;
+    std::vector<double> opLower(N), opDiag(N), opUpper(N), opLowerNext(N), opDiagNext(N), opUpperNext(N);
+    std::vector<double> barLower(N, 0), barDiag(N, 0), barUpper(N, 0), barLowerNext(N, 0), barDiagNext(N, 0), barUpperNext(N, 0);
+    std::vector<double> tLower(N), tDiag(N), tUpper(N), modLower(N), modUpper(N), invPivots(N);
+    std::vector<double> fLower(N), fDiag(N), fUpper(N);
+    bool transposedFactored = false;
+    std::vector<std::size_t> dirichletRows;
+    assemble(0, opLower.data(), opDiag.data(), opUpper.data());
+
+    for (std::size_t bottom = 0; bottom < last; bottom += stride) {
+        std::size_t top = std::min(bottom + stride, last);
+        if (!keptGrid) {
+            std::copy(checkpoint(top), checkpoint(top) + N, block.data() + (top - bottom) * N);
+            sweepBlock(scheme, vol, rate, bottom, top, block.data());
+        }
+        for (std::size_t n = bottom; n < top; n++) {
+            const double* u = keptGrid ? contractPrices->getTimeSlice(n).data() : block.data() + (n - bottom) * N;
+            const double* uNext = keptGrid ? contractPrices->getTimeSlice(n + 1).data() : u + N;
+            if (n == 0) {
+                gradient.price = u[N / 2];
+            }
+            assemble(n + 1, opLowerNext.data(), opDiagNext.data(), opUpperNext.data());
+            double dt = stm.get_dt(n);
+
+            // transposed implicit system of step n: M^T rBar = uBar
+            additionalBC.collectSlice(n, stm.get_N(), dirichletRows);
+            for (std::size_t i = 0; i < stm.get_N(); i++) {
+                tDiag[i] = theta*opDiag[i] + 1/dt;
+                tLower[i] = i > 0 ? theta*opUpper[i-1] : 0;
+                tUpper[i] = i + 1 < stm.get_N() ? theta*opLower[i+1] : 0;
+            }
+            for (std::size_t row : dirichletRows) {
+                tDiag[row] = 1;
+                if (row + 1 < stm.get_N()) tLower[row + 1] = 0;
+                if (row > 0) tUpper[row - 1] = 0;
+            }
+            // same refactoring rule as the forward engine: only when the system changed
+            if (!transposedFactored || tLower != fLower || tDiag != fDiag || tUpper != fUpper) {
+                fLower.swap(tLower);
+                fDiag.swap(tDiag);
+                fUpper.swap(tUpper);
+                factor_tridiagonal(fLower.data(), fDiag.data(), fUpper.data(), modLower.data(), modUpper.data(), invPivots.data(), N);
+                transposedFactored = true;
+            }
+            std::copy(uBar.begin(), uBar.end(), rBar.begin());
+            substitute_tridiagonal(modLower.data(), modUpper.data(), invPivots.data(), rBar.data(), N);
+            // dirichlet rows take their value from the boundary, the others from the scheme
+            for (std::size_t row : dirichletRows) {
+                gradient.boundary.setMeshData(row, n, rBar[row]);
+                rBar[row] = 0;
+            }
+
+            for (std::size_t i = 0; i < stm.get_N(); i++) {
+                double implicitBar = -theta*rBar[i];
+                double explicitBar = -(1 - theta)*rBar[i];
+                barDiag[i] += implicitBar*u[i];
+                barDiagNext[i] += explicitBar*uNext[i];
+                if (i > 0) {
+                    barLower[i] += implicitBar*u[i-1];
+                    barLowerNext[i] += explicitBar*uNext[i-1];
+                }
+                if (i + 1 < stm.get_N()) {
+                    barUpper[i] += implicitBar*u[i+1];
+                    barUpperNext[i] += explicitBar*uNext[i+1];
+                }
+                double applied = opDiagNext[i]*rBar[i];
+                if (i + 1 < stm.get_N()) applied += opLowerNext[i+1]*rBar[i+1];
+                if (i > 0) applied += opUpperNext[i-1]*rBar[i-1];
+                uBarNext[i] = rBar[i]/dt - (1 - theta)*applied;
+            }
+
+            // slice n gets no more contributions
+            assembleAdjoint(n, gradient, barLower.data(), barDiag.data(), barUpper.data());
+            barLower.swap(barLowerNext);
+            barDiag.swap(barDiagNext);
+            barUpper.swap(barUpperNext);
+            std::fill(barLowerNext.begin(), barLowerNext.end(), 0);
+            std::fill(barDiagNext.begin(), barDiagNext.end(), 0);
+            std::fill(barUpperNext.begin(), barUpperNext.end(), 0);
+            opLower.swap(opLowerNext);
+            opDiag.swap(opDiagNext);
+            opUpper.swap(opUpperNext);
+            uBar.swap(uBarNext);
+        }
+    }
+    assembleAdjoint(last, gradient, barLower.data(), barDiag.data(), barUpper.data());
+    gradient.payoff = uBar;
+    return gradient;
+}
+
+double DiscretePricer::adjointVega() {
+    PriceGradient gradient = priceGradient();
+    double sum = 0;
+    for (std::size_t n = 0; n < stm.get_N_T(); n++) {
+        StridedView<const double> slice = std::as_const(gradient.vol).getTimeSlice(n);
+        for (std::size_t i = 0; i < slice.size(); i++) {
+            sum += slice[i];
+        }
+    }
+    return sum;
 }
 
 double DiscretePricer::vega(double d_sigma) {
@@ -116,45 +877,54 @@ double DiscretePricer::vega(double d_sigma) {
         return volBC.apply(x, y) + d_sigma;
     };
     BoundaryConditions volBC_perturbed(volBC, function_perturbed);
-    DiscretePricer perturbed(N, N_T, contract, sigma_0, volBC_perturbed, rateBC, additionalBC,stm);
-    perturbed.price(current_theta);
+    DiscretePricer perturbed(N, N_T, contract, sigma_0, volBC_perturbed, rateBC, additionalBC,stm, mode, workspace);
+    perturbed.price(current_theta, current_precision);
     return (perturbed.getPrice() - this->getPrice()) / d_sigma;
 }
 
-BlackScholesCallPricer::BlackScholesCallPricer(double S0, double K, double T, double r, double sigma)
-    : S0(S0), K(K), T(T), r(r), sigma(sigma), contractPrice(0) {}
-
-void BlackScholesCallPricer::price() {
-    double d1 = (log(S0 / K) + (r + 0.5 * sigma * sigma) * T) / (sigma * sqrt(T));
-    double d2 = d1 - sigma * sqrt(T);
+BlackScholesPricer::BlackScholesPricer(OptionType type, double S0, double K, double T, double r, double sigma)
+    : type(type), S0(S0), K(K), T(T), r(r), sigma(sigma), contractPrice(0), contractDelta(0), contractGamma(0), contractTheta(0),
+      contractVega(0), contractRho(0) {
+    price();
+}
 
-    contractPrice = S0 * norm_cdf(d1) - K * exp(-r * T) * norm_cdf(d2);
+void BlackScholesPricer::price() {
+    BlackScholesQuotes quote{&S0, &K, &T, &r, &sigma, 1};
+    black_scholes_batch(type, quote, {&contractPrice, &contractDelta, &contractGamma, &contractTheta, &contractVega, &contractRho});
 }
-double BlackScholesCallPricer::getPrice(){
+double BlackScholesPricer::getPrice(){
     return contractPrice;
 }
-double BlackScholesCallPricer::delta() {
-    double d1 = (log(S0 / K) + (r + 0.5 * sigma * sigma) * T) / (sigma * sqrt(T));
-    return norm_cdf(d1);
+double BlackScholesPricer::delta() {
+    return contractDelta;
+}
+
+double BlackScholesPricer::gamma() {
+    return contractGamma;
 }
 
-double BlackScholesCallPricer::gamma() {
-    double d1 = (log(S0 / K) + (r + 0.5 * sigma * sigma) * T) / (sigma * sqrt(T));
-    return exp(-0.5 * d1 * d1) / (S0 * sigma * sqrt(T) * sqrt(2 * M_PI));
+double BlackScholesPricer::theta() {
+    return contractTheta;
 }
 
-double BlackScholesCallPricer::theta() {
-    double d1 = (log(S0 / K) + (r + 0.5 * sigma * sigma) * T) / (sigma * sqrt(T));
-    double d2 = d1 - sigma * sqrt(T);
-    double term1 = -S0 * exp(-0.5 * d1 * d1) * sigma / (2 * sqrt(T) * sqrt(2 * M_PI));
-    double term2 = r * K * exp(-r * T) * norm_cdf(d2);
-    return term1 - term2;
+double BlackScholesPricer::vega() {
+    return contractVega;
 }
 
-double BlackScholesCallPricer::vega() {
-    double d1 = (log(S0 / K) + (r + 0.5 * sigma * sigma) * T) / (sigma * sqrt(T));
-    return S0 * sqrt(T) * exp(-0.5 * d1 * d1) / sqrt(2 * M_PI);
+double BlackScholesPricer::rho() {
+    return contractRho;
 }
+
+BlackScholesCallPricer::BlackScholesCallPricer(double S0, double K, double T, double r, double sigma)
+    : BlackScholesPricer(OptionType::Call, S0, K, T, r, sigma) {}
+
+BlackScholesPutPricer::BlackScholesPutPricer(double S0, double K, double T, double r, double sigma)
+    : BlackScholesPricer(OptionType::Put, S0, K, T, r, sigma) {}
+
 void DiscretePricer::logMesh(){
-    contractPrices.logMesh();
+    if (mode == PricingMode::RollingSlices) {
+        logMatrix(firstSlices.data(), stm.get_N(), firstSlices.size() / stm.get_N());
+        return;
+    }
+    contractPrices->logMesh();
 }
@@ -1,9 +1,172 @@
 #pragma once
 #include "Asset.hpp"
+#include "BlackScholes.hpp"
 #include "MeshUtils.hpp"
+#include "PriceSurface.hpp"
+#include <cmath>
+#include <optional>
 
 double norm_cdf(double x);
-std::pair<long double,long double> solve_Mx_b(long double& A, long double& B, long double& C, long double& D, long double& E, long double& F);
+// Thomas algorithm for lower[i]*u[i-1] + diag[i]*u[i] + upper[i]*u[i+1] = rhs[i], i in [0, n)
+// factor: LU sweep storing the inverse pivots and the lower/upper coefficients scaled by them (reusable while the matrix doesn't change)
+// substitute: forward/backward substitution with one multiply-add per row, rhs is overwritten with the solution
+// (defined for Real = float, double, long double)
+template <typename Real>
+void factor_tridiagonal(const Real* lower, const Real* diag, const Real* upper, Real* modLower, Real* modUpper, Real* invPivots, std::size_t n);
+template <typename Real>
+void substitute_tridiagonal(const Real* modLower, const Real* modUpper, const Real* invPivots, Real* rhs, std::size_t n);
+template <typename Real>
+void solve_tridiagonal(const Real* lower, const Real* diag, const Real* upper, Real* rhs, Real* modLower, Real* modUpper, Real* invPivots, std::size_t n);
+
+// weights of u_{i-1}, u_i, u_{i+1} in the first and second derivatives at node i of the nodes x[0..N)
+// (three point differences, the edges use a ghost node at the spacing of the edge)
+struct NonUniformStencil {
+    double below; // x_i - x_{i-1}
+    double above; // x_{i+1} - x_i
+    double first[3];
+    double second[3];
+    NonUniformStencil(const double* x, std::size_t i, std::size_t N);
+};
+std::vector<NonUniformStencil> nonuniform_stencils(const double* x, std::size_t N);
+void nonuniform_stencils(const double* x, std::size_t N, std::vector<NonUniformStencil>& stencils); // in place, its capacity reused
+
+// closed log-space generator of one slice (a: upper, b: diag, c: lower), edges closed with zero gamma ghost nodes
+// from sigma^2 and the drift r - sigma^2/2 of every node, 4 nodes per AVX2 instruction for doubles when available
+template <typename Real>
+void assemble_operator(const double* vol, const double* rate, double dx, Real* lower, Real* diag, Real* upper, std::size_t N);
+// same on stretched nodes, from the stencils of every node (nonuniform_stencils)
+template <typename Real>
+void assemble_operator(const double* vol, const double* rate, const NonUniformStencil* stencils, Real* lower, Real* diag, Real* upper, std::size_t N);
+
+// reverse mode of assemble_operator (double only): from the gradient of a scalar with respect to the assembled
+// coefficients of every row (closed edges included), accumulates its gradient with respect to vol and rate (the
+// coefficients are linear in the rate, so only the vols are read)
+void assemble_operator_adjoint(const double* vol, double dx, const double* lowerBar, const double* diagBar,
+                               const double* upperBar, double* volBar, double* rateBar, std::size_t N);
+void assemble_operator_adjoint(const double* vol, const NonUniformStencil* stencils, const double* lowerBar, const double* diagBar,
+                               const double* upperBar, double* volBar, double* rateBar, std::size_t N);
+
+// arithmetic the time stepping is carried out in (meshes stay in double; see BasicFunctionMesh, BasicItoProcess and
+// MixedBatchPricer for float storage). Price error of an ATM call against BlackScholesCallPricer, N = 2*N_T, Crank-Nicolson:
+//   N          201      401      801      1601
+//   Single     2.2e-3   9.9e-4   1.5e-3   1.4e-2   (float round-off grows with N_T and 1/dx^2)
+//   Double     2.2e-3   5.6e-4   1.4e-4   3.5e-5   (second order)
+//   Extended   same as Double to the digits shown
+//   Mixed      same as Double within 2e-7 (MixedBatchPricer: float processes, double operators and sweep)
+enum class SolverPrecision { Single, Double, Extended };
+
+// time stepping engine of the theta scheme: for each time slice it builds the tridiagonal operator
+// of the log-space generator and solves for the previous slice
+template <typename Real>
+class BasicThetaScheme {
+private:
+    std::size_t N;
+    Real dx;
+    Real dt;
+    Real theta;
+    const SpaceTimeMesh* mesh; // when set: its nodes for the operator and its time step at every prepareSystem
+    std::vector<NonUniformStencil> stencils; // of a stretched mesh
+    // owned room for two assembled operators, the ones in use may also be precomputed elsewhere
+    std::vector<Real> operatorStorage;
+    // operator at slice n (implicit part) and n+1 (explicit part)
+    const Real* lower;
+    const Real* diag;
+    const Real* upper;
+    const Real* lower_next;
+    const Real* diag_next;
+    const Real* upper_next;
+    // system actually solved and its factorization (kept as long as the system doesn't change)
+    std::vector<Real> sys_lower, sys_diag, sys_upper, rhs;
+    std::vector<Real> fac_lower, fac_diag, fac_upper, modLower, modUpper, invPivots;
+    // same system eliminated from the last row down (projected solves with the exercise region at x_0), made on demand
+    std::vector<Real> revLower, revUpper, revInvPivots;
+    std::vector<std::size_t> dirichletRows;
+    bool factored;
+    bool factoredReversed;
+    std::size_t grownBuffers; // heap growths of the buffers sized on use (stencils, reversed factorization, dirichlet rows)
+
+    template <typename T>
+    void grow(std::vector<T>& buffer, std::size_t size);
+    void buildRhs(const double* next, const double* current);
+
+public:
+    BasicThetaScheme(std::size_t N, double dx, double dt, double theta);
+    // spacings taken from the mesh, stretched or not (has to outlive the sweeps)
+    BasicThetaScheme(const SpaceTimeMesh& stm, double theta);
+    BasicThetaScheme(const BasicThetaScheme&) = delete; // operator pointers may point into operatorStorage
+    BasicThetaScheme& operator=(const BasicThetaScheme&) = delete;
+    BasicThetaScheme(BasicThetaScheme&&) = default;
+    // reuse the buffers for another sweep, the factorization is kept as long as prepareSystem finds the same system
+    void reset(std::size_t N, double dx, double dt, double theta);
+    void reset(const SpaceTimeMesh& stm, double theta);
+    // assemble the operator of slice n, the previous one becomes the explicit part of the next step
+    void buildOperator(const double* vol, const double* rate);
+    // same with an operator assembled beforehand (not copied, has to outlive the next two steps)
+    void useOperator(const Real* lower, const Real* diag, const Real* upper);
+    // implicit matrix of slice n with its dirichlet rows (step t_{n+1} - t_n with a mesh), refactored only if it changed
+    void prepareSystem(const BoundaryConditions& bc, std::size_t n);
+    // next: prices at n+1, current: prices at n (dirichlet values already applied), any number of times per prepared system
+    void solveSlice(const double* next, double* current);
+    // same under the early exercise constraint current >= obstacle (Brennan-Schwartz): the elimination runs away from
+    // the exercise region (x_0 side when exerciseBelow, e.g. puts, the x_{N-1} side otherwise, e.g. calls) and the
+    // substitution comes back from it, projecting every node on the obstacle on its way, O(N) like solveSlice.
+    // Exact when the exercise region is one run of nodes at that edge; returns its length (0: no node exercised)
+    std::size_t solveSliceProjected(const double* next, double* current, const double* obstacle, bool exerciseBelow);
+    void step(const double* next, double* current, const BoundaryConditions& bc, std::size_t n);
+    std::size_t size() const { return N; }
+    // buffers grown on use since construction (a new N regrows the others too, at reset)
+    std::size_t allocations() const { return grownBuffers; }
+};
+
+using ThetaScheme = BasicThetaScheme<double>;
+
+// memory the pricings of one thread run on, sized by the first jobs then reused: a DiscretePricer built on it takes
+// its meshes and slices from the arena (given back when the pricer is destroyed) and its solver engine from the
+// workspace, so that jobs of sizes already seen allocate nothing. Reset between jobs, once their pricers are gone.
+class PricingWorkspace {
+private:
+    PricingArena memory;
+    std::optional<BasicThetaScheme<float>> singleScheme;
+    std::optional<BasicThetaScheme<double>> doubleScheme;
+    std::optional<BasicThetaScheme<long double>> extendedScheme;
+    std::size_t engineAllocations;
+
+public:
+    explicit PricingWorkspace(std::size_t bytes = 0); // arena block to start with
+    PricingArena& arena();
+    // engine of the given precision, reset for the mesh and theta (its buffers rebuilt only for another N)
+    template <typename Real>
+    BasicThetaScheme<Real>& scheme(const SpaceTimeMesh& stm, double theta);
+    // merges the arena blocks of the jobs so far into one, std::logic_error while a pricer still borrows from it
+    void reset();
+    std::size_t allocations() const; // heap allocations since construction: arena blocks, engine buffers (re)built or grown
+};
+
+// price and greeks at S0 on the t = 0 slice (greeks in x = log S, like DiscretePricer)
+struct PricingResult {
+    double price;
+    double delta;
+    double gamma;
+    double theta;
+};
+
+// gradient of the price (node N/2 of t_0) with respect to every input of the backward sweep, grids indexed like the meshes (x_i, t_n)
+struct PriceGradient {
+    double price;
+    FunctionMesh vol; // d price / d sigma(x_i, t_n), bucketed vega
+    FunctionMesh rate; // d price / d r(x_i, t_n), bucketed rho
+    FunctionMesh boundary; // d price / d additional boundary value, 0 off the frontier and on the payoff slice
+    std::vector<double> payoff; // d price / d payoff(x_i)
+};
+
+// slices the holder may exercise on before maturity: every one for American, the one nearest to each date for
+// Bermudan (a date at maturity adds nothing, the payoff is already there), none for European
+std::vector<bool> exercise_slices(const Exercise& exercise, const SpaceTimeMesh& stm);
+
+// FullGrid keeps every slice of the prices and of the vol/rate processes,
+// RollingSlices only keeps the slices in flight and ends with t_0 and t_1 (enough for the price and greeks)
+enum class PricingMode { FullGrid, RollingSlices };
+
 class DiscretePricer {
 private:
     int N;
@@ -14,38 +177,91 @@ private:
     const BoundaryConditions& rateBC;
     
     double current_theta;
-    ItoProcess volApprox;
-    ItoProcess rateApprox;
+    PricingMode mode;
+    std::optional<ItoProcess> volApprox; // FullGrid only
+    std::optional<ItoProcess> rateApprox; // FullGrid only
     const SpaceTimeMesh& stm;
-    FunctionMesh contractPrices;
+    std::optional<FunctionMesh> contractPrices; // FullGrid only
+    PricingWorkspace* workspace;
+    AlignedVector<double> firstSlices; // RollingSlices only: prices at t_0 then t_1, the two slices the sweep rolls over
+    // early exercise only: payoff at every node, slices where it may be exercised, S* of every slice
+    AlignedVector<double> obstacle;
+    std::vector<bool, AlignedAllocator<bool>> exerciseSlices;
+    AlignedVector<double> exerciseBoundary;
+
+    SolverPrecision current_precision;
+    bool priced; // set by price(): until then contractPrices only holds the boundaries and the payoff
+    PricingStats stats;
+
+    void applyPayoff(double* lastSlice) const;
+    PricingArena* arena() const; // the workspace's, nullptr without one (heap)
+    double priceAt(std::size_t i, std::size_t n) const;
+    template <typename Real>
+    void sweep(double theta);
+    // one step of the sweep, projected on the payoff on the exercise slices
+    template <typename Real>
+    void stepSlice(BasicThetaScheme<Real>& scheme, const double* next, double* current, std::size_t n);
+    // prices from slice top (given) down to slice bottom, slices[(n - bottom)*N] for n in [bottom, top]
+    void sweepBlock(ThetaScheme& scheme, const FunctionMesh& vol, const FunctionMesh& rate, std::size_t bottom, std::size_t top, double* slices) const;
 
 public:
     const BoundaryConditions& additionalBC;
     DiscretePricer(int N, int N_T, const Contract& contract, double sigma_0, const BoundaryConditions& volBC,
-                   const BoundaryConditions& driftBC, const BoundaryConditions& additionalBC, const SpaceTimeMesh& stm);
+                   const BoundaryConditions& driftBC, const BoundaryConditions& additionalBC, const SpaceTimeMesh& stm,
+                   PricingMode mode = PricingMode::FullGrid, PricingWorkspace* workspace = nullptr);
 
-    void price(double theta);
-    const ItoProcess& getVolApprox() const;
-    const ItoProcess& getRateApprox() const;
+    // workspace given to the constructor: the meshes and slices are borrowed from it for the lifetime of the pricer
+    // (vega's bumped pricing included), the engine is the workspace's
+    void price(double theta, SolverPrecision precision = SolverPrecision::Double);
+    PricingMode getMode() const;
+    std::size_t memoryFootprint() const; // bytes held by the meshes/slices kept after pricing
+    // time and counters of every phase since construction (the FullGrid processes are solved there) or the last reset,
+    // all zero unless built with PRICER_INSTRUMENTATION; StatsRegistry::global() aggregates every pricer
+    const PricingStats& getStats() const;
+    void resetStats();
+    const ItoProcess& getVolApprox() const; // FullGrid only
+    const ItoProcess& getRateApprox() const; // FullGrid only
+    const FunctionMesh& getPriceMesh() const; // FullGrid only, prices of the last pricing
+    // every node of the last pricing as an interpolated surface in (S, t) (FullGrid only)
+    PriceSurface getSurface() const;
+    // exercise boundary of the last pricing, spot S*(t_n) of every slice: the highest exercised node when the exercise
+    // region is at x_0 (puts), the lowest one otherwise (calls), NaN where nothing is exercised (and at maturity).
+    // Empty for European contracts
+    const AlignedVector<double>& getExerciseBoundary() const;
     double getPrice();
     double delta();
     double gamma();
     double theta();
     double vega(double d_sigma =10e-3);
+    PricingResult getResult();
+    // adjoint (reverse mode) sweep: every bucketed sensitivity for about two pricings, in double precision, European only (std::logic_error otherwise).
+    // prices are recomputed from sqrt(N_T) checkpoints unless the full double grid is kept (at most 2 sqrt(N_T) slices held),
+    // the vol/rate process grids are solved if the pricer doesn't keep them
+    PriceGradient priceGradient();
+    // parallel shift of the whole vol surface, sum of the bucketed vegas (equals vega() when the vol process moves with its boundary values, e.g. constant dynamics)
+    double adjointVega();
     void logMesh();
 };
 
-class BlackScholesCallPricer {
+// closed form european option, price and greeks computed together by black_scholes_batch on price()
+class BlackScholesPricer {
 private:
+    OptionType type;
     double S0;
     double K;
     double T;
     double r;
     double sigma;
     double contractPrice;
+    double contractDelta;
+    double contractGamma;
+    double contractTheta;
+    double contractVega;
+    double contractRho;
 
 public:
-    BlackScholesCallPricer(double S0, double K, double T, double r, double sigma);
+    // quotes at construction, the greeks are valid without calling price()
+    BlackScholesPricer(OptionType type, double S0, double K, double T, double r, double sigma);
 
     void price();
     double getPrice();
@@ -53,6 +269,16 @@ public:
     double gamma();
     double theta();
     double vega();
-    
+    double rho();
+};
+
+class BlackScholesCallPricer : public BlackScholesPricer {
+public:
+    BlackScholesCallPricer(double S0, double K, double T, double r, double sigma);
+};
+
+class BlackScholesPutPricer : public BlackScholesPricer {
+public:
+    BlackScholesPutPricer(double S0, double K, double T, double r, double sigma);
 };
 
@@ -0,0 +1,91 @@
+#include "PricingArena.hpp"
+#include <algorithm>
+#include <cassert>
+#include <new>
+#include <stdexcept>
+
+namespace {
+std::size_t rounded(std::size_t bytes) {
+    return (bytes + PricingArena::Alignment - 1) / PricingArena::Alignment * PricingArena::Alignment;
+}
+}
+
+PricingArena::PricingArena(std::size_t bytes) : used(0), usedBefore(0), borrowedBytes(0), peak(0), heapAllocations(0) {
+    if (bytes > 0) {
+        addBlock(rounded(bytes));
+    }
+}
+
+PricingArena::~PricingArena() {
+    releaseBlocks();
+}
+
+void PricingArena::addBlock(std::size_t bytes) {
+    if (!blocks.empty()) {
+        usedBefore += used;
+    }
+    blocks.push_back({static_cast<std::byte*>(::operator new(bytes, std::align_val_t(Alignment))), bytes});
+    used = 0;
+    heapAllocations++;
+}
+
+void PricingArena::releaseBlocks() {
+    for (const Block& block : blocks) {
+        ::operator delete(block.data, std::align_val_t(Alignment));
+    }
+    blocks.clear();
+}
+
+void* PricingArena::allocate(std::size_t bytes) {
+    bytes = rounded(std::max<std::size_t>(bytes, 1));
+    if (blocks.empty() || used + bytes > blocks.back().size) {
+        // doubling keeps the number of blocks of a first job logarithmic
+        addBlock(std::max(bytes, blocks.empty() ? bytes : 2 * blocks.back().size));
+    }
+    void* p = blocks.back().data + used;
+    used += bytes;
+    borrowedBytes += bytes;
+    peak = std::max(peak, usedBefore + used);
+    return p;
+}
+
+void PricingArena::deallocate(void* p, std::size_t bytes) {
+    bytes = rounded(std::max<std::size_t>(bytes, 1));
+    assert(borrowedBytes >= bytes);
+    borrowedBytes -= bytes;
+    if (!blocks.empty() && static_cast<std::byte*>(p) + bytes == blocks.back().data + used) {
+        used -= bytes;
+    }
+}
+
+void PricingArena::reset() {
+    if (borrowedBytes > 0) {
+        throw std::logic_error("arena reset while buffers are still borrowed.");
+    }
+    if (blocks.size() > 1) {
+        releaseBlocks();
+        addBlock(peak);
+    }
+    used = 0;
+    usedBefore = 0;
+}
+
+std::size_t PricingArena::allocations() const {
+    return heapAllocations;
+}
+
+std::size_t PricingArena::capacity() const {
+    std::size_t bytes = 0;
+    for (const Block& block : blocks) {
+        bytes += block.size;
+    }
+    return bytes;
+}
+
+std::size_t PricingArena::borrowed() const {
+    return borrowedBytes;
+}
+
+std::size_t PricingArena::highWater() const {
+    return peak;
+}
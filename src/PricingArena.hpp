@@ -0,0 +1,41 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+// bump allocator the buffers of a pricing are carved from (not thread safe: one per thread). Blocks are 64-byte
+// aligned and every buffer is rounded up to 64 bytes; a buffer given back last-in first-out frees its bytes at once,
+// the others when the arena is reset. A buffer that doesn't fit adds a block (a heap allocation); reset() then
+// merges the blocks into one that holds the largest job seen so far, so repeating the same jobs allocates nothing.
+class PricingArena {
+private:
+    struct Block {
+        std::byte* data;
+        std::size_t size;
+    };
+    std::vector<Block> blocks; // the last one is the one being filled
+    std::size_t used; // bytes used in the last block
+    std::size_t usedBefore; // bytes used in the full blocks before it
+    std::size_t borrowedBytes; // handed out and not given back yet
+    std::size_t peak; // most bytes used at once (usedBefore + used) since construction
+    std::size_t heapAllocations;
+
+    void addBlock(std::size_t bytes);
+    void releaseBlocks();
+
+public:
+    static constexpr std::size_t Alignment = 64;
+
+    explicit PricingArena(std::size_t bytes = 0); // first block, none when 0
+    ~PricingArena();
+    PricingArena(const PricingArena&) = delete;
+    PricingArena& operator=(const PricingArena&) = delete;
+
+    void* allocate(std::size_t bytes);
+    void deallocate(void* p, std::size_t bytes);
+    // gives every block back at once, std::logic_error while buffers are still borrowed (pricers alive on the arena)
+    void reset();
+    std::size_t allocations() const; // heap allocations (blocks) since construction
+    std::size_t capacity() const; // bytes of the blocks
+    std::size_t borrowed() const; // bytes handed out and not given back
+    std::size_t highWater() const; // most bytes in use at once since construction
+};
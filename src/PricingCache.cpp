@@ -0,0 +1,206 @@
+#include "PricingCache.hpp"
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+std::uint64_t word_of(double value) {
+    std::uint64_t word;
+    value += 0.0; // -0 and +0 alike
+    std::memcpy(&word, &value, sizeof(word));
+    return word;
+}
+
+// length then the bytes, zero padded to whole words
+void append_identity(std::vector<std::uint64_t>& words, const std::string& identity) {
+    words.push_back(identity.size());
+    std::size_t first = words.size();
+    words.resize(first + (identity.size() + 7) / 8, 0);
+    std::memcpy(words.data() + first, identity.data(), identity.size());
+}
+
+// false when the dynamics have no value identity (std::function, lambdas): nothing identifies what they compute
+bool append_dynamics(std::vector<std::uint64_t>& words, const ItoDynamics& dynamics, std::string& identity) {
+    const DynamicsKernel* kernel = dynamics.getKernel();
+    identity.clear();
+    if (!kernel || !kernel->appendIdentity(identity)) {
+        return false;
+    }
+    append_identity(words, identity);
+    return true;
+}
+
+// frontier nodes of every slice inside the mesh and the values written there, clipped like applySlice
+void append_boundary(std::vector<std::uint64_t>& words, const BoundaryConditions& bc, const SpaceTimeMesh& stm, std::vector<double>& slice,
+                     std::vector<std::size_t>& rows) {
+    for (std::size_t n = 0; n < stm.get_N_T(); n++) {
+        bc.collectSlice(n, stm.get_N(), rows);
+        words.push_back(rows.size());
+        if (rows.empty()) {
+            continue;
+        }
+        bc.applySlice(stm, n, slice.data());
+        for (std::size_t x : rows) {
+            words.push_back(x);
+            words.push_back(word_of(slice[x]));
+        }
+    }
+}
+
+std::uint64_t fx_round(std::uint64_t h, std::uint64_t word) {
+    return (((h << 5) | (h >> 59)) ^ word) * 0x517cc1b727220a95ull;
+}
+
+// one multiply per word (FxHash rounds on four independent lanes) and a splitmix64 finalizer,
+// exact comparison of the words does the rest
+std::uint64_t hash_words(const std::vector<std::uint64_t>& words) {
+    std::uint64_t lanes[4] = {words.size(), 1, 2, 3};
+    std::size_t k = 0;
+    for (; k + 4 <= words.size(); k += 4) {
+        for (std::size_t l = 0; l < 4; l++) {
+            lanes[l] = fx_round(lanes[l], words[k + l]);
+        }
+    }
+    for (; k < words.size(); k++) {
+        lanes[0] = fx_round(lanes[0], words[k]);
+    }
+    std::uint64_t h = fx_round(fx_round(fx_round(lanes[0], lanes[1]), lanes[2]), lanes[3]);
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ull;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebull;
+    return h ^ (h >> 31);
+}
+}
+
+PricingKey::PricingKey(const PricingJob& job) {
+    const SpaceTimeMesh& stm = job.stm;
+    std::size_t N = stm.get_N();
+    std::size_t N_T = stm.get_N_T();
+    words.reserve(3 * N + 3 * N_T + 2 * (job.volBC.size() + job.rateBC.size() + job.additionalBC.size()) + 64);
+    words.push_back(N);
+    words.push_back(N_T);
+    // a uniform axis is given by its ends
+    words.push_back(stm.isUniformX());
+    for (std::size_t i = 0; i < N; i += stm.isUniformX() ? N - 1 : 1) {
+        words.push_back(word_of(stm.getXNodes()[i]));
+    }
+    words.push_back(stm.isUniformT());
+    for (std::size_t n = 0; n < N_T; n += stm.isUniformT() ? N_T - 1 : 1) {
+        words.push_back(word_of(stm.getCoords(0, n).second));
+    }
+    words.push_back(word_of(job.theta));
+    words.push_back(static_cast<std::uint64_t>(job.precision));
+    words.push_back(word_of(job.sigma_0));
+
+    const Contract& contract = job.contract;
+    words.push_back(word_of(contract.getUnderlying().getS0()));
+    words.push_back(word_of(contract.getMaturity()));
+    std::string identity;
+    if (!append_dynamics(words, contract.getUnderlying().getVolDynamics(), identity) ||
+        !append_dynamics(words, contract.getUnderlying().getRateDynamics(), identity)) {
+        cacheable = false;
+        words.clear();
+        hash = 0;
+        return;
+    }
+    // the payoff tabulated on the maturity slice: the sweep only reads it on the nodes (the early exercise obstacle too)
+    std::vector<double> slice(N);
+    contract.applyPayoff(stm, slice.data());
+    for (double value : slice) {
+        words.push_back(word_of(value));
+    }
+    const Exercise& exercise = contract.getExercise();
+    words.push_back(static_cast<std::uint64_t>(exercise.style));
+    words.push_back(exercise.dates.size());
+    for (double date : exercise.dates) {
+        words.push_back(word_of(date));
+    }
+    std::vector<std::size_t> rows;
+    for (const BoundaryConditions* bc : {&job.volBC, &job.rateBC, &job.additionalBC}) {
+        append_boundary(words, *bc, stm, slice, rows);
+    }
+    hash = hash_words(words);
+}
+
+PricingCache::PricingCache(std::size_t capacity) : capacity(capacity) {
+    if (capacity == 0) {
+        throw std::invalid_argument("pricing cache: capacity must be positive.");
+    }
+}
+
+std::list<PricingCache::Entry>::iterator PricingCache::lookup(const PricingKey& key) {
+    auto range = index.equal_range(key.hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second->key == key) {
+            return it->second;
+        }
+    }
+    return entries.end();
+}
+
+std::optional<PricingResult> PricingCache::find(const PricingKey& key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto entry = lookup(key);
+    if (entry == entries.end()) {
+        stats.misses++;
+        return std::nullopt;
+    }
+    stats.hits++;
+    entries.splice(entries.begin(), entries, entry);
+    return entry->result;
+}
+
+void PricingCache::insert(const PricingKey& key, const PricingResult& result) {
+    if (!key.cacheable) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    auto entry = lookup(key);
+    if (entry != entries.end()) {
+        entry->result = result;
+        entries.splice(entries.begin(), entries, entry);
+        return;
+    }
+    entries.push_front({key, result});
+    index.emplace(key.hash, entries.begin());
+    while (entries.size() > capacity) {
+        auto oldest = std::prev(entries.end());
+        auto range = index.equal_range(oldest->key.hash);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second == oldest) {
+                index.erase(it);
+                break;
+            }
+        }
+        entries.pop_back();
+        stats.evictions++;
+    }
+}
+
+PricingResult PricingCache::price(const PricingJob& job, PricingWorkspace* workspace) {
+    PricingKey key(job);
+    if (std::optional<PricingResult> cached = find(key)) {
+        return *cached;
+    }
+    DiscretePricer pricer(job.stm.get_N(), job.stm.get_N_T(), job.contract, job.sigma_0, job.volBC, job.rateBC, job.additionalBC, job.stm,
+                          PricingMode::RollingSlices, workspace);
+    pricer.price(job.theta, job.precision);
+    PricingResult result = pricer.getResult();
+    insert(key, result);
+    return result;
+}
+
+PricingCacheStats PricingCache::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    PricingCacheStats current = stats;
+    current.size = entries.size();
+    return current;
+}
+
+std::size_t PricingCache::getCapacity() const {
+    return capacity;
+}
+
+void PricingCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    index.clear();
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include "PricingPool.hpp"
+#include "ValueIdentity.hpp"
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// canonical description of a pricing job: everything the sweep reads, as 64 bit words (exact comparison) and their hash.
+// The mesh nodes, theta, precision, sigma_0, S0, the maturity, the exercise, the payoff tabulated on the maturity slice
+// and every boundary condition tabulated on its frontier enter by value. The dynamics enter by value when their type
+// has a ValueIdentity (ConstantDynamics); any other dynamics leave the key not cacheable: it equals no key, itself
+// included, and the cache prices such a job every time
+struct PricingKey {
+    std::vector<std::uint64_t> words;
+    std::uint64_t hash;
+    bool cacheable = true;
+
+    explicit PricingKey(const PricingJob& job);
+    bool operator==(const PricingKey& other) const {
+        return cacheable && other.cacheable && hash == other.hash && words == other.words;
+    }
+};
+
+struct PricingCacheStats {
+    std::size_t hits = 0;
+    std::size_t misses = 0;
+    std::size_t evictions = 0;
+    std::size_t size = 0;
+};
+
+// bounded LRU cache of pricing results keyed by PricingKey, safe to share between threads: lookups and insertions
+// take a mutex, the pricing of a miss runs outside of it (two threads missing the same key both price it)
+class PricingCache {
+private:
+    struct Entry {
+        PricingKey key;
+        PricingResult result;
+    };
+    std::size_t capacity;
+    std::list<Entry> entries; // most recently used first
+    std::unordered_multimap<std::uint64_t, std::list<Entry>::iterator> index; // by key hash
+    PricingCacheStats stats;
+    mutable std::mutex mutex;
+
+    std::list<Entry>::iterator lookup(const PricingKey& key); // entries.end() when absent, under the lock
+
+public:
+    explicit PricingCache(std::size_t capacity = 1024);
+    std::optional<PricingResult> find(const PricingKey& key);
+    void insert(const PricingKey& key, const PricingResult& result); // ignores keys that aren't cacheable
+    // the cached result, or a rolling DiscretePricer sweep (on the workspace if given) then cached
+    PricingResult price(const PricingJob& job, PricingWorkspace* workspace = nullptr);
+    PricingCacheStats getStats() const;
+    std::size_t getCapacity() const;
+    void clear(); // entries only, the statistics are kept
+};
@@ -0,0 +1,72 @@
+#include "PricingPool.hpp"
+
+PricingPool::PricingPool(std::size_t threads) : pool(threads) {
+    for (std::size_t w = 0; w < pool.size(); w++) {
+        workspaces.push_back(std::make_unique<PricingWorkspace>());
+    }
+}
+
+std::size_t PricingPool::size() const {
+    return pool.size();
+}
+
+PricingJob PricingTask::view() const {
+    return PricingJob{contract, market->stm, market->volBC, market->rateBC, *additionalBC, sigma_0, theta, precision};
+}
+
+PricingResult PricingPool::run(const PricingJob& job) {
+    PricingWorkspace& workspace = *workspaces[pool.workerIndex()];
+    PricingResult result;
+    {
+        DiscretePricer pricer(job.stm.get_N(), job.stm.get_N_T(), job.contract, job.sigma_0, job.volBC, job.rateBC, job.additionalBC,
+                              job.stm, PricingMode::RollingSlices, &workspace);
+        pricer.price(job.theta, job.precision);
+        result = pricer.getResult();
+    }
+    workspace.reset();
+    return result;
+}
+
+std::future<PricingResult> PricingPool::submit(const PricingJob& job) {
+    return pool.submit([this, job]() { return run(job); });
+}
+
+std::future<PricingResult> PricingPool::submit(PricingTask task) {
+    return pool.submit([this, task = std::move(task)]() { return run(task.view()); });
+}
+
+std::vector<PricingResult> PricingPool::priceAll(const std::vector<PricingJob>& jobs) {
+    std::vector<std::future<PricingResult>> futures;
+    futures.reserve(jobs.size());
+    for (const PricingJob& job : jobs) {
+        futures.push_back(submit(job));
+    }
+    std::vector<PricingResult> results;
+    results.reserve(jobs.size());
+    for (std::future<PricingResult>& future : futures) {
+        results.push_back(future.get());
+    }
+    return results;
+}
+
+std::vector<PricingResult> PricingPool::priceAll(std::vector<PricingTask> tasks) {
+    std::vector<std::future<PricingResult>> futures;
+    futures.reserve(tasks.size());
+    for (PricingTask& task : tasks) {
+        futures.push_back(submit(std::move(task)));
+    }
+    std::vector<PricingResult> results;
+    results.reserve(tasks.size());
+    for (std::future<PricingResult>& future : futures) {
+        results.push_back(future.get());
+    }
+    return results;
+}
+
+std::size_t PricingPool::allocations() const {
+    std::size_t total = 0;
+    for (const std::unique_ptr<PricingWorkspace>& workspace : workspaces) {
+        total += workspace->allocations();
+    }
+    return total;
+}
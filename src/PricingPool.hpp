@@ -0,0 +1,61 @@
+#pragma once
+#include "Pricers.hpp"
+#include "ThreadPool.hpp"
+#include <future>
+#include <memory>
+#include <vector>
+
+// everything one pricing needs: the contract, its mesh and boundary setup, all referenced (they have to outlive the job,
+// PricingTask owns them)
+struct PricingJob {
+    const Contract& contract;
+    const SpaceTimeMesh& stm;
+    const BoundaryConditions& volBC;
+    const BoundaryConditions& rateBC;
+    const BoundaryConditions& additionalBC;
+    double sigma_0;
+    double theta = 0.5;
+    SolverPrecision precision = SolverPrecision::Double;
+};
+
+// the mesh with the vol and rate conditions on it: built once, immutable, shared by every task priced on it
+struct MarketData {
+    SpaceTimeMesh stm;
+    BoundaryConditions volBC;
+    BoundaryConditions rateBC;
+};
+
+// owning counterpart of PricingJob, safe to queue and to move between threads: the market data and the additional
+// conditions are shared (moving or copying a task copies no mesh), the contract owns its payoff and shares its asset
+// (build it from a shared_ptr<const Asset>, a contract built on a reference only refers to its asset)
+struct PricingTask {
+    std::shared_ptr<const MarketData> market;
+    Contract contract;
+    std::shared_ptr<const BoundaryConditions> additionalBC;
+    double sigma_0;
+    double theta = 0.5;
+    SolverPrecision precision = SolverPrecision::Double;
+
+    PricingJob view() const; // refers to the task, valid while it lives (e.g. a PricingKey)
+};
+
+// prices independent contracts on a work stealing pool, each job being a rolling DiscretePricer sweep
+// that runs on the workspace of the worker executing it (no heap allocation once the first jobs have sized it)
+class PricingPool {
+private:
+    std::vector<std::unique_ptr<PricingWorkspace>> workspaces; // one per worker, declared before the pool so that it outlives the workers
+    ThreadPool pool;
+
+    PricingResult run(const PricingJob& job); // on the workspace of the calling worker
+
+public:
+    // 0 threads: one per hardware thread
+    explicit PricingPool(std::size_t threads = 0);
+    std::size_t size() const;
+    std::future<PricingResult> submit(const PricingJob& job);
+    std::future<PricingResult> submit(PricingTask task); // moved into the queue
+    // submits everything then waits, results in the order of the jobs
+    std::vector<PricingResult> priceAll(const std::vector<PricingJob>& jobs);
+    std::vector<PricingResult> priceAll(std::vector<PricingTask> tasks);
+    std::size_t allocations() const; // heap allocations of the workspaces since construction (call between batches)
+};
@@ -0,0 +1,215 @@
+#include "Random.hpp"
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+const std::uint32_t PHILOX_M0 = 0xD2511F53;
+const std::uint32_t PHILOX_M1 = 0xCD9E8D57;
+const std::uint32_t PHILOX_W0 = 0x9E3779B9;
+const std::uint32_t PHILOX_W1 = 0xBB67AE85;
+
+// AS241 PPND16 coefficients, lowest degree first
+const double CENTRAL_NUM[8] = {3.3871328727963666080e0, 1.3314166789178437745e+2, 1.9715909503065514427e+3, 1.3731693765509461125e+4,
+                               4.5921953931549871457e+4, 6.7265770927008700853e+4, 3.3430575583588128105e+4, 2.5090809287301226727e+3};
+const double CENTRAL_DEN[8] = {1.0, 4.2313330701600911252e+1, 6.8718700749205790830e+2, 5.3941960214247511077e+3,
+                               2.1213794301586595867e+4, 3.9307895800092710610e+4, 2.8729085735721942674e+4, 5.2264952788528545610e+3};
+const double NEAR_NUM[8] = {1.42343711074968357734e0, 4.63033784615654529590e0, 5.76949722146069140550e0, 3.64784832476320460504e0,
+                            1.27045825245236838258e0, 2.41780725177450611770e-1, 2.27238449892691845833e-2, 7.74545014278341407640e-4};
+const double NEAR_DEN[8] = {1.0, 2.05319162663775882187e0, 1.67638483018380384940e0, 6.89767334985100004550e-1,
+                            1.48103976427480074590e-1, 1.51986665636164571966e-2, 5.47593808499534494600e-4, 1.05075007164441684324e-9};
+const double FAR_NUM[8] = {6.65790464350110377720e0, 5.46378491116411436990e0, 1.78482653991729133580e0, 2.96560571828504891230e-1,
+                           2.65321895265761230930e-2, 1.24266094738807843860e-3, 2.71155556874348757815e-5, 2.01033439929228813265e-7};
+const double FAR_DEN[8] = {1.0, 5.99832206555887937690e-1, 1.36929880922735805310e-1, 1.48753612908506148525e-2,
+                           7.86869131145613259100e-4, 1.84631831751005468180e-5, 1.42151175831644588870e-7, 2.04426310338993978564e-15};
+
+double ratio(const double* num, const double* den, double r) {
+    double p = num[7];
+    double q = den[7];
+    for (int k = 6; k >= 0; k--) {
+        p = p * r + num[k];
+        q = q * r + den[k];
+    }
+    return p / q;
+}
+
+// degree s, coefficients a and initial m_1..m_s of dimensions 2 to 21 (dimension 1 has every m_k = 1)
+struct Primitive {
+    unsigned s;
+    unsigned a;
+    std::uint32_t m[7];
+};
+const Primitive JOE_KUO[SobolSequence::maxDimensions - 1] = {
+    {1, 0, {1}},
+    {2, 1, {1, 3}},
+    {3, 1, {1, 3, 1}},
+    {3, 2, {1, 1, 1}},
+    {4, 1, {1, 1, 3, 3}},
+    {4, 4, {1, 3, 5, 13}},
+    {5, 2, {1, 1, 5, 5, 17}},
+    {5, 4, {1, 1, 5, 5, 5}},
+    {5, 7, {1, 1, 7, 11, 19}},
+    {5, 11, {1, 1, 5, 1, 1}},
+    {5, 13, {1, 1, 1, 3, 11}},
+    {5, 14, {1, 3, 5, 5, 31}},
+    {6, 1, {1, 3, 3, 9, 7, 49}},
+    {6, 13, {1, 1, 1, 15, 21, 21}},
+    {6, 16, {1, 3, 1, 13, 27, 49}},
+    {6, 19, {1, 1, 1, 15, 7, 5}},
+    {6, 22, {1, 3, 1, 15, 13, 25}},
+    {6, 25, {1, 1, 5, 5, 19, 61}},
+    {7, 1, {1, 3, 7, 11, 23, 15, 103}},
+    {7, 4, {1, 3, 7, 13, 13, 15, 69}},
+};
+}
+
+std::array<std::uint32_t, 4> philox4x32(std::array<std::uint32_t, 4> counter, std::array<std::uint32_t, 2> key) {
+    for (int round = 0; round < 10; round++) {
+        std::uint64_t product0 = static_cast<std::uint64_t>(PHILOX_M0) * counter[0];
+        std::uint64_t product1 = static_cast<std::uint64_t>(PHILOX_M1) * counter[2];
+        counter = {static_cast<std::uint32_t>(product1 >> 32) ^ counter[1] ^ key[0], static_cast<std::uint32_t>(product1),
+                   static_cast<std::uint32_t>(product0 >> 32) ^ counter[3] ^ key[1], static_cast<std::uint32_t>(product0)};
+        key[0] += PHILOX_W0;
+        key[1] += PHILOX_W1;
+    }
+    return counter;
+}
+
+double to_uniform(std::uint32_t high, std::uint32_t low) {
+    std::uint64_t bits53 = ((static_cast<std::uint64_t>(high) << 32) | low) >> 11;
+    return (static_cast<double>(bits53) + 0.5) * 0x1.0p-53;
+}
+
+double inverse_norm_cdf(double p) {
+    assert(p > 0 && p < 1);
+    double q = p - 0.5;
+    if (std::abs(q) <= 0.425) {
+        return q * ratio(CENTRAL_NUM, CENTRAL_DEN, 0.180625 - q * q);
+    }
+    double r = std::sqrt(-std::log(q < 0 ? p : 1 - p));
+    double x = r <= 5 ? ratio(NEAR_NUM, NEAR_DEN, r - 1.6) : ratio(FAR_NUM, FAR_DEN, r - 5);
+    return q < 0 ? -x : x;
+}
+
+SobolSequence::SobolSequence(std::size_t dimensions) : dimensions(dimensions), directions(dimensions * bits) {
+    if (dimensions > maxDimensions) {
+        throw std::invalid_argument("Sobol sequence: too many dimensions.");
+    }
+    for (std::size_t d = 0; d < dimensions; d++) {
+        std::uint32_t* v = directions.data() + d * bits;
+        if (d == 0) {
+            for (std::size_t k = 0; k < bits; k++) {
+                v[k] = 1u << (bits - 1 - k);
+            }
+            continue;
+        }
+        const Primitive& primitive = JOE_KUO[d - 1];
+        unsigned s = primitive.s;
+        for (std::size_t k = 0; k < s; k++) {
+            v[k] = primitive.m[k] << (bits - 1 - k);
+        }
+        // v_k = a_1 v_{k-1} ^ ... ^ a_{s-1} v_{k-s+1} ^ v_{k-s} ^ (v_{k-s} >> s)
+        for (std::size_t k = s; k < bits; k++) {
+            v[k] = v[k - s] ^ (v[k - s] >> s);
+            for (unsigned j = 1; j < s; j++) {
+                if ((primitive.a >> (s - 1 - j)) & 1) {
+                    v[k] ^= v[k - j];
+                }
+            }
+        }
+    }
+}
+
+std::size_t SobolSequence::getDimensions() const {
+    return dimensions;
+}
+
+void SobolSequence::point(std::uint64_t i, std::uint32_t* words) const {
+    std::uint64_t gray = i ^ (i >> 1);
+    for (std::size_t d = 0; d < dimensions; d++) {
+        std::uint32_t word = 0;
+        for (std::size_t k = 0; k < bits; k++) {
+            if ((gray >> k) & 1) {
+                word ^= directions[d * bits + k];
+            }
+        }
+        words[d] = word;
+    }
+}
+
+void SobolSequence::next(std::uint64_t i, std::uint32_t* words) const {
+    // gray(i + 1) differs from gray(i) at the lowest zero bit of i
+    std::size_t k = 0;
+    while ((i >> k) & 1) {
+        k++;
+    }
+    assert(k < bits);
+    for (std::size_t d = 0; d < dimensions; d++) {
+        words[d] ^= directions[d * bits + k];
+    }
+}
+
+BrownianBridge::BrownianBridge(std::size_t steps)
+    : steps(steps), bridgeIndex(steps), leftIndex(steps), rightIndex(steps), leftWeight(steps), rightWeight(steps), stdDev(steps) {
+    assert(steps > 0);
+    // point l of the path is at time l + 1, point steps - 1 first then the middle of every gap [j, k]
+    std::vector<std::size_t> built(steps, 0);
+    built[steps - 1] = 1;
+    bridgeIndex[0] = steps - 1;
+    stdDev[0] = std::sqrt(static_cast<double>(steps));
+    for (std::size_t i = 1, j = 0; i < steps; i++) {
+        while (built[j]) {
+            j++;
+        }
+        std::size_t k = j;
+        while (!built[k]) {
+            k++;
+        }
+        std::size_t l = j + ((k - 1 - j) >> 1);
+        built[l] = 1;
+        bridgeIndex[i] = l;
+        leftIndex[i] = j;
+        rightIndex[i] = k;
+        // left neighbour at time j (point j - 1, or the origin), right neighbour at time k + 1
+        double left = static_cast<double>(j);
+        double right = static_cast<double>(k + 1);
+        double middle = static_cast<double>(l + 1);
+        leftWeight[i] = (right - middle) / (right - left);
+        rightWeight[i] = (middle - left) / (right - left);
+        stdDev[i] = std::sqrt((middle - left) * (right - middle) / (right - left));
+        j = k + 1;
+        if (j >= steps) {
+            j = 0;
+        }
+    }
+}
+
+void BrownianBridge::transform(const double* normals, double* increments, std::size_t stride, std::size_t count) const {
+    // path points first, then differences in place
+    double* end = increments + (steps - 1) * stride;
+    for (std::size_t k = 0; k < count; k++) {
+        end[k] = stdDev[0] * normals[k];
+    }
+    for (std::size_t i = 1; i < steps; i++) {
+        double* point = increments + bridgeIndex[i] * stride;
+        const double* right = increments + rightIndex[i] * stride;
+        const double* normal = normals + i * stride;
+        if (leftIndex[i] != 0) {
+            const double* left = increments + (leftIndex[i] - 1) * stride;
+            for (std::size_t k = 0; k < count; k++) {
+                point[k] = leftWeight[i] * left[k] + rightWeight[i] * right[k] + stdDev[i] * normal[k];
+            }
+        } else {
+            for (std::size_t k = 0; k < count; k++) {
+                point[k] = rightWeight[i] * right[k] + stdDev[i] * normal[k];
+            }
+        }
+    }
+    for (std::size_t n = steps; n-- > 1;) {
+        double* current = increments + n * stride;
+        const double* previous = increments + (n - 1) * stride;
+        for (std::size_t k = 0; k < count; k++) {
+            current[k] -= previous[k];
+        }
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3"): 4 random words from a 128 bit counter
+// and a 64 bit key, no state, so any draw of any path can be computed by any thread
+std::array<std::uint32_t, 4> philox4x32(std::array<std::uint32_t, 4> counter, std::array<std::uint32_t, 2> key);
+
+// uniform in (0, 1) from 64 random bits (53 kept, never 0 or 1)
+double to_uniform(std::uint32_t high, std::uint32_t low);
+
+// inverse of the standard normal cdf, Wichura's AS241 (about 16 significant digits), p in (0, 1)
+double inverse_norm_cdf(double p);
+
+// Sobol sequence with the Joe-Kuo direction numbers (new-joe-kuo-6.21201) of its first maxDimensions dimensions,
+// points in Gray code order so that point i + 1 is one xor away from point i
+class SobolSequence {
+public:
+    static constexpr std::size_t maxDimensions = 21;
+    static constexpr std::size_t bits = 32;
+
+private:
+    std::size_t dimensions;
+    std::vector<std::uint32_t> directions; // bits words per dimension
+
+public:
+    explicit SobolSequence(std::size_t dimensions);
+    std::size_t getDimensions() const;
+    // point of index i, one 32 bit word per dimension (the coordinate is word / 2^32)
+    void point(std::uint64_t i, std::uint32_t* words) const;
+    // point i + 1 from point i
+    void next(std::uint64_t i, std::uint32_t* words) const;
+};
+
+// Brownian bridge on steps equal time steps: the first normal draws the end point, the next ones the midpoints of the
+// intervals left (Glasserman, "Monte Carlo methods in financial engineering" 3.1), so that the first, best distributed
+// quasi random dimensions decide the coarse shape of the path
+class BrownianBridge {
+private:
+    std::size_t steps;
+    std::vector<std::size_t> bridgeIndex;
+    std::vector<std::size_t> leftIndex;
+    std::vector<std::size_t> rightIndex;
+    std::vector<double> leftWeight;
+    std::vector<double> rightWeight;
+    std::vector<double> stdDev;
+
+public:
+    explicit BrownianBridge(std::size_t steps);
+    // normals[d*stride + k] (d-th draw of path k) to increments[n*stride + k] of unit variance (times sqrt(dt) for the
+    // Brownian increments), count paths at once
+    void transform(const double* normals, double* increments, std::size_t stride, std::size_t count) const;
+};
@@ -0,0 +1,270 @@
+#include "StochasticVolPricer.hpp"
+#include <future>
+#include <stdexcept>
+
+namespace {
+// body(begin, end) over [0, count), in one chunk per worker when a pool is given
+template <typename F>
+void for_lines(ThreadPool* pool, std::size_t count, const F& body) {
+    std::size_t chunks = pool ? std::min(pool->size(), count) : 1;
+    if (chunks <= 1) {
+        body(0, count);
+        return;
+    }
+    std::vector<std::future<void>> done;
+    done.reserve(chunks);
+    for (std::size_t c = 0; c < chunks; c++) {
+        std::size_t begin = count * c / chunks;
+        std::size_t end = count * (c + 1) / chunks;
+        done.push_back(pool->submit([&body, begin, end]() { body(begin, end); }));
+    }
+    for (std::future<void>& chunk : done) {
+        chunk.get();
+    }
+}
+}
+
+StochasticVolPricer::StochasticVolPricer(const Contract& contract, const SpaceVolTimeMesh& mesh, const BoundaryConditions& rateBC, double correlation,
+                                         AdiScheme scheme, PricingMode mode)
+    : contract(contract), mesh(mesh), correlation(correlation), scheme(scheme), mode(mode), rateApprox(mesh.getSpaceTimeMesh()) {
+    if (!(correlation >= -1 && correlation <= 1)) {
+        throw std::invalid_argument("stochastic vol: correlation outside [-1, 1].");
+    }
+    if (contract.getExercise().style != ExerciseStyle::European) {
+        throw std::invalid_argument("stochastic vol: european exercise only.");
+    }
+    if (std::abs(contract.getMaturity() - mesh.getSpaceTimeMesh().get_T()) > 1e-12) {
+        throw std::invalid_argument("stochastic vol: contract maturity doesn't match the mesh.");
+    }
+    rateApprox.solve(rateBC, contract.getUnderlying().getRateDynamics());
+    std::size_t N = mesh.get_N();
+    std::size_t M = mesh.get_M();
+    xOfNode.resize(N * M);
+    sigmaOfNode.resize(N * M);
+    for (std::size_t j = 0; j < M; j++) {
+        std::copy(mesh.getSpaceTimeMesh().getXNodes(), mesh.getSpaceTimeMesh().getXNodes() + N, xOfNode.begin() + j * N);
+        std::fill(sigmaOfNode.begin() + j * N, sigmaOfNode.begin() + (j + 1) * N, mesh.getSigmaNodes()[j]);
+    }
+    for (std::vector<double>* buffer : {&xLower, &xDiag, &xUpper, &sLower, &sDiag, &sUpper, &mixed, &a0u, &a1u, &a2u, &stage, &solution, &modUpper}) {
+        buffer->resize(N * M);
+    }
+}
+
+void StochasticVolPricer::buildOperators(std::size_t n, std::vector<double>& drift, std::vector<double>& pseudoVol) {
+    const SpaceTimeMesh& stm = mesh.getSpaceTimeMesh();
+    std::size_t N = mesh.get_N();
+    std::size_t M = mesh.get_M();
+    double dx = stm.get_dx();
+    double ds = mesh.get_dsigma();
+    contract.getUnderlying().getVolDynamics().evaluate(stm.getCoords(0, n).second, xOfNode.data(), sigmaOfNode.data(), drift.data(), pseudoVol.data(), N * M);
+    const double* rate = rateApprox.getProcessMesh().getTimeSlice(n).data();
+    for (std::size_t j = 0; j < M; j++) {
+        // x direction: the 1D generator at sigma_j (assemble_operator gives its opposite)
+        std::size_t line = j * N;
+        assemble_operator(sigmaOfNode.data() + line, rate, dx, xLower.data() + line, xDiag.data() + line, xUpper.data() + line, N);
+        for (std::size_t i = 0; i < N; i++) {
+            std::size_t k = line + i;
+            xLower[k] = -xLower[k];
+            xDiag[k] = -xDiag[k];
+            xUpper[k] = -xUpper[k];
+            // sigma direction: dsigma = (drift + pseudoVol (r - sigma^2/2)) dt + pseudoVol sigma dW~
+            double sigma = sigmaOfNode[k];
+            double sigmaDrift = drift[k] + pseudoVol[k] * (rate[i] - 0.5 * sigma * sigma);
+            double sigmaVol = pseudoVol[k] * sigma;
+            double diffusion = 0.5 * sigmaVol * sigmaVol / (ds * ds);
+            double convection = 0.5 * sigmaDrift / ds;
+            if (j == 0) { // ghost node u_{-1} = 2u_0 - u_1
+                sLower[k] = 0;
+                sDiag[k] = -2 * convection;
+                sUpper[k] = 2 * convection;
+            } else if (j + 1 == M) {
+                sLower[k] = -2 * convection;
+                sDiag[k] = 2 * convection;
+                sUpper[k] = 0;
+            } else {
+                sLower[k] = diffusion - convection;
+                sDiag[k] = -2 * diffusion;
+                sUpper[k] = diffusion + convection;
+            }
+            bool interior = i > 0 && i + 1 < N && j > 0 && j + 1 < M;
+            mixed[k] = interior ? correlation * sigma * sigmaVol / (4 * dx * ds) : 0;
+        }
+    }
+}
+
+void StochasticVolPricer::step(const double* next, double* current, double dt, double theta, ThreadPool* pool) {
+    std::size_t N = mesh.get_N();
+    std::size_t M = mesh.get_M();
+    // explicit part: every operator applied to the next slice, Y0 = U + dt (A0 + A1 + A2) U
+    for_lines(pool, M, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t j = begin; j < end; j++) {
+            for (std::size_t i = 0; i < N; i++) {
+                std::size_t k = j * N + i;
+                double u = next[k];
+                a1u[k] = xDiag[k] * u + (i > 0 ? xLower[k] * next[k - 1] : 0) + (i + 1 < N ? xUpper[k] * next[k + 1] : 0);
+                a2u[k] = sDiag[k] * u + (j > 0 ? sLower[k] * next[k - N] : 0) + (j + 1 < M ? sUpper[k] * next[k + N] : 0);
+                a0u[k] = mixed[k] == 0 ? 0 : mixed[k] * (next[k + N + 1] - next[k - N + 1] - next[k + N - 1] + next[k - N - 1]);
+                stage[k] = u + dt * (a0u[k] + a1u[k] + a2u[k]);
+            }
+        }
+    });
+    solveLines(theta * dt, pool);
+    if (scheme == AdiScheme::CraigSneyd) {
+        // Y0 corrected by half the change of the mixed derivative, then the same implicit stages
+        for_lines(pool, M, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t j = begin; j < end; j++) {
+                for (std::size_t i = 0; i < N; i++) {
+                    std::size_t k = j * N + i;
+                    solution[k] = mixed[k] == 0 ? 0 : mixed[k] * (stage[k + N + 1] - stage[k - N + 1] - stage[k + N - 1] + stage[k - N - 1]);
+                }
+            }
+        });
+        for_lines(pool, M, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t k = begin * N; k < end * N; k++) {
+                stage[k] = next[k] + dt * (a0u[k] + a1u[k] + a2u[k]) + 0.5 * dt * (solution[k] - a0u[k]);
+            }
+        });
+        solveLines(theta * dt, pool);
+    }
+    std::copy(stage.begin(), stage.end(), current);
+}
+
+void StochasticVolPricer::solveLines(double thetaDt, ThreadPool* pool) {
+    std::size_t N = mesh.get_N();
+    std::size_t M = mesh.get_M();
+    // x-lines: contiguous, one Thomas sweep each
+    for_lines(pool, M, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t j = begin; j < end; j++) {
+            std::size_t line = j * N;
+            for (std::size_t i = 0; i < N; i++) {
+                std::size_t k = line + i;
+                double lower = -thetaDt * xLower[k];
+                double pivot = 1 - thetaDt * xDiag[k] - (i > 0 ? lower * modUpper[k - 1] : 0);
+                double rhs = stage[k] - thetaDt * a1u[k] - (i > 0 ? lower * stage[k - 1] : 0);
+                modUpper[k] = -thetaDt * xUpper[k] / pivot;
+                stage[k] = rhs / pivot;
+            }
+            for (std::size_t i = N - 1; i-- > 0;) {
+                stage[line + i] -= modUpper[line + i] * stage[line + i + 1];
+            }
+        }
+    });
+    // sigma-lines: stride N, swept together over a range of x so that every row stays contiguous
+    for_lines(pool, N, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t j = 0; j < M; j++) {
+            for (std::size_t i = begin; i < end; i++) {
+                std::size_t k = j * N + i;
+                double lower = -thetaDt * sLower[k];
+                double pivot = 1 - thetaDt * sDiag[k] - (j > 0 ? lower * modUpper[k - N] : 0);
+                double rhs = stage[k] - thetaDt * a2u[k] - (j > 0 ? lower * stage[k - N] : 0);
+                modUpper[k] = -thetaDt * sUpper[k] / pivot;
+                stage[k] = rhs / pivot;
+            }
+        }
+        for (std::size_t j = M - 1; j-- > 0;) {
+            for (std::size_t i = begin; i < end; i++) {
+                std::size_t k = j * N + i;
+                stage[k] -= modUpper[k] * stage[k + N];
+            }
+        }
+    });
+}
+
+void StochasticVolPricer::price(double theta, ThreadPool* pool) {
+    assert(theta <= 1 && theta >= 0);
+    PRICER_PHASE(PricingPhase::BackwardSweep);
+    const SpaceTimeMesh& stm = mesh.getSpaceTimeMesh();
+    std::size_t N = mesh.get_N();
+    std::size_t M = mesh.get_M();
+    std::size_t last = mesh.get_N_T() - 1;
+    PRICER_COUNT_NODES(last * N * M, last * N * M * sizeof(double));
+    std::vector<double> drift(N * M), pseudoVol(N * M), payoff(N);
+    contract.applyPayoff(stm, payoff.data());
+
+    std::vector<double> next, current;
+    if (mode == PricingMode::FullGrid) {
+        contractPrices.emplace(mesh);
+    } else {
+        next.resize(N * M);
+        current.resize(N * M);
+    }
+    double* last_slice = contractPrices ? contractPrices->getTimeSlice(last) : next.data();
+    for (std::size_t j = 0; j < M; j++) {
+        std::copy(payoff.begin(), payoff.end(), last_slice + j * N);
+    }
+    for (std::size_t n = last; n-- > 0;) {
+        buildOperators(n, drift, pseudoVol);
+        if (contractPrices) {
+            step(contractPrices->getTimeSlice(n + 1), contractPrices->getTimeSlice(n), stm.get_dt(n), theta, pool);
+        } else {
+            step(next.data(), current.data(), stm.get_dt(n), theta, pool);
+            next.swap(current);
+        }
+    }
+    if (!contractPrices) {
+        // next now holds t_0 and current t_1
+        firstSlices.resize(2 * N * M);
+        std::copy(next.begin(), next.end(), firstSlices.begin());
+        std::copy(current.begin(), current.end(), firstSlices.begin() + N * M);
+    }
+}
+
+double StochasticVolPricer::priceAt(std::size_t i, std::size_t j, std::size_t n) const {
+    if (contractPrices) {
+        return contractPrices->getMeshData(i, j, n);
+    }
+    assert(n < 2 && !firstSlices.empty());
+    return firstSlices[(n * mesh.get_M() + j) * mesh.get_N() + i];
+}
+
+double StochasticVolPricer::interpolated(std::size_t i, double sigma, bool derivative, std::size_t n) const {
+    std::size_t M = mesh.get_M();
+    double ds = mesh.get_dsigma();
+    double position = (sigma - mesh.getSigmaNodes()[0]) / ds;
+    if (!(position >= 0 && position <= M - 1)) {
+        throw std::out_of_range("stochastic vol: sigma outside the vol axis.");
+    }
+    std::size_t j = std::min<std::size_t>(std::max<std::size_t>(static_cast<std::size_t>(std::lround(position)), 1), M - 2);
+    double s = position - j;
+    // Lagrange weights on sigma_{j-1}, sigma_j, sigma_{j+1} (or of their derivative)
+    double w[3] = {0.5 * s * (s - 1), 1 - s * s, 0.5 * s * (s + 1)};
+    if (derivative) {
+        w[0] = (s - 0.5) / ds;
+        w[1] = -2 * s / ds;
+        w[2] = (s + 0.5) / ds;
+    }
+    return w[0] * priceAt(i, j - 1, n) + w[1] * priceAt(i, j, n) + w[2] * priceAt(i, j + 1, n);
+}
+
+double StochasticVolPricer::getPrice(double sigma) const {
+    return interpolated(mesh.get_N() / 2, sigma, false, 0);
+}
+
+double StochasticVolPricer::vega(double sigma) const {
+    return interpolated(mesh.get_N() / 2, sigma, true, 0);
+}
+
+PricingResult StochasticVolPricer::getResult(double sigma) const {
+    const SpaceTimeMesh& stm = mesh.getSpaceTimeMesh();
+    std::size_t mid = mesh.get_N() / 2;
+    double dx = stm.get_dx();
+    double below = interpolated(mid - 1, sigma, false, 0);
+    double at = interpolated(mid, sigma, false, 0);
+    double above = interpolated(mid + 1, sigma, false, 0);
+    return {at, (above - below) / (2 * dx), (above + below - 2 * at) / (dx * dx), (at - interpolated(mid, sigma, false, 1)) / stm.get_dt(0)};
+}
+
+const FunctionMesh2D& StochasticVolPricer::getPriceMesh() const {
+    if (!contractPrices) {
+        throw std::logic_error("price mesh isn't kept in rolling mode.");
+    }
+    return *contractPrices;
+}
+
+std::size_t StochasticVolPricer::memoryFootprint() const {
+    std::size_t cells = firstSlices.size();
+    if (contractPrices) {
+        cells += mesh.get_N() * mesh.get_M() * mesh.get_N_T();
+    }
+    return cells * sizeof(double);
+}
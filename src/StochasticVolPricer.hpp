@@ -0,0 +1,59 @@
+#pragma once
+#include "Pricers.hpp"
+#include "ThreadPool.hpp"
+
+// splitting of one step of the two state variable scheme: Douglas (first order in the mixed derivative),
+// or Craig-Sneyd (a second correction with the mixed derivative, second order for theta = 1/2)
+enum class AdiScheme { Douglas, CraigSneyd };
+
+// european contract with the vol as a second state variable instead of a grid over (x, t):
+//   dx = (r - sigma^2/2) dt + sigma dW,   dsigma = drift dt + pseudoVol dx~,   d<W, W~> = correlation dt
+// x~ being x driven by W~, drift and pseudoVol the asset's vol dynamics at (t, x, sigma). Correlation 1 is the model
+// MonteCarloPricer simulates (ItoProcess freezes the vol to a grid over (x, t) instead); r is the rate process solved on
+// the (x, t) mesh like DiscretePricer.
+// Every step is alternating direction implicit: the mixed derivative explicit, then one tridiagonal solve per x-line
+// and one per sigma-line, the lines of a direction independent of each other and split over a thread pool when one is
+// given (same result for any number of threads). Edges: zero gamma in S on the x edges like DiscretePricer without
+// dirichlet data, zero second derivative in sigma on the vol edges.
+class StochasticVolPricer {
+private:
+    const Contract& contract;
+    const SpaceVolTimeMesh& mesh;
+    double correlation;
+    AdiScheme scheme;
+    PricingMode mode;
+    ItoProcess rateApprox;
+    std::optional<FunctionMesh2D> contractPrices; // FullGrid only
+    std::vector<double> firstSlices; // prices at t_0 then t_1 (N*M each)
+
+    // (x_i, sigma_j) of every node of a slice, as the vol dynamics read them
+    std::vector<double> xOfNode;
+    std::vector<double> sigmaOfNode;
+    // operators of the slice being stepped: x and sigma directions as lower/diag/upper of every node, mixed derivative weight
+    std::vector<double> xLower, xDiag, xUpper;
+    std::vector<double> sLower, sDiag, sUpper;
+    std::vector<double> mixed;
+    // applied operators and stages of a step
+    std::vector<double> a0u, a1u, a2u, stage, solution;
+    std::vector<double> modLower, modUpper, invPivots;
+
+    void buildOperators(std::size_t n, std::vector<double>& drift, std::vector<double>& pseudoVol);
+    void step(const double* next, double* current, double dt, double theta, ThreadPool* pool);
+    // stage <- (I - theta dt A1)^-1 (stage - theta dt a1u), then the same in sigma with a2u
+    void solveLines(double thetaDt, ThreadPool* pool);
+    double interpolated(std::size_t i, double sigma, bool derivative, std::size_t n) const;
+
+public:
+    // rateBC: boundary conditions of the rate process on mesh.getSpaceTimeMesh()
+    StochasticVolPricer(const Contract& contract, const SpaceVolTimeMesh& mesh, const BoundaryConditions& rateBC, double correlation,
+                        AdiScheme scheme = AdiScheme::CraigSneyd, PricingMode mode = PricingMode::RollingSlices);
+    // pool: splits the lines of every direction over its workers (not to be called from one of them)
+    void price(double theta = 0.5, ThreadPool* pool = nullptr);
+    // at S0 and the initial vol sigma (quadratic interpolation across the vol nodes), greeks in x = log S like DiscretePricer
+    PricingResult getResult(double sigma) const;
+    double getPrice(double sigma) const;
+    double vega(double sigma) const; // d price / d sigma_0 of the same interpolation
+    double priceAt(std::size_t i, std::size_t j, std::size_t n) const; // any slice in FullGrid, n < 2 otherwise
+    const FunctionMesh2D& getPriceMesh() const; // FullGrid only
+    std::size_t memoryFootprint() const; // bytes of the prices kept after pricing
+};
@@ -0,0 +1,97 @@
+#include "ThreadPool.hpp"
+#include <algorithm>
+
+namespace {
+// pool and index of the worker running on this thread
+thread_local const ThreadPool* currentPool = nullptr;
+thread_local std::size_t currentWorker = ThreadPool::noWorker;
+}
+
+ThreadPool::ThreadPool(std::size_t threads) : pending(0), nextQueue(0), stopping(false) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (std::size_t k = 0; k < threads; k++) {
+        queues.push_back(std::make_unique<WorkQueue>());
+    }
+    for (std::size_t k = 0; k < threads; k++) {
+        workers.emplace_back(&ThreadPool::run, this, k);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+std::size_t ThreadPool::size() const {
+    return workers.size();
+}
+
+std::size_t ThreadPool::workerIndex() const {
+    return currentPool == this ? currentWorker : noWorker;
+}
+
+void ThreadPool::push(Task task) {
+    std::size_t worker = workerIndex();
+    if (worker == noWorker) {
+        worker = nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+    }
+    pending.fetch_add(1); // counted first so that a worker taking it right away never sees the count drop below zero
+    {
+        std::lock_guard<std::mutex> lock(queues[worker]->mutex);
+        queues[worker]->tasks.push_back(std::move(task));
+    }
+    // taking the lock orders the notification after a worker that just found nothing went to sleep
+    { std::lock_guard<std::mutex> lock(sleepMutex); }
+    wake.notify_one();
+}
+
+bool ThreadPool::popLocal(std::size_t worker, Task& task) {
+    std::lock_guard<std::mutex> lock(queues[worker]->mutex);
+    if (queues[worker]->tasks.empty()) {
+        return false;
+    }
+    task = std::move(queues[worker]->tasks.back());
+    queues[worker]->tasks.pop_back();
+    pending.fetch_sub(1);
+    return true;
+}
+
+bool ThreadPool::steal(std::size_t worker, Task& task) {
+    for (std::size_t k = 1; k < queues.size(); k++) {
+        WorkQueue& victim = *queues[(worker + k) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            pending.fetch_sub(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::run(std::size_t worker) {
+    currentPool = this;
+    currentWorker = worker;
+    Task task;
+    while (true) {
+        if (popLocal(worker, task) || steal(worker, task)) {
+            task();
+            task = nullptr; // release the captured state before sleeping
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wake.wait(lock, [this]() { return stopping || pending.load() > 0; });
+        if (stopping && pending.load() == 0) {
+            return;
+        }
+    }
+}
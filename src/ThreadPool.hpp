@@ -0,0 +1,62 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// fixed set of workers, each with its own deque: a worker pops its newest task (back of its deque),
+// idle workers steal the oldest task (front) of the others. Tasks submitted from a worker go to that worker's
+// deque, tasks submitted from outside are dealt round robin.
+// Waiting on a future from inside a task may deadlock if every worker does it, tasks should not block on each other.
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+    static constexpr std::size_t noWorker = static_cast<std::size_t>(-1);
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> workers;
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::atomic<std::size_t> pending; // tasks queued and not taken yet
+    std::atomic<std::size_t> nextQueue;
+    bool stopping;
+
+    void push(Task task);
+    bool popLocal(std::size_t worker, Task& task);
+    bool steal(std::size_t worker, Task& task);
+    void run(std::size_t worker);
+
+public:
+    // 0 threads: one per hardware thread
+    explicit ThreadPool(std::size_t threads = 0);
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ~ThreadPool(); // runs what is still queued then joins
+
+    std::size_t size() const;
+    // index of the calling thread among this pool's workers, noWorker for any other thread
+    std::size_t workerIndex() const;
+
+    template <typename F>
+    std::future<std::invoke_result_t<std::decay_t<F>>> submit(F&& f) {
+        using Result = std::invoke_result_t<std::decay_t<F>>;
+        // std::function needs a copyable callable, the packaged task is shared
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(f));
+        std::future<Result> result = task->get_future();
+        push([task]() { (*task)(); });
+        return result;
+    }
+};
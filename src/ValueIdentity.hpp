@@ -0,0 +1,21 @@
+#pragma once
+#include <string>
+
+// content identity of a value for the pricing cache, opt in: ValueIdentity<T> is specialized for the types whose
+// fields are all they compute with (ConstantDynamics) and appends those fields, never the bytes of the object (padding,
+// or the address a lambda captured by reference). Other types have no identity and their jobs aren't cached
+template <typename T>
+struct ValueIdentity {
+    static bool append(const T&, std::string&) { return false; }
+};
+
+template <typename T>
+bool append_value_identity(const T& value, std::string& key) {
+    return ValueIdentity<T>::append(value, key);
+}
+
+// the bytes of a double, -0 and +0 alike
+inline void append_identity_value(std::string& key, double value) {
+    value += 0.0;
+    key.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
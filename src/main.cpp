@@ -1,25 +1,19 @@
 #include <iostream>
 #include <algorithm>
+#include <vector>
 #include "ItoProcess.hpp"
 #include "Asset.hpp"
 #include "Pricers.hpp"
+#include "AdaptiveGridPricer.hpp"
 int main(int argc, const char * argv[]) {
     
     
     // Example file (replace main) for pricing european calls and comparing with BS closed form model
     // For simplicty's sake, and for a fair comparaison, we assume constant rate/vol
     
-    // vol ito dynamics and boundary conditions
-    std::function<double(double, double, double)> volDrift = [](double t, double x, double p) { return 0; }; // cste vol
-    std::function<double(double, double, double)> volStochastic = [](double t, double x, double p) { return 0; }; //cste vol
-    
-    // rate ito dynamics
-    std::function<double(double, double, double)> rateDrift = [](double t, double x, double p) { return 0; }; // cste rate
-    std::function<double(double, double, double)> rateStochastic = [](double t, double x, double p) { return 0; }; //cste rate
-    
-    // init of constant ItoDynamics
-    ItoDynamics volDynamics(volDrift, volStochastic);
-    ItoDynamics  rateDynamics(rateDrift, rateStochastic);
+    // init of constant ItoDynamics (no drift, no x dependency), typed so that the process loops are inlined
+    ItoDynamics volDynamics{ConstantDynamics(0, 0)}; // cste vol
+    ItoDynamics rateDynamics{ConstantDynamics(0, 0)}; // cste rate
     
     
     // init of underlying
@@ -30,7 +24,7 @@ int main(int argc, const char * argv[]) {
     // init of a contract (European Call for example)
     int K = 250;
     double T = 1; // month contract
-    std::function<double(double)> payoff = [&K](double S) { return std::max(S-K,0.); }; // european call payoff
+    VanillaCallPayoff payoff{static_cast<double>(K)}; // european call payoff
     Contract contract(underlying, payoff, T);
     
     // pricing and creating mesh
@@ -41,8 +35,8 @@ int main(int argc, const char * argv[]) {
     double r_0 = 0.2; // cste risk-free rate
     
     // defining vol and rate boundary conditions (in this case we suppose sigma(0,.) as well as r(0,.) are given and are constant)
-    std::function<double(double, double)> csteVol = [&sigma_0](double t, double x) { return sigma_0; };
-    std::function<double(double, double)> csteRate = [&r_0](double t, double x) { return r_0; };
+    auto csteVol = [sigma_0](double t, double x) { return sigma_0; };
+    auto csteRate = [r_0](double t, double x) { return r_0; };
     
     BoundaryConditions volBoundaries(N, N_T, csteVol);
     BoundaryConditions rateBoundaries(N, N_T, csteRate);
@@ -50,27 +44,38 @@ int main(int argc, const char * argv[]) {
     rateBoundaries.ToggleDir(true, false);
     // volBoundaries.logMesh();//uncomment to visualize
 
-    // defining additional contract boundaries (not payoff)
-    std::function<double(double, double)> zeroPayoff= [&T](double t, double x) { return 0; };
-    std::function<double(double, double)> bsBoundaries= [&](double t, double x) {
-        BlackScholesCallPricer bsP(std::exp(x), K, T-t, r_0, sigma_0);
-        bsP.price();
-        return bsP.getPrice();
+    // init mesh
+    SpaceTimeMesh stm(std::log(contract.getUnderlying().getS0()), 5*sigma_0 * std::sqrt(contract.getMaturity()), contract.getMaturity(), N, N_T);
+
+    // defining additional contract boundaries (not payoff): closed form values on both x edges, all slices in one batch
+    auto zeroPayoff= [](double t, double x) { return 0.; };
+    std::size_t edges = 2 * static_cast<std::size_t>(N_T);
+    std::vector<double> edgeS(edges), edgeK(edges, K), edgeT(edges), edgeR(edges, r_0), edgeSigma(edges, sigma_0);
+    std::vector<double> edgePrice(edges), edgeDelta(edges), edgeGamma(edges), edgeTheta(edges), edgeVega(edges), edgeRho(edges);
+    for (std::size_t n = 0; n < static_cast<std::size_t>(N_T); n++) {
+        edgeS[2 * n] = std::exp(stm.getCoords(0, n).first);
+        edgeS[2 * n + 1] = std::exp(stm.getCoords(N - 1, n).first);
+        edgeT[2 * n] = edgeT[2 * n + 1] = T - stm.getCoords(0, n).second;
+    }
+    black_scholes_batch(OptionType::Call, {edgeS.data(), edgeK.data(), edgeT.data(), edgeR.data(), edgeSigma.data(), edges},
+                        {edgePrice.data(), edgeDelta.data(), edgeGamma.data(), edgeTheta.data(), edgeVega.data(), edgeRho.data()});
+    auto bsBoundaries= [&](double t, double x) {
+        std::size_t n = static_cast<std::size_t>(std::lround(t / stm.get_dt()));
+        return edgePrice[2 * n + (x > std::log(S0) ? 1 : 0)];
     };
     BoundaryConditions contractAdditionalBoundaries(N,N_T, bsBoundaries);
     contractAdditionalBoundaries.ToggleDir(false, false);
     // contractAdditionalBoundaries.logMesh(); // f_0 uncomment to log
     
-    // init mesh
-    SpaceTimeMesh stm(std::log(contract.getUnderlying().getS0()), 5*sigma_0 * std::sqrt(contract.getMaturity()), contract.getMaturity(), N, N_T);
     // init pricer
     std::cout << "dx: " <<stm.get_dx()<<std::endl;
     std::cout << "dt: " <<stm.get_dt()<<std::endl;
 
     
 
+    PricingWorkspace workspace; // meshes of the sweep below: allocated by the first pricing, reused by the next ones
     for (int i =0; i<10; i++){
-        DiscretePricer pricer(N, N_T, contract, sigma_0, volBoundaries, rateBoundaries, contractAdditionalBoundaries,stm);
+        DiscretePricer pricer(N, N_T, contract, sigma_0, volBoundaries, rateBoundaries, contractAdditionalBoundaries,stm, PricingMode::FullGrid, &workspace);
         pricer.price(static_cast<double>(i)/10);
         std::cout << "Crank-Nicholson Scheme's price for theta = " <<static_cast<double>(i)/10<<" : "<< pricer.getPrice()<<std::endl;
     }
@@ -93,6 +98,17 @@ int main(int argc, const char * argv[]) {
     std::cout<< "Black Scholes closed form's gamma: " << bsPricer.gamma()<<std::endl;
     std::cout<< "Black Scholes closed form's theta: " << bsPricer.theta()<<std::endl;
     std::cout<< "Black Scholes closed form's vega: " << bsPricer.vega()<<std::endl;
+    std::cout<<std::endl;
+
+    // same contract to a price tolerance: the grid is chosen by refinement and Richardson extrapolation (mesh centered on the strike)
+    AdaptiveGridSettings gridSettings;
+    gridSettings.tolerance = 1e-4;
+    gridSettings.stretching.centers = {std::log(static_cast<double>(K))};
+    gridSettings.stretching.concentration = 8;
+    AdaptiveGridPricer adaptivePricer(contract, sigma_0, {csteVol, true, false}, {csteRate, true, false}, {zeroPayoff, false, false}, gridSettings);
+    AdaptiveGridResult adaptive = adaptivePricer.price();
+    std::cout << "Extrapolated price (tolerance 1e-4): " << adaptive.extrapolated.price << " +- " << adaptive.errorEstimate
+              << " on " << adaptive.N << "x" << adaptive.N_T << " after " << adaptive.grids << " grids (" << adaptive.nodes << " nodes)" << std::endl;
     
     return 0;
 }
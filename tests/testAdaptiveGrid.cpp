@@ -0,0 +1,66 @@
+#include "AdaptiveGridPricer.hpp"
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+
+void testAdaptiveGrid() {
+    Asset underlying(100, ItoDynamics{ConstantDynamics(0, 0)}, ItoDynamics{ConstantDynamics(0, 0)});
+    BoundarySpec vol{[](double t, double x) { return 0.2; }, true, false};
+    BoundarySpec rate{[](double t, double x) { return 0.05; }, true, false};
+    BoundarySpec zeroBoundary{[](double t, double x) { return 0.; }, false, false};
+
+    for (double K : {90., 100., 117.}) {
+        VanillaCallPayoff payoff{K};
+        Contract contract(underlying, payoff, 1.0);
+        BlackScholesCallPricer closedForm(100, K, 1.0, 0.05, 0.2);
+        closedForm.price();
+        std::size_t previousNodes = 0;
+        for (double tolerance : {1e-3, 1e-5}) {
+            AdaptiveGridSettings settings;
+            settings.tolerance = tolerance;
+            settings.stretching.centers = {std::log(K)};
+            settings.stretching.concentration = 8;
+            AdaptiveGridResult result = AdaptiveGridPricer(contract, 0.2, vol, rate, zeroBoundary, settings).price();
+            // the estimate bounds the actual error, extrapolation beats the finest grid
+            assert(result.converged && result.errorEstimate <= tolerance);
+            assert(std::abs(result.extrapolated.price - closedForm.getPrice()) <= result.errorEstimate);
+            assert(std::abs(result.extrapolated.price - closedForm.getPrice()) < std::abs(result.finest.price - closedForm.getPrice()));
+            assert(std::abs(result.extrapolated.delta - 100 * closedForm.delta()) < std::abs(result.finest.delta - 100 * closedForm.delta()));
+            // a grid at least three levels deep, work of every grid solved accounted for
+            assert(result.grids >= 3 && result.N == (settings.N - 1) * (1 << (result.grids - 1)) + 1);
+            std::size_t nodes = 0;
+            for (std::size_t level = 0; level < result.grids; level++) {
+                nodes += static_cast<std::size_t>((settings.N - 1) * (1 << level) + 1) * ((settings.N_T - 1) * (1 << level) + 1);
+            }
+            assert(result.nodes == nodes);
+            assert(result.nodes >= previousNodes && "tighter tolerance on a coarser grid");
+            previousNodes = result.nodes;
+        }
+    }
+
+    // unreachable tolerance: stops at maxN and says so
+    VanillaCallPayoff payoff{100};
+    Contract contract(underlying, payoff, 1.0);
+    AdaptiveGridSettings settings;
+    settings.tolerance = 1e-14;
+    settings.maxN = 257;
+    AdaptiveGridResult result = AdaptiveGridPricer(contract, 0.2, vol, rate, zeroBoundary, settings).price();
+    assert(!result.converged && result.N == 257 && result.grids == 3);
+
+    bool thrown = false;
+    try {
+        settings.N = 64;
+        AdaptiveGridPricer(contract, 0.2, vol, rate, zeroBoundary, settings);
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown && "even N accepted");
+
+    std::cout << "testAdaptiveGrid passed" << std::endl;
+}
+
+int main() {
+    testAdaptiveGrid();
+    return 0;
+}
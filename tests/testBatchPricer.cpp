@@ -0,0 +1,50 @@
+#include "BatchPricer.hpp"
+#include <cassert>
+#include <cmath>
+#include <iostream>
+
+void testBatchPricer() {
+    std::function<double(double, double, double)> zero = [](double t, double x, double p) { return 0; };
+    ItoDynamics volDynamics(zero, zero);
+    ItoDynamics rateDynamics(zero, zero);
+    Asset underlying(100, volDynamics, rateDynamics);
+
+    std::vector<std::function<double(double)>> payoffs;
+    for (double K : {90., 100., 110.}) {
+        payoffs.push_back([K](double S) { return std::max(S - K, 0.); });
+    }
+    std::vector<Contract> contracts;
+    for (const auto& payoff : payoffs) {
+        contracts.emplace_back(underlying, payoff, 1.0);
+    }
+
+    int N = 101;
+    int N_T = 50;
+    std::function<double(double, double)> vol = [](double t, double x) { return 0.2; };
+    std::function<double(double, double)> rate = [](double t, double x) { return 0.05; };
+    std::function<double(double, double)> zeroBoundary = [](double t, double x) { return 0; };
+    BoundaryConditions volBoundaries(N, N_T, vol);
+    BoundaryConditions rateBoundaries(N, N_T, rate);
+    BoundaryConditions additionalBoundaries(N, N_T, zeroBoundary);
+    volBoundaries.ToggleDir(true, false);
+    rateBoundaries.ToggleDir(true, false);
+    additionalBoundaries.ToggleDir(false, false);
+    SpaceTimeMesh stm(std::log(100.), 1.0, 1.0, N, N_T);
+
+    BatchPricer batch(underlying, stm, volBoundaries, rateBoundaries);
+    std::vector<PricingResult> results = batch.price(contracts, additionalBoundaries, 0.5);
+    assert(results.size() == contracts.size() && "one result per contract expected");
+    for (std::size_t k = 0; k < contracts.size(); k++) {
+        DiscretePricer pricer(N, N_T, contracts[k], 0.2, volBoundaries, rateBoundaries, additionalBoundaries, stm);
+        pricer.price(0.5);
+        assert(std::abs(results[k].price - pricer.getPrice()) < 1e-12 && "batch price mismatch");
+        assert(std::abs(results[k].delta - pricer.delta()) < 1e-9 && "batch delta mismatch");
+        assert(std::abs(results[k].theta - pricer.theta()) < 1e-9 && "batch theta mismatch");
+    }
+    assert(results[0].price > results[1].price && results[1].price > results[2].price && "call prices must decrease with strike");
+}
+
+int main() {
+    testBatchPricer();
+    return 0;
+}
@@ -0,0 +1,75 @@
+#include "BlackScholes.hpp"
+#include "Pricers.hpp"
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+void testBlackScholes() {
+    // approximations against the libm
+    for (double x = -700; x < 700; x += 0.37) {
+        assert(std::abs(fast_exp(x) - std::exp(x)) <= 4e-16 * std::exp(x) && "fast_exp failed");
+    }
+    // up to the largest double, where 2^k alone would overflow
+    for (double x = 709; x <= 709.78; x += 0.01) {
+        assert(std::abs(fast_exp(x) - std::exp(x)) <= 4e-16 * std::exp(x) && "fast_exp overflowed");
+    }
+    for (double x = 1e-300; x < 1e300; x *= 3.7) {
+        assert(std::abs(fast_log(x) - std::log(x)) <= 3e-16 * std::max(1., std::abs(std::log(x))) && "fast_log failed");
+    }
+    for (double x = -40; x < 40; x += 0.013) {
+        assert(std::abs(fast_norm_cdf(x) - 0.5 * std::erfc(-x / std::sqrt(2.))) < 1e-15 && "fast_norm_cdf failed");
+    }
+
+    // batch of 11 quotes (vector lanes and scalar tail), calls and puts against the textbook formulas and put-call parity
+    std::size_t n = 11;
+    std::vector<double> S(n), K(n), T(n), r(n), sigma(n);
+    for (std::size_t i = 0; i < n; i++) {
+        S[i] = 60 + 8 * i;
+        K[i] = 100;
+        T[i] = 0.1 + 0.2 * i;
+        r[i] = 0.01 * i;
+        sigma[i] = 0.1 + 0.03 * i;
+    }
+    std::vector<double> call(6 * n), put(6 * n);
+    black_scholes_batch(OptionType::Call, {S.data(), K.data(), T.data(), r.data(), sigma.data(), n},
+                        {&call[0], &call[n], &call[2 * n], &call[3 * n], &call[4 * n], &call[5 * n]});
+    black_scholes_batch(OptionType::Put, {S.data(), K.data(), T.data(), r.data(), sigma.data(), n},
+                        {&put[0], &put[n], &put[2 * n], &put[3 * n], &put[4 * n], &put[5 * n]});
+    for (std::size_t i = 0; i < n; i++) {
+        double sqrtT = std::sqrt(T[i]);
+        double d1 = (std::log(S[i] / K[i]) + (r[i] + 0.5 * sigma[i] * sigma[i]) * T[i]) / (sigma[i] * sqrtT);
+        double d2 = d1 - sigma[i] * sqrtT;
+        double pdf = std::exp(-0.5 * d1 * d1) / std::sqrt(2 * M_PI);
+        double discountedK = K[i] * std::exp(-r[i] * T[i]);
+        assert(std::abs(call[i] - (S[i] * norm_cdf(d1) - discountedK * norm_cdf(d2))) < 1e-12 && "call price failed");
+        assert(std::abs(call[n + i] - norm_cdf(d1)) < 1e-14 && "call delta failed");
+        assert(std::abs(call[2 * n + i] - pdf / (S[i] * sigma[i] * sqrtT)) < 1e-14 && "gamma failed");
+        assert(std::abs(call[3 * n + i] - (-S[i] * pdf * sigma[i] / (2 * sqrtT) - r[i] * discountedK * norm_cdf(d2))) < 1e-12 && "call theta failed");
+        assert(std::abs(call[4 * n + i] - S[i] * sqrtT * pdf) < 1e-12 && "vega failed");
+        assert(std::abs(call[5 * n + i] - T[i] * discountedK * norm_cdf(d2)) < 1e-12 && "call rho failed");
+
+        assert(std::abs(call[i] - put[i] - (S[i] - discountedK)) < 1e-12 && "put-call parity failed");
+        assert(std::abs(call[n + i] - put[n + i] - 1) < 1e-14 && "put delta failed");
+        assert(call[2 * n + i] == put[2 * n + i] && call[4 * n + i] == put[4 * n + i]);
+        assert(std::abs(call[3 * n + i] - put[3 * n + i] + r[i] * discountedK) < 1e-12 && "put theta failed");
+        assert(std::abs(call[5 * n + i] - put[5 * n + i] - T[i] * discountedK) < 1e-12 && "put rho failed");
+    }
+
+    // the pricers are batches of one
+    BlackScholesPutPricer pricer(S[3], K[3], T[3], r[3], sigma[3]);
+    pricer.price();
+    assert(std::abs(pricer.getPrice() - put[3]) < 1e-14 && std::abs(pricer.rho() - put[5 * n + 3]) < 1e-12);
+    // greeks without a call to price(), as before the batch kernel
+    BlackScholesCallPricer unpriced(S[4], K[4], T[4], r[4], sigma[4]);
+    assert(std::abs(unpriced.delta() - call[n + 4]) < 1e-14 && std::abs(unpriced.gamma() - call[2 * n + 4]) < 1e-14);
+    assert(std::abs(unpriced.theta() - call[3 * n + 4]) < 1e-12 && std::abs(unpriced.vega() - call[4 * n + 4]) < 1e-12);
+    assert(std::abs(unpriced.getPrice() - call[4]) < 1e-12 && "greeks need no call to price()");
+
+    std::cout << "testBlackScholes passed" << std::endl;
+}
+
+int main() {
+    testBlackScholes();
+    return 0;
+}
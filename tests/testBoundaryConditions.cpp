@@ -13,4 +13,47 @@ void testBoundaryConditions() {
     assert(bc.check(0, 0) == false && "Uncheck failed");
     bc.ToggleDir(true, true);
     bc.logMesh();
+
+    // edges are stored as runs: one run per slice for an x edge, one run for a t edge
+    BoundaryConditions edges(7, 5, func);
+    edges.ToggleDir(false, false);
+    edges.ToggleDir(true, false);
+    assert(edges.size() == 7 + 4 && "edge sizes");
+    assert(edges.getRuns(0).size() == 1 && edges.getRuns(0)[0].end == 7 && "t edge merged with the x edge");
+    assert(edges.getRuns(3).size() == 1 && edges.getRuns(3)[0].begin == 0 && edges.getRuns(3)[0].end == 1);
+    edges.uncheck(3, 0); // splits the t edge
+    assert(edges.getRuns(0).size() == 2 && !edges.check(3, 0) && edges.check(2, 0) && edges.check(4, 0));
+    edges.checkRun(0, 2, 5); // merges it back
+    assert(edges.getRuns(0).size() == 1 && edges.size() == 7 + 4);
+    assert(!edges.check(7, 0) && !edges.check(0, 5) && "out of the contour");
+    std::vector<std::size_t> rows;
+    edges.collectSlice(2, 7, rows);
+    assert(rows.size() == 1 && rows[0] == 0);
+    BoundaryConditions wide(8, 5, func); // one node wider than a 7-node mesh
+    wide.ToggleDir(false, true);
+    wide.collectSlice(2, 7, rows);
+    assert(rows.empty() && "row outside the mesh");
+    wide.collectSlice(5, 7, rows);
+    assert(rows.empty() && "slice outside the contour");
+
+    // boundary values only touch the boundary cells, typed and std::function paths agree
+    SpaceTimeMesh stm(0.0, 1.0, 1.0, 7, 5);
+    BoundaryConditions typed(7, 5, [](double t, double x) { return x + t; });
+    typed.ToggleDir(false, true);
+    typed.ToggleDir(true, true);
+    BoundaryConditions erased(typed, func);
+    for (std::size_t n = 0; n < 5; n++) {
+        std::vector<double> a(7, -1), b(7, -1);
+        typed.applySlice(stm, n, a.data());
+        erased.applySlice(stm, n, b.data());
+        for (std::size_t x = 0; x < 7; x++) {
+            assert(a[x] == b[x] && "typed and std::function boundaries differ");
+            assert((a[x] == -1) == !typed.check(x, n) && "boundary written off the frontier");
+        }
+    }
+}
+
+int main() {
+    testBoundaryConditions();
+    return 0;
 }
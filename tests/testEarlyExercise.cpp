@@ -0,0 +1,147 @@
+#include "BatchPricer.hpp"
+#include "MonteCarlo.hpp"
+#include "PricingCache.hpp"
+#include <cassert>
+#include <cmath>
+#include <iostream>
+
+namespace {
+// Cox-Ross-Rubinstein tree, exercise checked at every step or at the given dates only
+double binomial_put(double S0, double K, double T, double r, double sigma, std::size_t steps, const std::vector<double>* dates) {
+    double dt = T / steps;
+    double up = std::exp(sigma * std::sqrt(dt));
+    double p = (std::exp(r * dt) - 1 / up) / (up - 1 / up);
+    double discount = std::exp(-r * dt);
+    std::vector<double> values(steps + 1);
+    for (std::size_t j = 0; j <= steps; j++) {
+        values[j] = std::max(K - S0 * std::pow(up, 2. * j - steps), 0.);
+    }
+    for (std::size_t n = steps; n-- > 0;) {
+        bool exercisable = !dates;
+        for (std::size_t d = 0; dates && d < dates->size(); d++) {
+            exercisable = exercisable || std::abs((*dates)[d] - n * dt) < dt / 2;
+        }
+        for (std::size_t j = 0; j <= n; j++) {
+            values[j] = discount * (p * values[j + 1] + (1 - p) * values[j]);
+            if (exercisable) {
+                values[j] = std::max(values[j], K - S0 * std::pow(up, 2. * j - n));
+            }
+        }
+    }
+    return values[0];
+}
+}
+
+void testEarlyExercise() {
+    Asset underlying(100, ItoDynamics{ConstantDynamics(0, 0)}, ItoDynamics{ConstantDynamics(0, 0)});
+    int N = 401;
+    int N_T = 200;
+    auto vol = [](double t, double x) { return 0.2; };
+    auto rate = [](double t, double x) { return 0.05; };
+    auto zeroBoundary = [](double t, double x) { return 0.; };
+    BoundaryConditions volBC(N, N_T, vol);
+    BoundaryConditions rateBC(N, N_T, rate);
+    BoundaryConditions additionalBC(N, N_T, zeroBoundary);
+    volBC.ToggleDir(true, false);
+    rateBC.ToggleDir(true, false);
+    additionalBC.ToggleDir(false, false);
+    SpaceTimeMesh stm(std::log(100.), 1.0, 1.0, N, N_T);
+    VanillaPutPayoff put{100};
+    VanillaCallPayoff call{100};
+    std::vector<double> dates = {0.25, 0.5, 0.75};
+    Contract european(underlying, put, 1.0);
+    Contract american(underlying, put, 1.0, {ExerciseStyle::American, {}});
+    Contract bermudan(underlying, put, 1.0, {ExerciseStyle::Bermudan, dates});
+
+    // american put against a fine tree, above the bermudan, above the european
+    DiscretePricer europeanPricer(N, N_T, european, 0.2, volBC, rateBC, additionalBC, stm);
+    DiscretePricer americanPricer(N, N_T, american, 0.2, volBC, rateBC, additionalBC, stm);
+    DiscretePricer bermudanPricer(N, N_T, bermudan, 0.2, volBC, rateBC, additionalBC, stm);
+    europeanPricer.price(0.5);
+    americanPricer.price(0.5);
+    bermudanPricer.price(0.5);
+    double treeAmerican = binomial_put(100, 100, 1.0, 0.05, 0.2, 2000, nullptr);
+    double treeBermudan = binomial_put(100, 100, 1.0, 0.05, 0.2, 2000, &dates);
+    assert(std::abs(americanPricer.getPrice() - treeAmerican) < 1e-2 && "american put mismatch");
+    assert(std::abs(bermudanPricer.getPrice() - treeBermudan) < 1e-2 && "bermudan put mismatch");
+    assert(europeanPricer.getPrice() < bermudanPricer.getPrice() && bermudanPricer.getPrice() < americanPricer.getPrice());
+    assert(europeanPricer.getExerciseBoundary().empty());
+    // the american value never falls below the payoff
+    for (std::size_t n = 0; n < stm.get_N_T(); n++) {
+        for (std::size_t i = 0; i < stm.get_N(); i++) {
+            assert(americanPricer.getPriceMesh().getMeshData(i, n) >= put(std::exp(stm.getCoords(i, n).first)) - 1e-12);
+        }
+    }
+
+    // exercise boundary: below the strike, rising towards it at maturity, only on exercise slices for the bermudan
+    const AlignedVector<double>& boundary = americanPricer.getExerciseBoundary();
+    assert(boundary.size() == stm.get_N_T() && std::isnan(boundary.back()));
+    assert(boundary[0] > 80 && boundary[0] < 92 && "american put exercise boundary off");
+    for (std::size_t n = 0; n + 1 < boundary.size(); n++) {
+        assert(boundary[n] < 100 && (n == 0 || boundary[n] >= boundary[n - 1]) && "exercise boundary should rise to the strike");
+    }
+    std::vector<bool> slices = exercise_slices(bermudan.getExercise(), stm);
+    assert(std::count(slices.begin(), slices.end(), true) == 3);
+    for (std::size_t n = 0; n < stm.get_N_T(); n++) {
+        assert(std::isnan(bermudanPricer.getExerciseBoundary()[n]) == !slices[n]);
+    }
+
+    // no early exercise premium on a call without dividends
+    Contract europeanCall(underlying, call, 1.0);
+    Contract americanCall(underlying, call, 1.0, {ExerciseStyle::American, {}});
+    DiscretePricer europeanCallPricer(N, N_T, europeanCall, 0.2, volBC, rateBC, additionalBC, stm);
+    DiscretePricer americanCallPricer(N, N_T, americanCall, 0.2, volBC, rateBC, additionalBC, stm);
+    europeanCallPricer.price(0.5);
+    americanCallPricer.price(0.5);
+    assert(std::abs(americanCallPricer.getPrice() - europeanCallPricer.getPrice()) < 1e-9 && "american call premium without dividends");
+
+    // rolling slices, other precisions, the batch and the cache agree
+    DiscretePricer rolling(N, N_T, american, 0.2, volBC, rateBC, additionalBC, stm, PricingMode::RollingSlices);
+    rolling.price(0.5);
+    assert(rolling.getPrice() == americanPricer.getPrice() && rolling.delta() == americanPricer.delta());
+    for (std::size_t n = 0; n < boundary.size(); n++) {
+        double S = rolling.getExerciseBoundary()[n];
+        assert(S == boundary[n] || (std::isnan(S) && std::isnan(boundary[n])));
+    }
+    DiscretePricer extended(N, N_T, american, 0.2, volBC, rateBC, additionalBC, stm);
+    extended.price(0.5, SolverPrecision::Extended);
+    assert(std::abs(extended.getPrice() - americanPricer.getPrice()) < 1e-9);
+    BatchPricer batch(underlying, stm, volBC, rateBC);
+    std::vector<PricingResult> results = batch.price({european, american, bermudan, americanCall}, additionalBC, 0.5);
+    assert(std::abs(results[0].price - europeanPricer.getPrice()) < 1e-12);
+    assert(std::abs(results[1].price - americanPricer.getPrice()) < 1e-12 && std::abs(results[1].delta - americanPricer.delta()) < 1e-9);
+    assert(std::abs(results[2].price - bermudanPricer.getPrice()) < 1e-12);
+    assert(std::abs(results[3].price - americanCallPricer.getPrice()) < 1e-12);
+    PricingCache cache;
+    cache.price({european, stm, volBC, rateBC, additionalBC, 0.2});
+    assert(cache.price({american, stm, volBC, rateBC, additionalBC, 0.2}).price == americanPricer.getPrice() && "exercise missing from the cache key");
+
+    // rejected: bermudan dates outside the contract, adjoint and Monte Carlo pricings of early exercise
+    bool thrown = false;
+    try {
+        Contract invalid(underlying, put, 1.0, {ExerciseStyle::Bermudan, {1.5}});
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+    thrown = false;
+    try {
+        americanPricer.priceGradient();
+    } catch (const std::logic_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+    thrown = false;
+    try {
+        MonteCarloPricer pricer(american, 0.2, 0.05, MonteCarloSettings());
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+    std::cout << "testEarlyExercise passed" << std::endl;
+}
+
+int main() {
+    testEarlyExercise();
+    return 0;
+}
@@ -0,0 +1,67 @@
+#include "FixedGridPricer.hpp"
+#include <cassert>
+#include <cmath>
+#include <iostream>
+
+void testFixedGrid() {
+    // geometry evaluated at compile time
+    constexpr FixedSpaceTimeMesh<101, 31> unit(0., 1., 1.);
+    static_assert(unit.get_N() == 101 && unit.get_N_T() == 31, "fixed mesh sizes");
+    static_assert(unit.get_dx() == 0.02 && unit.getCoords(50, 0).first == 0 && unit.getCoords(0, 30).second == 1, "fixed mesh geometry");
+
+    // same nodes as the runtime mesh
+    double R = 5 * 0.2;
+    FixedSpaceTimeMesh<101, 31> mesh(std::log(100.), R, 1.0);
+    SpaceTimeMesh stm = mesh.toSpaceTimeMesh();
+    for (std::size_t n = 0; n < 31; n++) {
+        for (std::size_t i = 0; i < 101; i++) {
+            assert(mesh.getCoords(i, n) == stm.getCoords(i, n) && "fixed mesh nodes differ from SpaceTimeMesh");
+        }
+    }
+    assert(mesh.get_dx() == stm.get_dx() && mesh.get_dt() == stm.get_dt());
+
+    // DiscretePricer on the same grid at constant vol/rate, with a zero lower edge then both edges closed
+    int N = 101;
+    int N_T = 31;
+    Asset underlying(100, ItoDynamics{ConstantDynamics(0, 0)}, ItoDynamics{ConstantDynamics(0, 0)});
+    VanillaCallPayoff payoff{105};
+    Contract contract(underlying, payoff, 1.0);
+    auto vol = [](double t, double x) { return 0.2; };
+    auto rate = [](double t, double x) { return 0.05; };
+    auto zeroEdge = [](double t, double x) { return 0.; };
+    BoundaryConditions volBC(N, N_T, vol);
+    BoundaryConditions rateBC(N, N_T, rate);
+    BoundaryConditions zeroBC(N, N_T, zeroEdge);
+    BoundaryConditions noBC(N, N_T, zeroEdge);
+    volBC.ToggleDir(true, false);
+    rateBC.ToggleDir(true, false);
+    zeroBC.ToggleDir(false, false);
+    for (double theta : {0.5, 1.0}) {
+        DiscretePricer reference(N, N_T, contract, 0.2, volBC, rateBC, zeroBC, stm, PricingMode::RollingSlices);
+        reference.price(theta);
+        FixedGridPricer<101, 31> pricer(mesh);
+        pricer.price(payoff, 0.2, 0.05, theta, zeroEdge);
+        PricingResult result = pricer.getResult();
+        assert(std::abs(result.price - reference.getPrice()) < 1e-10 && "fixed grid price off DiscretePricer");
+        assert(std::abs(result.delta - reference.delta()) < 1e-8 && std::abs(result.gamma - reference.gamma()) < 1e-6);
+        assert(std::abs(result.theta - reference.theta()) < 1e-7);
+
+        DiscretePricer closed(N, N_T, contract, 0.2, volBC, rateBC, noBC, stm, PricingMode::RollingSlices);
+        closed.price(theta);
+        pricer.price(payoff, 0.2, 0.05, theta);
+        assert(std::abs(pricer.getPrice() - closed.getPrice()) < 1e-10 && "fixed grid closed edges off DiscretePricer");
+    }
+
+    // close to the closed form on the quoting grid
+    FixedGridPricer<101, 31> pricer(mesh);
+    pricer.price(payoff, 0.2, 0.05, 0.5, zeroEdge);
+    BlackScholesCallPricer closedForm(100, 105, 1.0, 0.05, 0.2);
+    closedForm.price();
+    assert(std::abs(pricer.getPrice() - closedForm.getPrice()) < 5e-2 && "fixed grid price off Black-Scholes");
+    std::cout << "testFixedGrid passed" << std::endl;
+}
+
+int main() {
+    testFixedGrid();
+    return 0;
+}
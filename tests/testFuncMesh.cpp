@@ -10,12 +10,19 @@ void testFunctionMesh() {
     assert(fm.getNumCols() == stm.get_N_T() && "getNumCols failed");
     fm.setMeshData(5, 10, 3.14);
     assert(std::abs(fm.getMeshData(5, 10) - 3.14) < 1e-6 && "getMeshData failed");
-    std::vector<std::vector<bool>> contour(10, std::vector<bool>(20, false));
+    std::vector<std::vector<bool>> contour(stm.get_N(), std::vector<bool>(stm.get_N_T(), false));
     contour[5][10] = true;
     std::function<double( double, double)>  func = [](double x, double y) { return x * y; };
     BoundaryConditions bc(contour, func);
     fm.applyBoundaryConditions(bc);
 
-    assert(std::abs(fm.getMeshData(5, 10) - 5.0) < 1e-6 && "Boundary condition application failed");
+    // the conditions are evaluated as f(t, x) at the coordinates of the node, not at its indices
+    std::pair<double, double> coords = stm.getCoords(5, 10);
+    assert(std::abs(fm.getMeshData(5, 10) - func(coords.second, coords.first)) < 1e-6 && "Boundary condition application failed");
     fm.logMesh();
 }
+
+int main() {
+    testFunctionMesh();
+    return 0;
+}
@@ -0,0 +1,70 @@
+#include "Pricers.hpp"
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+
+void testInstrumentation() {
+    Asset underlying(100, ItoDynamics{ConstantDynamics(0, 0)}, ItoDynamics{ConstantDynamics(0, 0)});
+    VanillaCallPayoff payoff{100};
+    Contract contract(underlying, payoff, 1.0);
+    std::size_t N = 101;
+    std::size_t N_T = 50;
+    auto vol = [](double t, double x) { return 0.2; };
+    auto rate = [](double t, double x) { return 0.05; };
+    auto zeroBoundary = [](double t, double x) { return 0.; };
+    BoundaryConditions volBoundaries(N, N_T, vol);
+    BoundaryConditions rateBoundaries(N, N_T, rate);
+    BoundaryConditions additionalBoundaries(N, N_T, zeroBoundary);
+    volBoundaries.ToggleDir(true, false);
+    rateBoundaries.ToggleDir(true, false);
+    additionalBoundaries.ToggleDir(false, false);
+    SpaceTimeMesh stm(std::log(100.), 1.0, 1.0, N, N_T);
+
+    StatsRegistry::global().reset();
+    DiscretePricer full(N, N_T, contract, 0.2, volBoundaries, rateBoundaries, additionalBoundaries, stm);
+    full.price(0.5);
+    DiscretePricer rolling(N, N_T, contract, 0.2, volBoundaries, rateBoundaries, additionalBoundaries, stm, PricingMode::RollingSlices);
+    rolling.price(0.5);
+    rolling.price(0.5);
+    const PricingStats& fullStats = full.getStats();
+    const PricingStats& rollingStats = rolling.getStats();
+    PricingStats registry = StatsRegistry::global().snapshot();
+
+#ifdef PRICER_INSTRUMENTATION
+    // full grid: both processes solved on the whole mesh in the constructor, t = 0 slice of each given
+    assert(fullStats.pricings == 1 && rollingStats.pricings == 2);
+    assert(fullStats[PricingPhase::ProcessSolve].calls == 1 && fullStats[PricingPhase::ProcessSolve].nodes == 2 * N * N_T);
+    assert(fullStats[PricingPhase::ProcessSolve].allocations == 2);
+    assert(fullStats[PricingPhase::BoundaryApplication].boundaryCalls == 2 * N + N_T);
+    assert(fullStats[PricingPhase::Payoff].nodes == N && fullStats[PricingPhase::Payoff].calls == 1);
+    assert(fullStats[PricingPhase::BackwardSweep].nodes == N * (N_T - 1));
+    assert(fullStats[PricingPhase::BackwardSweep].bytes == N * (N_T - 1) * sizeof(double));
+    // rolling: processes marched once forward and recomputed from checkpoints, boundaries applied slice by slice
+    assert(rollingStats[PricingPhase::ProcessSolve].nodes >= 2 * 2 * N * (N_T - 1));
+    assert(rollingStats[PricingPhase::BoundaryApplication].boundaryCalls == 2 * (2 * N + N_T));
+    // the two rolled slices are the ones kept for the greeks, allocated by the first pricing only
+    assert(rollingStats[PricingPhase::BackwardSweep].allocations == 1 && rollingStats[PricingPhase::BackwardSweep].calls == 2);
+    assert(rollingStats[PricingPhase::BackwardSweep].nanoseconds > 0);
+    // the registry sums every pricer
+    PricingStats sum = fullStats;
+    sum += rollingStats;
+    for (std::size_t p = 0; p < pricingPhaseCount; p++) {
+        assert(registry.phases[p].nodes == sum.phases[p].nodes && registry.phases[p].calls == sum.phases[p].calls);
+    }
+    assert(registry.pricings == 3);
+    std::ostringstream dump;
+    StatsRegistry::global().dump(dump, true);
+    assert(dump.str().find("backward sweep") != std::string::npos);
+    assert(StatsRegistry::global().snapshot().pricings == 0);
+#else
+    // compiled out: nothing recorded
+    assert(fullStats.pricings == 0 && rollingStats.total().calls == 0 && registry.total().nodes == 0);
+#endif
+    std::cout << "testInstrumentation passed" << std::endl;
+}
+
+int main() {
+    testInstrumentation();
+    return 0;
+}
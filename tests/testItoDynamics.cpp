@@ -14,7 +14,15 @@ void testItoDynamics() {
     assert(std::abs(pseudoVol - 6.0) < 1e-6 && "getPseudoVol failed");
     
     auto [converted_t, converted_x] = ItoDynamics::convert_S_to_x(partial_t, partial_x);
-    assert(std::abs(converted_t(1.0, 2.0, 3.0) - 6.0) < 1e-6 && "convert_S_to_x partial_t failed");
-    assert(std::abs(converted_x(1.0, 2.0, 3.0) - 6.0) < 1e-6 && "convert_S_to_x partial_x failed");
+    // in x = log S: drift f(t, e^x, p) + g(t, e^x, p) e^x / 2, pseudo vol g(t, e^x, p) e^x
+    double S = std::exp(2.0);
+    double g = 1.0 * S * 3.0;
+    assert(std::abs(converted_t(1.0, 2.0, 3.0) - (1.0 + S + 3.0 + g * S / 2)) < 1e-6 && "convert_S_to_x partial_t failed");
+    assert(std::abs(converted_x(1.0, 2.0, 3.0) - g * S) < 1e-6 && "convert_S_to_x partial_x failed");
     
 }
+
+int main() {
+    testItoDynamics();
+    return 0;
+}
@@ -1,12 +1,13 @@
 #include "ItoProcess.hpp"
 #include "MeshUtils.hpp"
 #include <cassert>
+#include <cmath>
 #include <iostream>
 
 void testItoProcess() {
     SpaceTimeMesh stm(0.0, 1.0, 2.0, 11, 20);
     ItoProcess process(stm);
-    std::vector<std::vector<bool>> contour(10, std::vector<bool>(20, false));
+    std::vector<std::vector<bool>> contour(stm.get_N(), std::vector<bool>(stm.get_N_T(), false));
     contour[0][0] = true;
     std::function<double(double, double)>  boundaryFunc = [](double x, double t) { return x + t; };
     BoundaryConditions bc(contour, boundaryFunc);
@@ -17,10 +18,16 @@ void testItoProcess() {
 
     process.solve(bc, dynamics);
     double val = process.getVal(0, 0);
-    assert(std::abs(val - boundaryFunc(0.0, 0.0)) < 1e-6 && "getVal failed");
+    // boundary values are f(t, x) at the coordinates of the node: x = -1, t = 0 for node (0, 0)
+    std::pair<double, double> coords = stm.getCoords(0, 0);
+    assert(std::abs(val - boundaryFunc(coords.second, coords.first)) < 1e-6 && "getVal failed");
     const FunctionMesh& mesh = process.getProcessMesh();
     assert(mesh.getNumRows() == stm.get_N() && "Process mesh row size mismatch");
     assert(mesh.getNumCols() == stm.get_N_T() && "Process mesh column size mismatch");
     process.logMesh();
+}
 
+int main() {
+    testItoProcess();
+    return 0;
 }
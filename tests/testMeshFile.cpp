@@ -0,0 +1,106 @@
+#include "MeshFile.hpp"
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+void testMeshFile() {
+    Asset underlying(100, ItoDynamics{ConstantDynamics(0, 0.1)}, ItoDynamics{ConstantDynamics(0, 0)});
+    VanillaCallPayoff payoff{100};
+    Contract contract(underlying, payoff, 1.0);
+    int N = 101;
+    int N_T = 37;
+    auto vol = [](double t, double x) { return 0.2; };
+    auto rate = [](double t, double x) { return 0.05; };
+    auto zeroBoundary = [](double t, double x) { return 0.; };
+    BoundaryConditions volBC(N, N_T, vol);
+    BoundaryConditions rateBC(N, N_T, rate);
+    BoundaryConditions additionalBC(N, N_T, zeroBoundary);
+    volBC.ToggleDir(true, false);
+    rateBC.ToggleDir(true, false);
+    additionalBC.ToggleDir(false, false);
+    const std::string path = "testMeshFile.bin";
+
+    for (bool stretched : {false, true}) {
+        SpaceTimeMesh stm = stretched ? SpaceTimeMesh(std::log(100.), 1.0, 1.0, N, N_T, MeshStretching{{std::log(100.)}, 6, 0.3})
+                                      : SpaceTimeMesh(std::log(100.), 1.0, 1.0, N, N_T);
+        DiscretePricer pricer(N, N_T, contract, 0.2, volBC, rateBC, additionalBC, stm);
+        pricer.price(0.5);
+        write_mesh_file(path, pricer);
+
+        // every value read back in place, bit for bit, on the same nodes
+        MappedMeshFile file(path);
+        assert(file.getKind() == MeshFileKind::Pricing && file.getMeshCount() == 3);
+        assert(file.get_N() == stm.get_N() && file.get_N_T() == stm.get_N_T());
+        const FunctionMesh* meshes[3] = {&pricer.getPriceMesh(), &pricer.getVolApprox().getProcessMesh(), &pricer.getRateApprox().getProcessMesh()};
+        for (std::size_t k = 0; k < 3; k++) {
+            MeshView view = file.getMesh(k);
+            assert(reinterpret_cast<std::uintptr_t>(view.data()) % 64 == 0);
+            for (std::size_t n = 0; n < stm.get_N_T(); n++) {
+                for (std::size_t i = 0; i < stm.get_N(); i++) {
+                    assert(view.getMeshData(i, n) == meshes[k]->getMeshData(i, n) && "mesh file value changed");
+                }
+            }
+            assert(view.getRow(7)[5] == meshes[k]->getMeshData(7, 5) && view.getTimeSlice(5)[7] == meshes[k]->getMeshData(7, 5));
+        }
+        SpaceTimeMesh loaded = file.getSpaceTimeMesh();
+        assert(loaded.isUniformX() == stm.isUniformX() && loaded.isUniformT() == stm.isUniformT());
+        assert(loaded.get_R() == stm.get_R() && loaded.get_T() == stm.get_T() && loaded.get_dx() == stm.get_dx());
+        for (std::size_t i = 0; i < stm.get_N(); i++) {
+            assert(loaded.getXNodes()[i] == stm.getXNodes()[i]);
+        }
+        for (std::size_t n = 0; n + 1 < stm.get_N_T(); n++) {
+            assert(loaded.getCoords(0, n) == stm.getCoords(0, n) && loaded.get_dt(n) == stm.get_dt(n));
+        }
+
+        // a surface straight from the mapped prices
+        PriceSurface surface(loaded, file.getMesh(0).data());
+        assert(surface.evaluate(97.5, 0.3).price == pricer.getSurface().evaluate(97.5, 0.3).price);
+
+        // still mapped after a move
+        MappedMeshFile moved(std::move(file));
+        assert(moved.getMesh(0).getMeshData(N / 2, 0) == pricer.getPrice());
+    }
+
+    // a lone mesh and a process
+    SpaceTimeMesh stm(std::log(100.), 1.0, 1.0, N, N_T);
+    ItoProcess process(stm);
+    process.solve(volBC, underlying.getVolDynamics());
+    write_mesh_file(path, process);
+    assert(MappedMeshFile(path).getKind() == MeshFileKind::Process);
+    assert(MappedMeshFile(path).getMesh().getMeshData(3, 4) == process.getProcessMesh().getMeshData(3, 4));
+    write_mesh_file(path, process.getProcessMesh());
+    assert(MappedMeshFile(path).getKind() == MeshFileKind::Function && MappedMeshFile(path).getMeshCount() == 1);
+
+    // rejected: rolling pricers, truncated files, other files
+    DiscretePricer rolling(N, N_T, contract, 0.2, volBC, rateBC, additionalBC, stm, PricingMode::RollingSlices);
+    rolling.price(0.5);
+    bool thrown = false;
+    try {
+        write_mesh_file(path, rolling);
+    } catch (const std::logic_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+    std::ifstream in(path, std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+    for (const std::string& damaged : {content.substr(0, content.size() - 8), "not a mesh" + content.substr(10), std::string("short")}) {
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << damaged;
+        thrown = false;
+        try {
+            MappedMeshFile file(path);
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        assert(thrown && "damaged mesh file accepted");
+    }
+    std::remove(path.c_str());
+    std::cout << "testMeshFile passed" << std::endl;
+}
+
+int main() {
+    testMeshFile();
+    return 0;
+}
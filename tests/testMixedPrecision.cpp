@@ -0,0 +1,85 @@
+#include "BatchPricer.hpp"
+#include <cassert>
+#include <cmath>
+#include <iostream>
+
+void testMixedPrecision() {
+    Asset underlying(100, ItoDynamics{ConstantDynamics(0, 0.1)}, ItoDynamics{ConstantDynamics(0, 0)});
+    int N = 201;
+    int N_T = 100;
+    auto vol = [](double t, double x) { return 0.2; };
+    auto rate = [](double t, double x) { return 0.05; };
+    auto zeroBoundary = [](double t, double x) { return 0.; };
+    BoundaryConditions volBC(N, N_T, vol);
+    BoundaryConditions rateBC(N, N_T, rate);
+    BoundaryConditions additionalBC(N, N_T, zeroBoundary);
+    volBC.ToggleDir(true, false);
+    rateBC.ToggleDir(true, false);
+    additionalBC.ToggleDir(false, false);
+    SpaceTimeMesh stm(std::log(100.), 1.0, 1.0, N, N_T);
+
+    // float and long double processes: the double one rounded
+    ItoProcess process(stm);
+    process.solve(volBC, underlying.getVolDynamics());
+    BasicItoProcess<float> single(stm);
+    single.solve(volBC, underlying.getVolDynamics());
+    BasicItoProcess<long double> extended(stm);
+    extended.solve(volBC, underlying.getVolDynamics());
+    for (std::size_t n = 0; n < stm.get_N_T(); n++) {
+        for (std::size_t i = 0; i < stm.get_N(); i++) {
+            double value = process.getProcessMesh().getMeshData(i, n);
+            assert(std::abs(single.getProcessMesh().getMeshData(i, n) - value) <= 1e-6 * std::abs(value) && "float process mismatch");
+            assert(std::abs(extended.getProcessMesh().getMeshData(i, n) - value) <= 1e-12 * std::abs(value) && "long double process mismatch");
+        }
+    }
+    assert(single.getProcessMesh().getTimeSlice(3)[7] == single.getProcessMesh().getMeshData(7, 3));
+    BasicFunctionMesh<float> mesh(stm);
+    mesh.applyBoundaryConditions(rateBC);
+    assert(mesh.getMeshData(0, 0) == 0.05f && mesh.getTimeSlice(0)[N - 1] == 0.05f);
+
+    // mixed batch: float processes, double sweep, against the double batch and Black-Scholes
+    Asset flat(100, ItoDynamics{ConstantDynamics(0, 0)}, ItoDynamics{ConstantDynamics(0, 0)});
+    std::vector<VanillaCallPayoff> payoffs;
+    for (double K : {90., 100., 110.}) {
+        payoffs.push_back({K});
+    }
+    std::vector<Contract> contracts;
+    for (const VanillaCallPayoff& payoff : payoffs) {
+        contracts.emplace_back(flat, payoff, 1.0);
+    }
+    for (bool stretched : {false, true}) {
+        SpaceTimeMesh grid = stretched ? SpaceTimeMesh(std::log(100.), 1.0, 1.0, N, N_T, MeshStretching{{std::log(100.)}, 4, 0})
+                                       : SpaceTimeMesh(std::log(100.), 1.0, 1.0, N, N_T);
+        BatchPricer batch(flat, grid, volBC, rateBC);
+        MixedBatchPricer mixed(flat, grid, volBC, rateBC);
+        assert(mixed.memoryFootprint() * 5 == batch.memoryFootprint() && "mixed storage should take a fifth of the memory");
+        std::vector<PricingResult> expected = batch.price(contracts, additionalBC, 0.5);
+        std::vector<PricingResult> results = mixed.price(contracts, additionalBC, 0.5);
+        for (std::size_t k = 0; k < contracts.size(); k++) {
+            assert(std::abs(results[k].price - expected[k].price) < 1e-5 && "mixed price too far from double");
+            assert(std::abs(results[k].delta - expected[k].delta) < 1e-5 && "mixed delta too far from double");
+            BlackScholesCallPricer reference(100, payoffs[k].K, 1.0, 0.05, 0.2);
+            reference.price();
+            assert(std::abs(results[k].price - reference.getPrice()) < 5e-3 && "mixed price too far from Black-Scholes");
+        }
+    }
+
+    // double and extended solvers are second order, the single one stops converging
+    VanillaCallPayoff atm{100};
+    Contract call(flat, atm, 1.0);
+    BlackScholesCallPricer reference(100, 100, 1.0, 0.05, 0.2);
+    reference.price();
+    double errors[3];
+    for (SolverPrecision precision : {SolverPrecision::Single, SolverPrecision::Double, SolverPrecision::Extended}) {
+        DiscretePricer pricer(N, N_T, call, 0.2, volBC, rateBC, additionalBC, stm);
+        pricer.price(0.5, precision);
+        errors[static_cast<int>(precision)] = std::abs(pricer.getPrice() - reference.getPrice());
+    }
+    assert(errors[1] < 3e-3 && std::abs(errors[2] - errors[1]) < 1e-9 && errors[0] < 1e-2);
+    std::cout << "testMixedPrecision passed" << std::endl;
+}
+
+int main() {
+    testMixedPrecision();
+    return 0;
+}
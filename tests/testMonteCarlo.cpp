@@ -0,0 +1,84 @@
+#include "MonteCarlo.hpp"
+#include "Pricers.hpp"
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+void testMonteCarlo() {
+    // Philox known answers (Random123 test vectors)
+    assert((philox4x32({0, 0, 0, 0}, {0, 0}) == std::array<std::uint32_t, 4>{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}));
+    assert((philox4x32({0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}, {0xa4093822, 0x299f31d0}) ==
+            std::array<std::uint32_t, 4>{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}));
+
+    for (double p = 1e-12; p < 1; p += 0.0137) {
+        double x = inverse_norm_cdf(p);
+        assert(std::abs(0.5 * std::erfc(-x / std::sqrt(2.)) - p) < 1e-14 && "inverse_norm_cdf failed");
+    }
+
+    // first 2^10 Sobol points: one point per interval of length 2^-10 in every dimension, next() follows point()
+    SobolSequence sobol(SobolSequence::maxDimensions);
+    std::vector<std::uint32_t> words(SobolSequence::maxDimensions), direct(SobolSequence::maxDimensions);
+    std::vector<int> hits(SobolSequence::maxDimensions << 10, 0);
+    sobol.point(0, words.data());
+    for (std::uint64_t i = 0; i < 1024; i++) {
+        sobol.point(i, direct.data());
+        assert(direct == words && "Sobol Gray code step failed");
+        for (std::size_t d = 0; d < SobolSequence::maxDimensions; d++) {
+            hits[(d << 10) + (words[d] >> 22)]++;
+        }
+        sobol.next(i, words.data());
+    }
+    for (int count : hits) {
+        assert(count == 1 && "Sobol stratification failed");
+    }
+
+    // constant vol and rate: every variance reduction converges to the closed form, whatever the thread count
+    Asset underlying(100, ItoDynamics{ConstantDynamics(0, 0)}, ItoDynamics{ConstantDynamics(0, 0)});
+    VanillaCallPayoff payoff{100};
+    Contract contract(underlying, payoff, 1.0);
+    BlackScholesCallPricer closedForm(100, 100, 1.0, 0.05, 0.2);
+    closedForm.price();
+    ThreadPool one(1), three(3);
+    for (RandomSource source : {RandomSource::Pseudo, RandomSource::Sobol}) {
+        for (bool antithetic : {false, true}) {
+            MonteCarloSettings settings;
+            settings.paths = 20001;
+            settings.steps = 25;
+            settings.source = source;
+            settings.antithetic = antithetic;
+            settings.seed = 42;
+            MonteCarloPricer pricer(contract, 0.2, 0.05, settings);
+            MonteCarloResult result = pricer.price();
+            assert(std::abs(result.price - closedForm.getPrice()) < 4 * result.standardError && "Monte Carlo price failed");
+            MonteCarloResult single = pricer.price(one);
+            MonteCarloResult shared = pricer.price(three);
+            assert(single.price == result.price && shared.price == result.price && shared.standardError == result.standardError);
+
+            // the control follows the simulated path exactly here
+            settings.controlStrike = 100;
+            MonteCarloResult controlled = MonteCarloPricer(contract, 0.2, 0.05, settings).price();
+            assert(std::abs(controlled.price - closedForm.getPrice()) < 1e-8 && controlled.standardError < 1e-8);
+        }
+    }
+
+    // vol moving with x: Euler and Milstein agree within their errors, the control still reduces the variance
+    Asset localVol(100, ItoDynamics{ConstantDynamics(0, 0.3)}, ItoDynamics{ConstantDynamics(0, 0)});
+    Contract localVolContract(localVol, payoff, 1.0);
+    MonteCarloSettings settings;
+    settings.paths = 20000;
+    settings.steps = 50;
+    MonteCarloResult euler = MonteCarloPricer(localVolContract, 0.2, 0.05, settings).price();
+    settings.scheme = Discretization::Milstein;
+    settings.controlStrike = 100;
+    MonteCarloResult milstein = MonteCarloPricer(localVolContract, 0.2, 0.05, settings).price();
+    assert(milstein.standardError < euler.standardError / 2);
+    assert(std::abs(milstein.price - euler.price) < 4 * euler.standardError);
+
+    std::cout << "testMonteCarlo passed" << std::endl;
+}
+
+int main() {
+    testMonteCarlo();
+    return 0;
+}
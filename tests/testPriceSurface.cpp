@@ -0,0 +1,87 @@
+#include "Pricers.hpp"
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+
+void testPriceSurface() {
+    Asset underlying(100, ItoDynamics{ConstantDynamics(0, 0)}, ItoDynamics{ConstantDynamics(0, 0)});
+    VanillaCallPayoff payoff{100};
+    Contract contract(underlying, payoff, 1.0);
+    int N = 401;
+    int N_T = 200;
+    auto vol = [](double t, double x) { return 0.2; };
+    auto rate = [](double t, double x) { return 0.05; };
+    auto zeroBoundary = [](double t, double x) { return 0.; };
+    BoundaryConditions volBoundaries(N, N_T, vol);
+    BoundaryConditions rateBoundaries(N, N_T, rate);
+    BoundaryConditions additionalBoundaries(N, N_T, zeroBoundary);
+    volBoundaries.ToggleDir(true, false);
+    rateBoundaries.ToggleDir(true, false);
+    additionalBoundaries.ToggleDir(false, false);
+    MeshStretching stretching;
+    stretching.concentration = 8;
+    stretching.timeGrading = 0.3;
+
+    for (bool stretched : {false, true}) {
+        SpaceTimeMesh stm = stretched ? SpaceTimeMesh(std::log(100.), 1.0, 1.0, N, N_T, stretching) : SpaceTimeMesh(std::log(100.), 1.0, 1.0, N, N_T);
+        DiscretePricer pricer(N, N_T, contract, 0.2, volBoundaries, rateBoundaries, additionalBoundaries, stm);
+        pricer.price(0.5);
+        PriceSurface surface = pricer.getSurface();
+
+        // nodes are reproduced, greeks agree with the pricer's (in x) at S0
+        assert(std::abs(surface.price(100, 0) - pricer.getPrice()) < 1e-12);
+        SurfacePoint atSpot = surface.evaluate(100, 0);
+        assert(std::abs(atSpot.delta * 100 - pricer.delta()) < 1e-3);
+        assert(std::abs(atSpot.gamma * 100 * 100 + atSpot.delta * 100 - pricer.gamma()) < 5e-2);
+
+        // anywhere inside the mesh: close to the closed form with the remaining maturity (close to maturity, the
+        // Crank-Nicolson steps on the finer stretched nodes still ring around the strike)
+        std::vector<double> ladder;
+        for (double S = 70; S <= 140; S += 3.7) {
+            ladder.push_back(S);
+        }
+        for (double t : {0., 0.13, 0.5, 0.77}) {
+            if (stretched && t > 0.5) {
+                continue;
+            }
+            std::vector<SurfacePoint> points = surface.evaluate(ladder, t);
+            for (std::size_t k = 0; k < ladder.size(); k++) {
+                BlackScholesCallPricer closedForm(ladder[k], 100, 1.0 - t, 0.05, 0.2);
+                closedForm.price();
+                assert(std::abs(points[k].price - closedForm.getPrice()) < 3e-3 && "surface price failed");
+                assert(std::abs(points[k].delta - closedForm.delta()) < 3e-4 && "surface delta failed");
+                assert(std::abs(points[k].gamma - closedForm.gamma()) < 5e-5 && "surface gamma failed");
+                assert(std::abs(points[k].theta - closedForm.theta()) < 5e-3 && "surface theta failed");
+            }
+        }
+        assert(std::abs(surface.maxSpot() - 100 * std::exp(1.)) < 1e-9 && surface.getT() == 1.0);
+        surface.evaluate(surface.minSpot(), 1.0);
+        surface.evaluate(surface.maxSpot(), 0.0);
+        bool outside = false;
+        try {
+            surface.evaluate(surface.maxSpot() * 1.01, 0.5);
+        } catch (const std::out_of_range&) {
+            outside = true;
+        }
+        assert(outside && "query outside of the mesh accepted");
+    }
+
+    // rolling pricers don't keep the surface
+    SpaceTimeMesh stm(std::log(100.), 1.0, 1.0, N, N_T);
+    DiscretePricer rolling(N, N_T, contract, 0.2, volBoundaries, rateBoundaries, additionalBoundaries, stm, PricingMode::RollingSlices);
+    rolling.price(0.5);
+    bool thrown = false;
+    try {
+        rolling.getSurface();
+    } catch (const std::logic_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+    std::cout << "testPriceSurface passed" << std::endl;
+}
+
+int main() {
+    testPriceSurface();
+    return 0;
+}
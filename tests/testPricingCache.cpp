@@ -0,0 +1,142 @@
+#include "PricingCache.hpp"
+#include <cassert>
+#include <cmath>
+#include <future>
+#include <iostream>
+
+void testPricingCache() {
+    Asset underlying(100, ItoDynamics{ConstantDynamics(0, 0)}, ItoDynamics{ConstantDynamics(0, 0)});
+    Asset twin(100, ItoDynamics{ConstantDynamics(0, 0)}, ItoDynamics{ConstantDynamics(0, 0)});
+    Asset drifting(100, ItoDynamics{ConstantDynamics(0.01, 0)}, ItoDynamics{ConstantDynamics(0, 0)});
+    std::function<double(double, double, double)> zero = [](double t, double x, double p) { return 0.; };
+    Asset erased(100, ItoDynamics(zero, zero), ItoDynamics{ConstantDynamics(0, 0)});
+    Asset timeDependent(100, ItoDynamics{ConstantDynamics(0, 0)}, ItoDynamics{TimeDependentDynamics([](double t) { return 0.; })});
+    VanillaCallPayoff call{100};
+    VanillaCallPayoff sameCall{100};
+    VanillaCallPayoff otherCall{105};
+    Contract contract(underlying, call, 1.0);
+    int N = 101;
+    int N_T = 50;
+    SpaceTimeMesh stm(std::log(100.), 1.0, 1.0, N, N_T);
+    auto vol = [](double t, double x) { return 0.2; };
+    auto rate = [](double t, double x) { return 0.05; };
+    auto zeroBoundary = [](double t, double x) { return 0.; };
+    BoundaryConditions volBC(N, N_T, vol);
+    BoundaryConditions rateBC(N, N_T, rate);
+    BoundaryConditions additionalBC(N, N_T, zeroBoundary);
+    volBC.ToggleDir(true, false);
+    rateBC.ToggleDir(true, false);
+    additionalBC.ToggleDir(false, false);
+    PricingJob job{contract, stm, volBC, rateBC, additionalBC, 0.2};
+
+    // same result as the pricer, the second time from the cache
+    PricingCache cache(3);
+    DiscretePricer pricer(N, N_T, contract, 0.2, volBC, rateBC, additionalBC, stm);
+    pricer.price(0.5);
+    PricingResult expected = pricer.getResult();
+    PricingResult first = cache.price(job);
+    PricingResult second = cache.price(job);
+    assert(first.price == expected.price && first.delta == expected.delta && first.gamma == expected.gamma && first.theta == expected.theta);
+    assert(second.price == first.price && second.theta == first.theta);
+    PricingCacheStats stats = cache.getStats();
+    assert(stats.hits == 1 && stats.misses == 1 && stats.size == 1);
+
+    // keyed by content: equal payoffs, meshes, boundaries and value dynamics built separately hit
+    Contract sameContract(twin, sameCall, 1.0);
+    SpaceTimeMesh sameMesh(std::log(100.), 1.0, 1.0, N, N_T);
+    BoundaryConditions sameVolBC(N, N_T, [](double t, double x) { return 0.2; });
+    sameVolBC.ToggleDir(true, false);
+    assert(PricingKey(PricingJob{sameContract, sameMesh, sameVolBC, rateBC, additionalBC, 0.2}) == PricingKey(job));
+    // conditions wider or shorter than the mesh are keyed by the nodes they write inside of it
+    BoundaryConditions wideFrontier(N + 1, N_T, zeroBoundary);
+    wideFrontier.ToggleDir(false, false);
+    BoundaryConditions shortVolBC(N, 3, vol);
+    shortVolBC.ToggleDir(true, false);
+    assert(PricingKey(PricingJob{contract, stm, shortVolBC, rateBC, wideFrontier, 0.2}) == PricingKey(job));
+    // type erased payoffs are tabulated
+    std::function<double(double)> erasedCall = call;
+    std::function<double(double)> erasedSameCall = [](double S) { return std::max(S - 100, 0.); };
+    Contract tabulated(underlying, erasedCall, 1.0);
+    Contract sameTabulated(underlying, erasedSameCall, 1.0);
+    assert(PricingKey(PricingJob{tabulated, stm, volBC, rateBC, additionalBC, 0.2}) ==
+           PricingKey(PricingJob{sameTabulated, stm, volBC, rateBC, additionalBC, 0.2}));
+
+    // any input the sweep reads changes the key
+    Contract otherContract(underlying, otherCall, 1.0);
+    Contract driftingContract(drifting, call, 1.0);
+    Contract erasedContract(erased, call, 1.0);
+    Contract timeDependentContract(timeDependent, call, 1.0);
+    SpaceTimeMesh stretched(std::log(100.), 1.0, 1.0, N, N_T, MeshStretching{{}, 4, 0});
+    BoundaryConditions otherVolBC(N, N_T, [](double t, double x) { return 0.25; });
+    otherVolBC.ToggleDir(true, false);
+    BoundaryConditions otherFrontier(N, N_T, zeroBoundary);
+    otherFrontier.ToggleDir(false, true);
+    PricingJob implicit = job;
+    implicit.theta = 1;
+    PricingJob single = job;
+    single.precision = SolverPrecision::Single;
+    for (const PricingJob& other : {PricingJob{otherContract, stm, volBC, rateBC, additionalBC, 0.2},
+                                    PricingJob{driftingContract, stm, volBC, rateBC, additionalBC, 0.2},
+                                    PricingJob{contract, stretched, volBC, rateBC, additionalBC, 0.2},
+                                    PricingJob{contract, stm, otherVolBC, rateBC, additionalBC, 0.2},
+                                    PricingJob{contract, stm, volBC, rateBC, otherFrontier, 0.2},
+                                    PricingJob{contract, stm, volBC, rateBC, additionalBC, 0.3}, implicit, single}) {
+        assert(!(PricingKey(other) == PricingKey(job)) && "pricing key collision");
+    }
+    // a payoff capturing its strike by reference is keyed by what it pays, not by the address it captured
+    double strike = 100;
+    Contract byReference(underlying, [&strike](double S) { return std::max(S - strike, 0.); }, 1.0);
+    PricingKey atTheMoney(PricingJob{byReference, stm, volBC, rateBC, additionalBC, 0.2});
+    assert(atTheMoney == PricingKey(job));
+    strike = 105;
+    assert(!(PricingKey(PricingJob{byReference, stm, volBC, rateBC, additionalBC, 0.2}) == atTheMoney));
+    // dynamics without a value identity aren't cached: their key equals no key, not even itself
+    PricingJob erasedJob{erasedContract, stm, volBC, rateBC, additionalBC, 0.2};
+    PricingJob timeDependentJob{timeDependentContract, stm, volBC, rateBC, additionalBC, 0.2};
+    for (const PricingJob& uncached : {erasedJob, timeDependentJob}) {
+        assert(!PricingKey(uncached).cacheable && !(PricingKey(uncached) == PricingKey(uncached)) && "dynamics keyed without their values");
+    }
+
+    // least recently used entry evicted first
+    cache.price(implicit);
+    cache.price(single);
+    cache.price(job); // refreshes job
+    cache.price(PricingJob{otherContract, stm, volBC, rateBC, additionalBC, 0.2}); // evicts implicit
+    stats = cache.getStats();
+    assert(stats.evictions == 1 && stats.size == 3 && stats.hits == 2);
+    assert(cache.find(PricingKey(single)) && cache.find(PricingKey(job)) && !cache.find(PricingKey(implicit)));
+    // priced every time, never stored
+    DiscretePricer erasedPricer(N, N_T, erasedContract, 0.2, volBC, rateBC, additionalBC, stm);
+    erasedPricer.price(0.5);
+    assert(cache.price(erasedJob).price == erasedPricer.getPrice() && cache.price(erasedJob).price == erasedPricer.getPrice());
+    stats = cache.getStats();
+    assert(stats.size == 3 && stats.evictions == 1 && stats.hits == 4);
+
+    // shared between threads
+    cache.clear();
+    std::vector<std::future<PricingResult>> futures;
+    for (int k = 0; k < 24; k++) {
+        const PricingJob& shared = k % 2 ? job : implicit;
+        futures.push_back(std::async(std::launch::async, [&cache, &shared]() { return cache.price(shared); }));
+    }
+    for (int k = 0; k < 24; k++) {
+        PricingResult result = futures[k].get();
+        assert(k % 2 == 0 || result.price == expected.price);
+    }
+    stats = cache.getStats();
+    assert(stats.size == 2 && stats.hits + stats.misses == 2 + 4 + 3 + 2 + 24);
+
+    bool thrown = false;
+    try {
+        PricingCache empty(0);
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+    std::cout << "testPricingCache passed" << std::endl;
+}
+
+int main() {
+    testPricingCache();
+    return 0;
+}
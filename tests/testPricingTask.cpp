@@ -0,0 +1,89 @@
+#include "PricingCache.hpp"
+#include "PricingPool.hpp"
+#include <cassert>
+#include <cmath>
+#include <iostream>
+
+namespace {
+// every lambda, the asset and the mesh are locals of this function: the tasks must not refer to them once it returns
+std::vector<PricingTask> build_tasks(int N, int N_T, std::shared_ptr<const MarketData>& market) {
+    double sigma_0 = 0.2;
+    double r_0 = 0.05;
+    auto underlying = std::make_shared<const Asset>(100, ItoDynamics{ConstantDynamics(0, 0)}, ItoDynamics{ConstantDynamics(0, 0)});
+    SpaceTimeMesh stm(std::log(100.), 5 * sigma_0, 1, N, N_T);
+    std::function<double(double, double)> vol = [sigma_0](double t, double x) { return sigma_0; };
+    BoundaryConditions volBC(N, N_T, vol);
+    BoundaryConditions rateBC(N, N_T, std::function<double(double, double)>([r_0](double t, double x) { return r_0; }));
+    volBC.ToggleDir(true, false);
+    rateBC.ToggleDir(true, false);
+    vol = [](double t, double x) { return 1.; }; // the conditions own a copy of the function
+    market = std::make_shared<const MarketData>(MarketData{stm, volBC, rateBC});
+
+    auto noEdge = std::make_shared<const BoundaryConditions>(N, N_T, [](double t, double x) { return 0.; });
+    auto putEdge = std::make_shared<BoundaryConditions>(N, N_T, [r_0](double t, double x) { return 100 * std::exp(-r_0 * (1 - t)) - std::exp(x); });
+    putEdge->ToggleDir(false, false);
+    std::vector<PricingTask> tasks;
+    for (int k = 0; k < 8; k++) {
+        tasks.push_back(PricingTask{market, Contract(underlying, VanillaCallPayoff{80. + 5 * k}, 1), noEdge, sigma_0});
+    }
+    tasks.push_back(PricingTask{market, Contract(underlying, std::function<double(double)>([](double S) { return std::max(100 - S, 0.); }), 1),
+                                putEdge, sigma_0, 1.0});
+    tasks.push_back(PricingTask{market, Contract(underlying, VanillaPutPayoff{100}, 1, {ExerciseStyle::American, {}}), putEdge, sigma_0});
+    return tasks;
+}
+}
+
+void testPricingTask() {
+    int N = 101;
+    int N_T = 50;
+    std::shared_ptr<const MarketData> market;
+    std::vector<PricingTask> tasks = build_tasks(N, N_T, market);
+    assert(market.use_count() == 1 + static_cast<long>(tasks.size()) && "the tasks share one copy of the market data");
+
+    // same prices as the referencing jobs built on the same objects
+    std::vector<PricingResult> expected;
+    for (const PricingTask& task : tasks) {
+        PricingJob job = task.view();
+        DiscretePricer pricer(N, N_T, job.contract, job.sigma_0, job.volBC, job.rateBC, job.additionalBC, job.stm);
+        pricer.price(job.theta, job.precision);
+        expected.push_back(pricer.getResult());
+    }
+    BlackScholesCallPricer closedForm(100, 100, 1, 0.05, 0.2);
+    closedForm.price();
+    assert(std::abs(expected[4].price - closedForm.getPrice()) < 5e-2 && "task priced on dangling market data");
+
+    // moved into the pool (no copy of the mesh or of the conditions), then the caller's handles are dropped
+    PricingPool pool(3);
+    std::vector<std::future<PricingResult>> futures;
+    for (PricingTask& task : tasks) {
+        futures.push_back(pool.submit(std::move(task)));
+    }
+    tasks.clear();
+    market.reset();
+    for (std::size_t k = 0; k < futures.size(); k++) {
+        PricingResult result = futures[k].get();
+        assert(result.price == expected[k].price && result.delta == expected[k].delta && "moved task priced differently");
+    }
+
+    // batch of tasks, results in order; a task is also a cache key
+    std::vector<PricingTask> batch = build_tasks(N, N_T, market);
+    PricingCache cache(4);
+    PricingResult cached = cache.price(batch[0].view());
+    std::vector<PricingResult> results = pool.priceAll(std::move(batch));
+    assert(results.size() == expected.size() && results[9].price == expected[9].price && cached.price == expected[0].price);
+
+    // a contract can't be built without an underlying
+    bool thrown = false;
+    try {
+        Contract orphan(std::shared_ptr<const Asset>(), VanillaCallPayoff{100}, 1);
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+    std::cout << "testPricingTask passed" << std::endl;
+}
+
+int main() {
+    testPricingTask();
+    return 0;
+}
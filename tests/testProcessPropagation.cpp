@@ -0,0 +1,42 @@
+#include "ItoProcess.hpp"
+#include "MeshUtils.hpp"
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+
+void testProcessPropagation() {
+    // general layout from a single interior node: with constant coefficients every path gives p0 + v*(x - x0) + c*(t - t0)
+    SpaceTimeMesh wide(0.0, 1.0, 1.0, 51, 40);
+    BoundaryConditions point(51, 40, [](double t, double x) { return 1.0; });
+    point.ToggleDir(true, false);
+    for (std::size_t x = 0; x < 51; x++) {
+        if (x != 20) point.uncheck(x, 0);
+    }
+    ItoProcess general(wide);
+    ItoDynamics constant{ConstantDynamics(0.5, 2.0)};
+    assert(ItoProcess::detectLayout(point, 51, 40) == ProcessLayout::General);
+    general.solve(point, constant);
+    for (std::size_t x = 0; x < 51; x++) {
+        for (std::size_t n = 0; n < 40; n++) {
+            double expected = 1.0 + 2.0 * (static_cast<double>(x) - 20) * wide.get_dx() + 0.5 * n * wide.get_dt();
+            assert(std::abs(general.getVal(x, n) - expected) < 1e-9 && "general propagation failed");
+        }
+    }
+
+    // no frontier at all
+    BoundaryConditions empty(51, 40, [](double t, double x) { return 0.0; });
+    bool thrown = false;
+    try {
+        general.solve(empty, constant);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown && "missing boundaries not reported");
+    std::cout << "testProcessPropagation passed" << std::endl;
+}
+
+int main() {
+    testProcessPropagation();
+    return 0;
+}
@@ -0,0 +1,43 @@
+#include "Pricers.hpp"
+#include <cassert>
+#include <cmath>
+#include <iostream>
+
+void testRollingPricer() {
+    std::function<double(double, double, double)> volDrift = [](double t, double x, double p) { return 0.01 * p; };
+    std::function<double(double, double, double)> zero = [](double t, double x, double p) { return 0; };
+    ItoDynamics volDynamics(volDrift, zero);
+    ItoDynamics rateDynamics(zero, zero);
+    Asset underlying(100, volDynamics, rateDynamics);
+    double K = 100;
+    std::function<double(double)> payoff = [&K](double S) { return std::max(S - K, 0.); };
+    Contract contract(underlying, payoff, 1.0);
+
+    int N = 101;
+    int N_T = 50;
+    std::function<double(double, double)> vol = [](double t, double x) { return 0.2; };
+    std::function<double(double, double)> rate = [](double t, double x) { return 0.05; };
+    std::function<double(double, double)> zeroBoundary = [](double t, double x) { return 0; };
+    BoundaryConditions volBoundaries(N, N_T, vol);
+    BoundaryConditions rateBoundaries(N, N_T, rate);
+    BoundaryConditions additionalBoundaries(N, N_T, zeroBoundary);
+    volBoundaries.ToggleDir(true, false);
+    rateBoundaries.ToggleDir(true, false);
+    additionalBoundaries.ToggleDir(false, false);
+    SpaceTimeMesh stm(std::log(100.), 1.0, 1.0, N, N_T);
+
+    DiscretePricer full(N, N_T, contract, 0.2, volBoundaries, rateBoundaries, additionalBoundaries, stm);
+    DiscretePricer rolling(N, N_T, contract, 0.2, volBoundaries, rateBoundaries, additionalBoundaries, stm, PricingMode::RollingSlices);
+    full.price(0.5);
+    rolling.price(0.5);
+    assert(std::abs(full.getPrice() - rolling.getPrice()) < 1e-12 && "rolling price mismatch");
+    assert(std::abs(full.delta() - rolling.delta()) < 1e-9 && "rolling delta mismatch");
+    assert(std::abs(full.gamma() - rolling.gamma()) < 1e-6 && "rolling gamma mismatch");
+    assert(std::abs(full.theta() - rolling.theta()) < 1e-9 && "rolling theta mismatch");
+    assert(rolling.memoryFootprint() == 2 * N * sizeof(double) && "rolling mode keeps more than two slices");
+}
+
+int main() {
+    testRollingPricer();
+    return 0;
+}
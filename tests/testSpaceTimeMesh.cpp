@@ -1,16 +1,25 @@
 #include "MeshUtils.hpp"
 #include <iostream>
 #include <cassert>
+#include <cmath>
 
 void testSpaceTimeMesh() {
     SpaceTimeMesh stm(0.0, 1.0, 2.0, 11, 20);
-    assert(stm.get_N() == 10 && "get_N failed");
+    // N nodes over [x0 - R, x0 + R] and N_T slices over [0, T], both ends included
+    assert(stm.get_N() == 11 && "get_N failed");
     assert(stm.get_N_T() == 20 && "get_N_T failed");
     assert(stm.get_R() == 1.0 && "get_R failed");
     assert(stm.get_T() == 2.0 && "get_T failed");
-    assert(std::abs(stm.get_dx() - 0.1) < 1e-6 && "get_dx failed");
-    assert(std::abs(stm.get_dt() - 0.1) < 1e-6 && "get_dt failed");
+    assert(std::abs(stm.get_dx() - 0.2) < 1e-6 && "get_dx failed");
+    assert(std::abs(stm.get_dt() - 2.0 / 19) < 1e-6 && "get_dt failed");
     auto coords = stm.getCoords(5, 10);
-    assert(std::abs(coords.first - 0.5) < 1e-6 && "getCoords x failed"); // precision 10^-6?
-    assert(std::abs(coords.second - 1.0) < 1e-6 && "getCoords t failed");
+    assert(std::abs(coords.first - 0.0) < 1e-6 && "getCoords x failed"); // precision 10^-6?
+    assert(std::abs(coords.second - 20.0 / 19) < 1e-6 && "getCoords t failed");
+    coords = stm.getCoords(0, 0);
+    assert(std::abs(coords.first + 1.0) < 1e-6 && coords.second == 0 && "getCoords of the first node failed");
+}
+
+int main() {
+    testSpaceTimeMesh();
+    return 0;
 }
@@ -0,0 +1,111 @@
+#include "MonteCarlo.hpp"
+#include "StochasticVolPricer.hpp"
+#include <cassert>
+#include <cmath>
+#include <iostream>
+
+void testStochasticVol() {
+    int N = 201;
+    int N_T = 100;
+    auto rate = [](double t, double x) { return 0.05; };
+    BoundaryConditions rateBC(N, N_T, rate);
+    rateBC.ToggleDir(true, false);
+    SpaceVolTimeMesh mesh(std::log(100.), 1.0, 1.0, N, N_T, 0.05, 0.45, 41);
+    assert(mesh.get_M() == 41 && std::abs(mesh.getSigmaNodes()[15] - 0.2) < 1e-15 && std::abs(mesh.get_dsigma() - 0.01) < 1e-15);
+    VanillaCallPayoff payoff{100};
+
+    // no vol of vol: every vol line is a Black-Scholes problem, whatever the scheme and the correlation
+    Asset flat(100, ItoDynamics{ConstantDynamics(0, 0)}, ItoDynamics{ConstantDynamics(0, 0)});
+    Contract call(flat, payoff, 1.0);
+    for (AdiScheme scheme : {AdiScheme::Douglas, AdiScheme::CraigSneyd}) {
+        StochasticVolPricer pricer(call, mesh, rateBC, 0.7, scheme);
+        pricer.price(0.5);
+        for (double sigma : {0.2, 0.3, 0.255}) {
+            BlackScholesCallPricer reference(100, 100, 1.0, 0.05, sigma);
+            reference.price();
+            PricingResult result = pricer.getResult(sigma);
+            assert(std::abs(result.price - reference.getPrice()) < 3e-3 && "stochastic vol price off Black-Scholes");
+            assert(std::abs(result.delta / 100 - reference.delta()) < 1e-3 && "stochastic vol delta off Black-Scholes");
+            assert(std::abs(pricer.vega(sigma) - reference.vega()) < 5e-2 && "stochastic vol vega off Black-Scholes");
+        }
+    }
+
+    // vol driven by the spot (correlation 1): the model MonteCarloPricer simulates
+    Asset driven(100, ItoDynamics{ConstantDynamics(0, 0.1)}, ItoDynamics{ConstantDynamics(0, 0)});
+    Contract drivenCall(driven, payoff, 1.0);
+    StochasticVolPricer pricer(drivenCall, mesh, rateBC, 1.0);
+    pricer.price(0.5);
+    MonteCarloSettings settings;
+    settings.paths = 100000;
+    settings.steps = 100;
+    settings.antithetic = true;
+    settings.seed = 7;
+    MonteCarloResult simulated = MonteCarloPricer(drivenCall, 0.2, 0.05, settings).price();
+    assert(std::abs(pricer.getPrice(0.2) - simulated.price) < 4 * simulated.standardError + 1e-2 && "stochastic vol price off Monte Carlo");
+
+    // the lines split over threads give the same prices, the full grid ends with the rolling slices
+    ThreadPool pool(3);
+    StochasticVolPricer parallel(drivenCall, mesh, rateBC, 1.0);
+    parallel.price(0.5, &pool);
+    StochasticVolPricer full(drivenCall, mesh, rateBC, 1.0, AdiScheme::CraigSneyd, PricingMode::FullGrid);
+    full.price(0.5);
+    for (std::size_t n = 0; n < 2; n++) {
+        for (std::size_t j = 0; j < mesh.get_M(); j++) {
+            for (std::size_t i = 0; i < mesh.get_N(); i++) {
+                assert(parallel.priceAt(i, j, n) == pricer.priceAt(i, j, n) && "threads changed the prices");
+                assert(full.priceAt(i, j, n) == pricer.priceAt(i, j, n) && full.getPriceMesh().getTimeSlice(n)[j * N + i] == pricer.priceAt(i, j, n));
+            }
+        }
+    }
+    assert(full.getPriceMesh().getMeshData(0, 15, N_T - 1) == 0 && full.memoryFootprint() > pricer.memoryFootprint());
+
+    // spot/vol correlation skews the smile: an out of the money call gains with it
+    Asset stochastic(100, ItoDynamics{ConstantDynamics(0, 0.3)}, ItoDynamics{ConstantDynamics(0, 0)});
+    VanillaCallPayoff otm{120};
+    Contract otmCall(stochastic, otm, 1.0);
+    double prices[3];
+    double correlations[3] = {-0.5, 0, 0.5};
+    for (int k = 0; k < 3; k++) {
+        StochasticVolPricer skewed(otmCall, mesh, rateBC, correlations[k]);
+        skewed.price(0.5);
+        prices[k] = skewed.getPrice(0.2);
+    }
+    assert(prices[0] < prices[1] && prices[1] < prices[2] && "correlation should raise the out of the money call");
+
+    // rejected: correlation outside [-1, 1], early exercise, vols off the axis, degenerate axes
+    bool thrown = false;
+    try {
+        StochasticVolPricer invalid(call, mesh, rateBC, 1.5);
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+    thrown = false;
+    try {
+        Contract american(flat, payoff, 1.0, {ExerciseStyle::American, {}});
+        StochasticVolPricer invalid(american, mesh, rateBC, 0);
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+    thrown = false;
+    try {
+        pricer.getPrice(0.5);
+    } catch (const std::out_of_range&) {
+        thrown = true;
+    }
+    assert(thrown);
+    thrown = false;
+    try {
+        SpaceVolTimeMesh invalid(std::log(100.), 1.0, 1.0, N, N_T, 0.3, 0.2, 41);
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+    std::cout << "testStochasticVol passed" << std::endl;
+}
+
+int main() {
+    testStochasticVol();
+    return 0;
+}
@@ -0,0 +1,92 @@
+#include "Pricers.hpp"
+#include <cassert>
+#include <cmath>
+#include <iostream>
+
+namespace {
+// max over a few strikes of the price and delta errors of a call against the closed form
+std::pair<double, double> callErrors(int N, int N_T, const MeshStretching* stretching, PricingMode mode) {
+    std::pair<double, double> errors{0, 0};
+    for (double K : {85., 100., 117.}) {
+        Asset underlying(100, ItoDynamics{ConstantDynamics(0, 0)}, ItoDynamics{ConstantDynamics(0, 0)});
+        VanillaCallPayoff payoff{K};
+        Contract contract(underlying, payoff, 1.0);
+        std::function<double(double, double)> vol = [](double t, double x) { return 0.2; };
+        std::function<double(double, double)> rate = [](double t, double x) { return 0.05; };
+        std::function<double(double, double)> zeroBoundary = [](double t, double x) { return 0; };
+        BoundaryConditions volBoundaries(N, N_T, vol);
+        BoundaryConditions rateBoundaries(N, N_T, rate);
+        BoundaryConditions additionalBoundaries(N, N_T, zeroBoundary);
+        volBoundaries.ToggleDir(true, false);
+        rateBoundaries.ToggleDir(true, false);
+        additionalBoundaries.ToggleDir(false, false);
+        MeshStretching centered;
+        if (stretching) {
+            centered = *stretching;
+            centered.centers = {std::log(K)};
+        }
+        SpaceTimeMesh stm = stretching ? SpaceTimeMesh(std::log(100.), 1.0, 1.0, N, N_T, centered)
+                                       : SpaceTimeMesh(std::log(100.), 1.0, 1.0, N, N_T);
+        DiscretePricer pricer(N, N_T, contract, 0.2, volBoundaries, rateBoundaries, additionalBoundaries, stm, mode);
+        pricer.price(0.5);
+        BlackScholesCallPricer closedForm(100, K, 1.0, 0.05, 0.2);
+        closedForm.price();
+        errors.first = std::max(errors.first, std::abs(pricer.getPrice() - closedForm.getPrice()));
+        errors.second = std::max(errors.second, std::abs(pricer.delta() - 100 * closedForm.delta()));
+    }
+    return errors;
+}
+}
+
+void testStretchedMesh() {
+    // the uniform constructor and a zero stretching give the same nodes
+    SpaceTimeMesh uniform(std::log(100.), 1.0, 1.0, 101, 50);
+    SpaceTimeMesh unstretched(std::log(100.), 1.0, 1.0, 101, 50, MeshStretching{});
+    assert(unstretched.isUniformX() && unstretched.isUniformT());
+    for (std::size_t i = 0; i < 101; i++) {
+        assert(uniform.getCoords(i, 7) == unstretched.getCoords(i, 7));
+    }
+
+    // stretched: same domain, x0 in the middle, the centers are nodes, spacing finest around them
+    MeshStretching stretching;
+    stretching.centers = {std::log(90.), std::log(125.)};
+    stretching.concentration = 10;
+    stretching.timeGrading = 0.5;
+    SpaceTimeMesh stm(std::log(100.), 1.0, 1.0, 101, 50, stretching);
+    assert(!stm.isUniformX() && !stm.isUniformT());
+    const double* x = stm.getXNodes();
+    assert(std::abs(x[0] - (std::log(100.) - 1)) < 1e-14 && std::abs(x[100] - (std::log(100.) + 1)) < 1e-14);
+    assert(x[50] == std::log(100.));
+    for (double center : stretching.centers) {
+        std::size_t nearest = 0;
+        for (std::size_t i = 0; i < 101; i++) {
+            assert(i == 0 || stm.get_dx(i - 1) > 0);
+            if (std::abs(x[i] - center) < std::abs(x[nearest] - center)) {
+                nearest = i;
+            }
+        }
+        assert(x[nearest] == center && "center is not a node");
+        assert(stm.get_dx(nearest) < stm.get_dx(0) / 3 && stm.get_dx(nearest) < stm.get_dx(99) / 3);
+    }
+    assert(stm.getCoords(0, 0).second == 0 && stm.getCoords(0, 49).second == 1.0);
+    assert(stm.get_dt(48) < stm.get_dt(0) / 2 && "time steps not graded");
+
+    // Black-Scholes calls: second order on the stretched mesh, closer than the uniform mesh with the same nodes,
+    // and rolling slices price the same as the full mesh
+    MeshStretching strikeCentered;
+    strikeCentered.concentration = 8;
+    std::pair<double, double> coarse = callErrors(101, 101, &strikeCentered, PricingMode::FullGrid);
+    std::pair<double, double> fine = callErrors(201, 201, &strikeCentered, PricingMode::FullGrid);
+    std::pair<double, double> rolling = callErrors(201, 201, &strikeCentered, PricingMode::RollingSlices);
+    std::pair<double, double> reference = callErrors(201, 201, nullptr, PricingMode::FullGrid);
+    assert(fine.first < coarse.first / 3 && fine.second < coarse.second / 3);
+    assert(fine.first < reference.first && fine.second < reference.second / 3);
+    assert(std::abs(rolling.first - fine.first) < 1e-12 && std::abs(rolling.second - fine.second) < 1e-9);
+
+    std::cout << "testStretchedMesh passed" << std::endl;
+}
+
+int main() {
+    testStretchedMesh();
+    return 0;
+}
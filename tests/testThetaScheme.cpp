@@ -0,0 +1,88 @@
+#include "Pricers.hpp"
+#include <cassert>
+#include <cmath>
+#include <iostream>
+
+template <typename Real>
+void checkTridiagonal(Real tolerance) {
+    // -u[i-1] + 4u[i] - u[i+1] = rhs with u = 1, 2, 3, 4, 5
+    std::vector<Real> lower = {0, -1, -1, -1, -1};
+    std::vector<Real> diag = {4, 4, 4, 4, 4};
+    std::vector<Real> upper = {-1, -1, -1, -1, 0};
+    std::vector<Real> rhs = {2, 4, 6, 8, 16};
+    std::vector<Real> modLower(5), modUpper(5), invPivots(5);
+    solve_tridiagonal(lower.data(), diag.data(), upper.data(), rhs.data(), modLower.data(), modUpper.data(), invPivots.data(), 5);
+    for (std::size_t i = 0; i < 5; i++) {
+        assert(std::abs(static_cast<double>(rhs[i]) - (i + 1)) < tolerance && "solve_tridiagonal failed");
+    }
+}
+
+void testThetaScheme() {
+    checkTridiagonal<float>(1e-5f);
+    checkTridiagonal<double>(1e-12);
+    checkTridiagonal<long double>(1e-12L);
+
+    // operator of a constant slice: rows sum to r inside the mesh (the generator kills constants except for discounting)
+    std::size_t N = 11;
+    std::vector<double> vol(N, 0.2), rate(N, 0.05);
+    std::vector<double> lower(N), diag(N), upper(N);
+    assemble_operator(vol.data(), rate.data(), 0.1, lower.data(), diag.data(), upper.data(), N);
+    for (std::size_t i = 1; i + 1 < N; i++) {
+        assert(std::abs(lower[i] + diag[i] + upper[i] - 0.05) < 1e-12 && "assemble_operator failed");
+    }
+
+    // a constant payoff is discounted at exp(-r T) whatever the precision
+    for (SolverPrecision precision : {SolverPrecision::Single, SolverPrecision::Double, SolverPrecision::Extended}) {
+        std::function<double(double, double, double)> zero = [](double t, double x, double p) { return 0; };
+        ItoDynamics dynamics(zero, zero);
+        Asset underlying(100, dynamics, dynamics);
+        std::function<double(double)> payoff = [](double S) { return 1.0; };
+        Contract contract(underlying, payoff, 1.0);
+        std::function<double(double, double)> volFunc = [](double t, double x) { return 0.2; };
+        std::function<double(double, double)> rateFunc = [](double t, double x) { return 0.05; };
+        std::function<double(double, double)> discount = [](double t, double x) { return std::exp(-0.05 * (1 - t)); };
+        int M = 51;
+        int M_T = 101;
+        BoundaryConditions volBoundaries(M, M_T, volFunc);
+        BoundaryConditions rateBoundaries(M, M_T, rateFunc);
+        BoundaryConditions additionalBoundaries(M, M_T, discount);
+        volBoundaries.ToggleDir(true, false);
+        rateBoundaries.ToggleDir(true, false);
+        additionalBoundaries.ToggleDir(false, false);
+        SpaceTimeMesh stm(std::log(100.), 1.0, 1.0, M, M_T);
+        DiscretePricer pricer(M, M_T, contract, 0.2, volBoundaries, rateBoundaries, additionalBoundaries, stm);
+        pricer.price(0.5, precision);
+        assert(std::abs(pricer.getPrice() - std::exp(-0.05)) < 1e-4 && "discounted constant payoff failed");
+    }
+
+    // a frontier one node wider than the mesh: its far edge lies outside of it and prices like no frontier at all
+    {
+        std::function<double(double, double, double)> zero = [](double t, double x, double p) { return 0; };
+        Asset underlying(100, ItoDynamics(zero, zero), ItoDynamics(zero, zero));
+        Contract contract(underlying, std::function<double(double)>([](double S) { return std::max(S - 100, 0.); }), 1.0);
+        std::function<double(double, double)> volFunc = [](double t, double x) { return 0.2; };
+        std::function<double(double, double)> rateFunc = [](double t, double x) { return 0.05; };
+        std::function<double(double, double)> edge = [](double t, double x) { return std::max(std::exp(x) - 100, 0.); };
+        int M = 11;
+        int M_T = 20;
+        SpaceTimeMesh stm(std::log(100.), 1.0, 1.0, M, M_T);
+        BoundaryConditions volBoundaries(M, M_T, volFunc);
+        BoundaryConditions rateBoundaries(M, M_T, rateFunc);
+        volBoundaries.ToggleDir(true, false);
+        rateBoundaries.ToggleDir(true, false);
+        BoundaryConditions wide(M + 1, M_T, edge);
+        BoundaryConditions fitted(M, M_T, edge);
+        wide.ToggleDir(false, true);
+        DiscretePricer widePricer(M, M_T, contract, 0.2, volBoundaries, rateBoundaries, wide, stm);
+        DiscretePricer fittedPricer(M, M_T, contract, 0.2, volBoundaries, rateBoundaries, fitted, stm);
+        widePricer.price(0.5);
+        fittedPricer.price(0.5);
+        assert(widePricer.getPrice() == fittedPricer.getPrice() && "frontier outside the mesh changed the price");
+        assert(widePricer.priceGradient().price == fittedPricer.priceGradient().price);
+    }
+}
+
+int main() {
+    testThetaScheme();
+    return 0;
+}
@@ -0,0 +1,85 @@
+#include "PricingPool.hpp"
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+
+void testThreadPool() {
+    {
+        ThreadPool pool(4);
+        assert(pool.size() == 4);
+        assert(pool.workerIndex() == ThreadPool::noWorker);
+
+        // many small tasks, including tasks submitted from the workers themselves
+        std::atomic<int> counter(0);
+        std::vector<std::future<void>> futures;
+        for (int k = 0; k < 1000; k++) {
+            futures.push_back(pool.submit([&counter, &pool]() {
+                assert(pool.workerIndex() < pool.size());
+                counter++;
+                pool.submit([&counter]() { counter++; });
+            }));
+        }
+        for (std::future<void>& future : futures) {
+            future.get();
+        }
+        std::future<int> value = pool.submit([]() { return 42; });
+        assert(value.get() == 42);
+
+        // exceptions reach the caller through the future
+        std::future<void> failing = pool.submit([]() { throw std::runtime_error("task failed"); });
+        bool thrown = false;
+        try {
+            failing.get();
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        assert(thrown);
+        // the destructor runs the nested submissions still queued
+    }
+
+    // pool prices = sequential prices
+    double sigma_0 = 0.2;
+    double r_0 = 0.05;
+    ItoDynamics constant{ConstantDynamics(0, 0)};
+    Asset underlying(100, constant, constant);
+    int N = 101;
+    int N_T = 50;
+    SpaceTimeMesh stm(std::log(100.), 5 * sigma_0, 1, N, N_T);
+    BoundaryConditions volBC(N, N_T, [sigma_0](double t, double x) { return sigma_0; });
+    BoundaryConditions rateBC(N, N_T, [r_0](double t, double x) { return r_0; });
+    volBC.ToggleDir(true, false);
+    rateBC.ToggleDir(true, false);
+    BoundaryConditions additionalBC(N, N_T, [](double t, double x) { return 0.; });
+
+    std::vector<Contract> contracts;
+    for (int k = 0; k < 16; k++) {
+        contracts.emplace_back(underlying, VanillaCallPayoff{80. + 2.5 * k}, 1);
+    }
+    std::vector<PricingJob> jobs;
+    for (const Contract& contract : contracts) {
+        jobs.push_back(PricingJob{contract, stm, volBC, rateBC, additionalBC, sigma_0});
+    }
+    PricingPool pricingPool(3);
+    std::vector<PricingResult> results = pricingPool.priceAll(jobs);
+    assert(results.size() == contracts.size());
+    for (std::size_t k = 0; k < contracts.size(); k++) {
+        DiscretePricer pricer(N, N_T, contracts[k], sigma_0, volBC, rateBC, additionalBC, stm);
+        pricer.price(0.5);
+        assert(results[k].price == pricer.getPrice() && "pool price differs from the sequential one");
+        assert(results[k].delta == pricer.delta());
+        assert(results[k].theta == pricer.theta());
+    }
+    // workspaces are reused: pricing the same jobs again gives the same results
+    std::vector<PricingResult> again = pricingPool.priceAll(jobs);
+    for (std::size_t k = 0; k < contracts.size(); k++) {
+        assert(again[k].price == results[k].price);
+    }
+
+    std::cout << "testThreadPool passed" << std::endl;
+}
+
+int main() {
+    testThreadPool();
+    return 0;
+}
@@ -0,0 +1,61 @@
+#include "ItoProcess.hpp"
+#include "Asset.hpp"
+#include <cassert>
+#include <cmath>
+#include <iostream>
+
+void testTypedDynamics() {
+    SpaceTimeMesh stm(0, 1, 1, 11, 6);
+
+    // typed dynamics and their std::function counterpart give the same process
+    std::function<double(double, double, double)> drift = [](double t, double x, double p) { return 0.5 * t; };
+    std::function<double(double, double, double)> zero = [](double t, double x, double p) { return 0; };
+    ItoDynamics erased(drift, zero);
+    ItoDynamics typed{TimeDependentDynamics([](double t) { return 0.5 * t; })};
+    assert(typed.getKernel() != nullptr && erased.getKernel() == nullptr);
+    assert(typed.getDrift(0.4, 0, 0) == erased.getDrift(0.4, 0, 0));
+
+    std::function<double(double, double)> start = [](double t, double x) { return 0.2 + x; };
+    BoundaryConditions erasedBC(11, 6, start);
+    BoundaryConditions typedBC(11, 6, [](double t, double x) { return 0.2 + x; });
+    erasedBC.ToggleDir(true, false);
+    typedBC.ToggleDir(true, false);
+    assert(typedBC.apply(0, 0.5) == erasedBC.apply(0, 0.5));
+
+    ItoProcess erasedProcess(stm);
+    ItoProcess typedProcess(stm);
+    erasedProcess.solve(erasedBC, erased);
+    typedProcess.solve(typedBC, typed);
+    for (std::size_t i = 0; i < 11; i++) {
+        for (std::size_t n = 0; n < 6; n++) {
+            assert(typedProcess.getVal(i, n) == erasedProcess.getVal(i, n) && "typed process differs");
+        }
+    }
+
+    // constant dynamics keep the process at its starting value
+    ItoDynamics constant{ConstantDynamics(0, 0)};
+    ItoProcess constantProcess(stm);
+    constantProcess.solve(typedBC, constant);
+    assert(constantProcess.getVal(3, 5) == constantProcess.getVal(3, 0));
+
+    // vanilla payoffs on the maturity slice
+    Asset underlying(1, constant, constant);
+    Contract call(underlying, VanillaCallPayoff{1.}, 1);
+    Contract put(underlying, VanillaPutPayoff{1.}, 1);
+    std::vector<double> callSlice(11), putSlice(11);
+    call.applyPayoff(stm, callSlice.data());
+    put.applyPayoff(stm, putSlice.data());
+    for (std::size_t i = 0; i < 11; i++) {
+        double S = std::exp(stm.getCoords(i, 5).first);
+        assert(callSlice[i] == std::max(S - 1, 0.) && callSlice[i] == call.getPayoff()(S));
+        // put-call parity on the payoff
+        assert(std::abs(callSlice[i] - putSlice[i] - (S - 1)) < 1e-12);
+    }
+
+    std::cout << "testTypedDynamics passed" << std::endl;
+}
+
+int main() {
+    testTypedDynamics();
+    return 0;
+}
@@ -0,0 +1,159 @@
+#include "PricingPool.hpp"
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+
+// every heap allocation of the program is counted, to check that the steady state doesn't allocate at all
+namespace {
+std::atomic<std::size_t> heapAllocations{0};
+}
+void* operator new(std::size_t size) {
+    heapAllocations++;
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    heapAllocations++;
+    std::size_t align = static_cast<std::size_t>(alignment);
+    if (void* p = std::aligned_alloc(align, (size + align - 1) / align * align)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+void operator delete(void* p, std::align_val_t) noexcept {
+    std::free(p);
+}
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void testWorkspace() {
+    // arena: 64-byte aligned buffers, last-in first-out frees at once, a block per overflow merged back by reset
+    PricingArena arena(256);
+    void* a = arena.allocate(10);
+    void* b = arena.allocate(100);
+    assert(reinterpret_cast<std::uintptr_t>(a) % 64 == 0 && reinterpret_cast<std::uintptr_t>(b) % 64 == 0);
+    assert(arena.borrowed() == 64 + 128 && arena.allocations() == 1);
+    arena.deallocate(b, 100);
+    void* c = arena.allocate(128);
+    assert(c == b && "a buffer given back last should be handed out again");
+    void* d = arena.allocate(512);
+    assert(arena.allocations() == 2 && arena.highWater() == 64 + 128 + 512);
+    bool thrown = false;
+    try {
+        arena.reset();
+    } catch (const std::logic_error&) {
+        thrown = true;
+    }
+    assert(thrown && "reset with borrowed buffers");
+    arena.deallocate(d, 512);
+    arena.deallocate(c, 128);
+    arena.deallocate(a, 10);
+    arena.reset();
+    assert(arena.capacity() == arena.highWater() && arena.allocations() == 3);
+    a = arena.allocate(10);
+    b = arena.allocate(100);
+    d = arena.allocate(512);
+    assert(arena.allocations() == 3 && "the merged block should hold the same buffers");
+    arena.deallocate(d, 512);
+    arena.deallocate(b, 100);
+    arena.deallocate(a, 10);
+
+    int N = 201;
+    int N_T = 100;
+    Asset underlying(100, ItoDynamics{ConstantDynamics(0, 0)}, ItoDynamics{ConstantDynamics(0, 0)});
+    VanillaCallPayoff call{100};
+    VanillaPutPayoff put{100};
+    Contract european(underlying, call, 1.0);
+    Contract american(underlying, put, 1.0, {ExerciseStyle::American, {}});
+    auto vol = [](double t, double x) { return 0.2; };
+    auto rate = [](double t, double x) { return 0.05; };
+    auto zeroBoundary = [](double t, double x) { return 0.; };
+    BoundaryConditions volBC(N, N_T, vol);
+    BoundaryConditions rateBC(N, N_T, rate);
+    BoundaryConditions additionalBC(N, N_T, zeroBoundary);
+    volBC.ToggleDir(true, false);
+    rateBC.ToggleDir(true, false);
+    additionalBC.ToggleDir(false, false);
+    SpaceTimeMesh stm(std::log(100.), 1.0, 1.0, N, N_T);
+    SpaceTimeMesh stretched(std::log(100.), 1.0, 1.0, N, N_T, MeshStretching{{}, 4, 0});
+
+    // same prices with and without a workspace, in both modes
+    PricingWorkspace workspace;
+    for (PricingMode mode : {PricingMode::RollingSlices, PricingMode::FullGrid}) {
+        for (const Contract* contract : {&european, &american}) {
+            DiscretePricer alone(N, N_T, *contract, 0.2, volBC, rateBC, additionalBC, stm, mode);
+            alone.price(0.5);
+            DiscretePricer borrowing(N, N_T, *contract, 0.2, volBC, rateBC, additionalBC, stm, mode, &workspace);
+            borrowing.price(0.5);
+            assert(borrowing.getPrice() == alone.getPrice() && borrowing.delta() == alone.delta() && borrowing.theta() == alone.theta());
+            assert(borrowing.vega() == alone.vega() && "vega on the workspace differs");
+            assert(workspace.arena().borrowed() > 0);
+        }
+        workspace.reset();
+    }
+    assert(workspace.arena().borrowed() == 0);
+
+    // theta sweep like the example's, european and american, every mode and precision, uniform and stretched nodes:
+    // nothing allocated once warm
+    auto sweep = [&]() {
+        double total = 0;
+        for (const SpaceTimeMesh* mesh : {&stm, &stretched}) {
+            for (PricingMode mode : {PricingMode::RollingSlices, PricingMode::FullGrid}) {
+                for (SolverPrecision precision : {SolverPrecision::Double, SolverPrecision::Single}) {
+                    for (int i = 0; i < 10; i++) {
+                        for (const Contract* contract : {&european, &american}) {
+                            DiscretePricer pricer(N, N_T, *contract, 0.2, volBC, rateBC, additionalBC, *mesh, mode, &workspace);
+                            pricer.price(0.5 + i / 20., precision);
+                            total += pricer.getPrice();
+                        }
+                        workspace.reset();
+                    }
+                }
+            }
+        }
+        return total;
+    };
+    double warm = sweep();
+    std::size_t workspaceAllocations = workspace.allocations();
+    std::size_t before = heapAllocations;
+    double steady = sweep();
+    assert(heapAllocations == before && "steady state pricing allocated");
+    assert(workspace.allocations() == workspaceAllocations && steady == warm);
+
+    // the other engines of the pool run on workspaces too
+    PricingPool pool(1);
+    std::vector<PricingJob> jobs = {{european, stm, volBC, rateBC, additionalBC, 0.2}, {american, stm, volBC, rateBC, additionalBC, 0.2}};
+    pool.priceAll(jobs);
+    std::size_t poolAllocations = pool.allocations();
+    pool.priceAll(jobs);
+    assert(pool.allocations() == poolAllocations);
+
+    // resetting under a live pricer
+    thrown = false;
+    DiscretePricer alive(N, N_T, european, 0.2, volBC, rateBC, additionalBC, stm, PricingMode::RollingSlices, &workspace);
+    alive.price(0.5);
+    try {
+        workspace.reset();
+    } catch (const std::logic_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+    std::cout << "testWorkspace passed" << std::endl;
+}
+
+int main() {
+    testWorkspace();
+    return 0;
+}